@@ -3,6 +3,10 @@
 
 #include <fast_io/fast_io.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 using namespace hy;
 
 namespace Env {
@@ -13,10 +17,17 @@ namespace Env {
 	ENVSTR(PROP_VERSIONEX, -version);
 	ENVSTR(PROP_TEST, -test);
 	ENVSTR(PROP_COMPILE, -b);
+	ENVSTR(PROP_NOCACHE, -nocache);
+	ENVSTR(PROP_COMPACT, -compact);
+	ENVSTR(PROP_COMPRESS, -compress);
 	ENVSTR(KEY_SOURCE, src);
 	ENVSTR(KEY_OUT, out);
 	ENVSTR(KEY_LIBPATH, libpath);
 	ENVSTR(KEY_WORKPATH, workpath);
+	ENVSTR(KEY_CACHE, cache);
+	ENVSTR(KEY_SNAPSHOT, snapshot);
+	ENVSTR(KEY_BENCH, bench);
+	ENVSTR(KEY_OUTBUF, outbuf);
 #undef ENVSTR
 }
 
@@ -84,10 +95,17 @@ void RunHelp() noexcept {
 -v | -version            查看汉念核心版本
 -h | -help               查看汉念命令行帮助
 -b                       编译成字节码
+-nocache                 不使用编译缓存
+-compact                 编译成紧凑格式字节码
+-compress                编译成压缩的紧凑格式字节码
 
 [键值命令]
 src:[.hy | .hyb]         源文件路径
 out:[]                   编译目标文件路径
+cache:[]                 编译缓存目录
+snapshot:[]              虚拟机快照路径, 有效时从快照恢复, 否则在导入完成后生成, 导入的库更新后自动重新生成
+outbuf:[]                标准输出缓冲区字符数, 默认65536, 为0时不缓冲
+bench:[lexer | syntaxer | slice | concat | search | sort | array | matrix | vector | json | vms] 运行性能测试
 )"
 	};
 	Device::CLICharOutputFunc(msg);
@@ -97,6 +115,97 @@ namespace hy {
 
 }
 
+namespace Cache {
+	// 编译缓存目录, 未指定时使用程序所在目录下的cache目录
+	util::Path GetPath(util::Args& env, const util::Path& workPath) noexcept {
+		util::Path cachePath{ env.getView(Env::KEY_CACHE) };
+		if (cachePath.empty()) return platform::GetCachePath();
+		if (cachePath.isRelative()) cachePath = workPath + cachePath;
+		if (!cachePath.isDirectory()) cachePath.addSlash();
+		return cachePath;
+	}
+
+	inline constexpr auto FNV_BASIS{ 14695981039346656037ULL };
+
+	inline Uint64 HashBytes(Uint64 hash, CMemory data, Size size) noexcept {
+		auto p{ static_cast<const Byte*>(data) };
+		for (auto end{ p + size }; p != end; ++p) {
+			hash ^= static_cast<Uint64>(*p);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	// 缓存文件路径, 由编译器版本, 编译配置与源码共同决定
+	util::Path GetFile(const util::Path& cachePath, const String& code, const CompilerConfig& cfg) noexcept {
+		auto hash{ FNV_BASIS };
+		hash = HashBytes(hash, strings::VERSION_ID, 4ULL);
+		hash = HashBytes(hash, &cfg.debugMode, sizeof(cfg.debugMode));
+		hash = HashBytes(hash, cfg.minVer, sizeof(cfg.minVer));
+		hash = HashBytes(hash, cfg.maxVer, sizeof(cfg.maxVer));
+		hash = HashBytes(hash, &cfg.format, sizeof(cfg.format));
+		hash = HashBytes(hash, &cfg.compress, sizeof(cfg.compress));
+		hash = HashBytes(hash, code.data(), code.size() * sizeof(Char));
+		String name;
+		fast_io::u16ostring_ref nameRef{ &name };
+		print(nameRef, fast_io::mnp::hexfull(hash), u"_", code.size(),
+			fast_io::mnp::os_c_str(strings::BYTECODE_NAME));
+		return cachePath + util::Path(name);
+	}
+
+	// 缓存文件为字节码后接其校验值, 命中时只校验而不反序列化, 校验通过后去掉校验值
+	bool Verify(util::ByteArray& hyb) noexcept {
+		if (hyb.size() < ByteCode::MIN_SIZE + sizeof(Uint64)) return false;
+		auto size{ hyb.size() - sizeof(Uint64) };
+		Uint64 hash;
+		freestanding::copy(&hash, hyb.data() + size, sizeof(hash));
+		if (HashBytes(FNV_BASIS, hyb.data(), size) != hash) return false;
+		hyb.resize(size);
+		return true;
+	}
+
+	// 写出失败不影响本次运行, 仅下次无法命中
+	void Save(const util::Path& cacheFile, util::ByteArray& hyb) noexcept {
+		auto size{ hyb.size() };
+		hyb.append(HashBytes(FNV_BASIS, hyb.data(), size));
+		platform::SaveFileAtomic(cacheFile, hyb);
+		hyb.resize(size);
+	}
+}
+
+// 按命令行设置编译配置
+void SetCompilerConfig(util::Args& env, CompilerConfig& cfg) noexcept {
+	cfg.debugMode = true;
+	cfg.compress = env.hasProp(Env::PROP_COMPRESS);
+	cfg.format = cfg.compress || env.hasProp(Env::PROP_COMPACT) ? BCFormat::V2 : BCFormat::V1;
+}
+
+// 编译源码, 命中编译缓存时直接读取缓存的字节码而跳过词法, 语法分析与编译
+CodeResult CompileSrc(util::Args& env, const util::Path& workPath, const String& code, util::ByteArray& hyb) noexcept {
+	Compiler compiler;
+	SetCompilerConfig(env, compiler.cfg);
+	auto useCache{ !env.hasProp(Env::PROP_NOCACHE) };
+	util::Path cacheFile;
+	if (useCache) {
+		auto cachePath{ Cache::GetPath(env, workPath) };
+		cacheFile = Cache::GetFile(cachePath, code, compiler.cfg);
+		// 缓存文件截断或损坏时忽略, 重新编译并覆盖
+		if (platform::BrowserFile(cacheFile, hyb) && Cache::Verify(hyb))
+			return CodeResult{ HYError::NO_ERROR, 0U, nullptr, nullptr };
+		useCache = platform::CreateFolder(cachePath);
+	}
+	Lexer lexer;
+	Syntaxer syntaxer;
+	CodeResult cr{ api::hyc.LexerAnalyse(&lexer, code.data()) };
+	if (cr) cr = api::hyc.SyntaxerAnalyse(&syntaxer, &lexer);
+	if (cr) {
+		api::hyc.CompilerCompile(&compiler, &syntaxer);
+		freestanding::swap(hyb, compiler.mBytes);
+		if (useCache && !hyb.empty()) Cache::Save(cacheFile, hyb);
+	}
+	return cr;
+}
+
 // 测试 -test
 #define OFF_OPTIMIZE 0
 #if OFF_OPTIMIZE
@@ -121,6 +230,500 @@ void RunTest() noexcept {
 #pragma optimize("", on)
 #endif
 
+// 测试字节码格式 -test src:
+void RunTestByteCode(util::Args& env) noexcept {
+	constexpr auto N{ 1000ULL };
+	util::Path srcPath{ env.getView(Env::KEY_SOURCE) };
+	if (srcPath.isRelative()) srcPath = platform::GetWorkPath() + srcPath;
+	String code;
+	if (!platform::BrowserFile(srcPath, code)) {
+		Device::CLICharOutputFunc(srcPath.toString() + u" 文件不存在");
+		return;
+	}
+	Lexer lexer;
+	Syntaxer syntaxer;
+	CodeResult cr{ api::hyc.LexerAnalyse(&lexer, code.data()) };
+	if (cr) cr = api::hyc.SyntaxerAnalyse(&syntaxer, &lexer);
+	if (!cr) {
+		String msg;
+		api::hyvm.GetCompileErrorString(srcPath.getFileNameNoExt().toView(), cr, &msg);
+		Device::CLICharOutputFunc(msg);
+		return;
+	}
+	struct {
+		const char* name;
+		BCFormat format;
+		bool compress;
+	} modes[]{
+		{ "v1", BCFormat::V1, false },
+		{ "v2", BCFormat::V2, false },
+		{ "v2+lz", BCFormat::V2, true },
+	};
+	for (auto& [name, format, compress] : modes) {
+		Compiler compiler;
+		compiler.cfg.debugMode = true;
+		compiler.cfg.format = format;
+		compiler.cfg.compress = compress;
+		api::hyc.CompilerCompile(&compiler, &syntaxer);
+		auto ok{ true };
+		auto t{ fast_io::posix_clock_gettime(fast_io::posix_clock_id::realtime) };
+		for (Index i{ }; i < N; ++i) {
+			ByteCode bc;
+			ok = api::hyvm.LoadByteCode(&compiler.mBytes, &bc) && ok;
+		}
+		println(name, ": size ", compiler.mBytes.size(), " B, ", N, " loads ",
+			fast_io::posix_clock_gettime(fast_io::posix_clock_id::realtime) - t, ok ? "" : " (load failed)");
+	}
+}
+
+namespace Bench {
+	// 测试耗时, 取多次运行中的最小值(秒)
+	template<typename Func>
+	double MinTime(Size runs, Func&& func) noexcept {
+		auto best{ 0.0 };
+		for (Index i{ }; i < runs; ++i) {
+			auto t{ std::chrono::steady_clock::now() };
+			func();
+			double elapsed{ std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count() };
+			if (!i || elapsed < best) best = elapsed;
+		}
+		return best;
+	}
+
+	// 词法分析吞吐量, 源码由包含各类词的代码片段重复生成
+	void RunLexer() noexcept {
+		constexpr auto SIZE{ 16ULL << 20ULL };
+		constexpr auto RUNS{ 5ULL };
+		constexpr Char snippet[]{ uR"(## 多行注释
+	用于测试注释跳过 ##
+# 单行注释
+function 斐波那契(n) {
+	if (n <= 1) { return n; } else { return 斐波那契(n - 1) + 斐波那契(n - 2); }
+}
+class 点 { x = 1.5e-3; y = -42; z = 3i; name = "hello \"world\"\n 汉念"; }
+while (true) { a += 1; b -= 2; c *= 3; d /= 4; e %= 5; f = a >= b & c != d; break; }
+for (i : 1 ~ 10) { list[i] = -i ^ 2; obj.method(i); m::n; continue; }
+global g_value_123 = false; static counter = 0;
+)" };
+		String code;
+		code.reserve(SIZE + sizeof(snippet));
+		while (code.size() < SIZE) code.append(snippet);
+		Lexer lexer;
+		CodeResult cr{ };
+		auto time{ MinTime(RUNS, [&] { cr = api::hyc.LexerAnalyse(&lexer, code.data()); }) };
+		auto bytes{ code.size() * sizeof(Char) };
+		println("lexer: ", bytes, " B, ", lexer.lexes.size(), " lexes, ",
+			static_cast<Size>(bytes / time / 1e6), " MB/s", cr ? "" : " (lexer failed)");
+	}
+}
+
+namespace Bench {
+	// 语法分析耗时及语法树内存, 源码为约10万行的生成代码
+	void RunSyntaxer() noexcept {
+		constexpr auto LINES{ 100000ULL };
+		constexpr auto RUNS{ 5ULL };
+		constexpr Char snippet[]{ uR"(import sys;
+using std;
+class 点 {
+	function len(self) { return self.x * self.x + self.y * self.y; }
+}
+function 斐波那契(n) {
+	if (n <= 1) { return n; } else { return 斐波那契(n - 1) + 斐波那契(n - 2); }
+}
+a = {1, 2, 3};
+b = {"k": 1, "j": [1.5, 2]};
+m = [[1, 2], [3, 4]];
+r = 1 ~ 10 ~ 2;
+while (true) { g += 1; if (g >= 10 & !(g == 11) | g != 3) { continue; } break; }
+f = function(x, y : std::int, ...) -> std::int { return x; };
+p = 点(); p.x = 3; print(p.len(), 斐波那契(20), a[1] * (3 - b["k"]));
+)" };
+		constexpr auto SNIPPET_LINES{ 15ULL };
+		String code;
+		for (Index i{ }; i < LINES; i += SNIPPET_LINES) code.append(snippet);
+		Lexer lexer;
+		Syntaxer syntaxer;
+		CodeResult cr{ api::hyc.LexerAnalyse(&lexer, code.data()) };
+		auto time{ MinTime(RUNS, [&] { if (cr) cr = api::hyc.SyntaxerAnalyse(&syntaxer, &lexer); }) };
+		println("syntaxer: ", LINES, " lines, ", lexer.lexes.size(), " lexes, ",
+			static_cast<Size>(time * 1e3), " ms, AST ", syntaxer.arena.usedBytes >> 10ULL, " KB used / ",
+			syntaxer.arena.reservedBytes >> 10ULL, " KB reserved", cr ? "" : " (syntaxer failed)");
+	}
+}
+
+// 虚拟机按命令行设置路径与标准设备
+void SetupVM(VM& vm) noexcept {
+	vm.libPath = vm.argv.getView(Env::KEY_LIBPATH);
+	if (vm.libPath.empty() || vm.libPath.isRelative()) vm.libPath = platform::GetLibPath();
+	vm.workPath = vm.argv.getView(Env::KEY_WORKPATH);
+	if (vm.workPath.empty() || vm.workPath.isRelative()) vm.workPath = platform::GetWorkPath();
+	vm.stdDevice = {
+		&Device::CLICharInputFunc, &Device::CLICharOutputFunc,
+		&Device::CLIErrorFunc, nullptr,
+	};
+	// 控制台逐行可见, 重定向时整块写出
+	vm.stdDevice.byteInputFunc = &platform::ReadStandardInput;
+	vm.stdDevice.lineFlush = platform::IsConsoleOutput();
+	if (vm.argv.hasValue(Env::KEY_OUTBUF)) {
+		Size size{ };
+		for (auto c : vm.argv.getView(Env::KEY_OUTBUF)) {
+			if (c < u'0' || c > u'9') break;
+			size = size * 10ULL + static_cast<Size>(c - u'0');
+		}
+		vm.stdDevice.outputBufferSize = size;
+	}
+}
+
+namespace Bench {
+	// 运行源码的耗时(秒), 每次运行使用新的虚拟机, 编译或运行出错时返回负数
+	double ScriptTime(util::Args& env, Size runs, const String& code) noexcept {
+		Lexer lexer;
+		Syntaxer syntaxer;
+		Compiler compiler;
+		SetCompilerConfig(env, compiler.cfg);
+		CodeResult cr{ api::hyc.LexerAnalyse(&lexer, code.data()) };
+		if (cr) cr = api::hyc.SyntaxerAnalyse(&syntaxer, &lexer);
+		if (!cr) return -1.0;
+		api::hyc.CompilerCompile(&compiler, &syntaxer);
+		auto ok{ true };
+		auto time{ MinTime(runs, [&] {
+			VM vm{ env };
+			SetupVM(vm);
+			api::hyvm.VMInitialize(&vm);
+			String mainName{ u"bench" };
+			RefView mainNameRef{ mainName };
+			auto mainModule{ vm.moduleTree.add(mainNameRef, mainName, vm.workPath, false) };
+			api::hyvm.RunByteCode(&vm, mainModule, &compiler.mBytes, false);
+			ok = vm.ok() && ok;
+			api::hyvm.VMDestroy(&vm);
+		}) };
+		return ok ? time : -1.0;
+	}
+
+	// 准备代码prepare后执行work的耗时(秒), 扣除准备代码及虚拟机初始化的耗时
+	double WorkTime(util::Args& env, Size runs, const String& prepare, const String& work) noexcept {
+		auto base{ ScriptTime(env, runs, prepare) };
+		auto total{ ScriptTime(env, runs, prepare + work) };
+		if (base < 0.0 || total < 0.0) return -1.0;
+		return total > base ? total - base : 0.0;
+	}
+}
+
+namespace Bench {
+	// 切片耗时, 分别对100万元素的列表与约10M字符的字符串重复取大切片
+	void RunSlice(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr auto COUNT{ 1000ULL };
+		auto report{ [](const char* name, double time) {
+			if (time < 0.0) println(name, ": failed");
+			else println(name, ": ", COUNT, " slices, ", static_cast<Size>(time * 1e6 / COUNT), " us/slice");
+		} };
+		report("list", WorkTime(env, RUNS, u"a = list(1 ~ 1000000);\n",
+			u"for (i : 1 ~ 1000) { b = a[i, i + 500000]; c = b[1, 1000]; }\n"));
+		report("string", WorkTime(env, RUNS, u"s = \"0123456789\"; for (i : 1 ~ 20) { s += s; }\n",
+			u"for (i : 1 ~ 1000) { t = s.substr(i, 5000000); u = t.left(\"9\"); }\n"));
+	}
+}
+
+namespace Bench {
+	// 字符串反复连接的吞吐量, 分别以 s += t 与 s = s + t 生成数MB的字符串, 两种规模用于观察是否为线性时间
+	void RunConcat(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr Size counts[]{ 100000ULL, 200000ULL };
+		constexpr auto PIECE_SIZE{ 16ULL };
+		String prepare{ u"p = \"0123456789abcdef\"; s = \"\";\n" };
+		struct {
+			const char* name;
+			StringView stmt;
+		} modes[]{
+			{ "s += p", u"s += p;" },
+			{ "s = s + p", u"s = s + p;" },
+		};
+		for (auto& [name, stmt] : modes) {
+			for (auto count : counts) {
+				String work;
+				print(fast_io::u16ostring_ref{ &work }, u"for (i : 1 ~ ", count, u") { ", stmt, u" }\n");
+				auto time{ WorkTime(env, RUNS, prepare, work) };
+				auto bytes{ count * PIECE_SIZE * sizeof(Char) };
+				if (time < 0.0) println(name, ": failed");
+				else println(name, ": ", bytes >> 10ULL, " KB, ", static_cast<Size>(time * 1e3), " ms, ",
+					time > 0.0 ? static_cast<Size>(bytes / time / 1e6) : 0ULL, " MB/s");
+			}
+		}
+	}
+}
+
+namespace Bench {
+	// 字符串查找, 计数, 替换与分割的吞吐量, 文本为约8M字符的重复日志行
+	void RunSearch(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr auto COUNT{ 10ULL };
+		constexpr auto LINE_SIZE{ 64ULL };
+		constexpr auto DOUBLINGS{ 17ULL };
+		String prepare;
+		print(fast_io::u16ostring_ref{ &prepare },
+			u"s = \"2024-01-01 12:00:00 INFO  worker-7 request ok in 35ms path=/api\\n\";",
+			u" for (i : 1 ~ ", DOUBLINGS, u") { s += s; }\n");
+		struct {
+			const char* name;
+			StringView stmt;
+		} modes[]{
+			{ "find", u"r = s.find(\"connection reset by peer while reading\");" },
+			{ "count", u"r = s.count(\"INFO\");" },
+			{ "replace", u"r = s.replace(\"INFO \", \"DEBUG\");" },
+			{ "split", u"r = s.split(\"\\n\");" },
+		};
+		auto bytes{ (LINE_SIZE << DOUBLINGS) * COUNT * sizeof(Char) };
+		for (auto& [name, stmt] : modes) {
+			String work;
+			print(fast_io::u16ostring_ref{ &work }, u"for (i : 1 ~ ", COUNT, u") { ", stmt, u" }\n");
+			auto time{ WorkTime(env, RUNS, prepare, work) };
+			if (time < 0.0) println(name, ": failed");
+			else println(name, ": ", static_cast<Size>(time * 1e3), " ms, ",
+				time > 0.0 ? bytes / time / 1e9 : 0.0, " GB/s");
+		}
+	}
+}
+
+namespace Bench {
+	// 列表排序耗时, 元素为线性同余生成的伪随机整数
+	void RunSort(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr Size counts[]{ 100000ULL, 1000000ULL };
+		struct {
+			const char* name;
+			StringView stmt;
+			Size maxCount;
+		} modes[]{
+			{ "sorted()", u"b = a.sorted();", 1000000ULL },
+			{ "sorted(key)", u"b = a.sorted(function(v) { return -v; });", 1000000ULL },
+			{ "sorted(cmp)", u"b = a.sorted(function(x, y) { return x > y; });", 100000ULL },
+		};
+		for (auto count : counts) {
+			String prepare;
+			print(fast_io::u16ostring_ref{ &prepare }, u"x = 1; a = list(); for (i : 1 ~ ", count,
+				u") { x = (x * 1103515245 + 12345) % 2147483648; a.push(x); }\n");
+			for (auto& [name, stmt, maxCount] : modes) {
+				if (count > maxCount) continue;
+				auto time{ WorkTime(env, RUNS, prepare, String{ stmt } + u"\n") };
+				if (time < 0.0) println(name, ": failed");
+				else println(name, ": ", count, " items, ", static_cast<Size>(time * 1e3), " ms");
+			}
+		}
+	}
+
+	void RunArray(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr auto COUNT{ 1000000ULL };
+		struct {
+			const char* name;
+			StringView stmt;
+		} modes[]{
+			{ "loop sum", u"s = 0; for (v : a) { s += v; }" },
+			{ "sum()", u"s = a.sum();" },
+			{ "min() max()", u"s = a.min(); t = a.max();" },
+			{ "argmin()", u"s = a.argmin();" },
+			{ "prefix_sum()", u"b = a.prefix_sum();" },
+			{ "count()", u"s = a.count(12345);" },
+			{ "a * 3 + 1", u"b = a * 3 + 1;" },
+			{ "a % 7", u"b = a % 7;" },
+			{ "filter(a % 2)", u"b = a.filter(a % 2);" },
+		};
+		String prepare;
+		print(fast_io::u16ostring_ref{ &prepare }, u"x = 1; a = array(); for (i : 1 ~ ", COUNT,
+			u") { x = (x * 1103515245 + 12345) % 2147483648; a.push(x); }\n");
+		for (auto& [name, stmt] : modes) {
+			auto time{ WorkTime(env, RUNS, prepare, String{ stmt } + u"\n") };
+			if (time < 0.0) println(name, ": failed");
+			else println(name, ": ", COUNT, " items, ", static_cast<Size>(time * 1e6), " us");
+		}
+	}
+
+	void RunMatrix(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr Size sizes[]{ 64ULL, 128ULL, 256ULL, 512ULL, 1024ULL };
+		constexpr auto NAIVE_MAX{ 128ULL };
+		for (auto n : sizes) {
+			String prepare;
+			print(fast_io::u16ostring_ref{ &prepare }, u"n = ", n, u"; a = matrix(n, n, 1.5); b = matrix(n, n, 0.5);\n");
+			auto flop{ 2.0 * static_cast<Float64>(n) * static_cast<Float64>(n) * static_cast<Float64>(n) };
+			auto time{ WorkTime(env, RUNS, prepare, u"c = a * b;\n") };
+			if (time < 0.0) println("gemm ", n, ": failed");
+			else println("gemm ", n, ": ", static_cast<Size>(time * 1e6), " us, ", flop / time / 1e9, " GFLOPS");
+			if (n > NAIVE_MAX) continue;
+			time = WorkTime(env, 1ULL, prepare, u"c = matrix(n, n); for (i : 1 ~ n) { for (j : 1 ~ n) { s = 0.0; "
+				u"for (p : 1 ~ n) { s += a[i, p] * b[p, j]; } c[i, j] = s; } }\n");
+			if (time < 0.0) println("naive ", n, ": failed");
+			else println("naive ", n, ": ", static_cast<Size>(time * 1e6), " us, ", flop / time / 1e9, " GFLOPS");
+		}
+	}
+
+	// 逐元素运算链, 融合求值与逐步原地运算对比
+	void RunVector(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr auto COUNT{ 1000000ULL };
+		struct {
+			const char* name;
+			StringView stmt;
+		} modes[]{
+			{ "a * 2 + b - c", u"s = (a * 2 + b - c).sum();" },
+			{ "(a + b) * (b - c) / 3", u"s = ((a + b) * (b - c) / 3).sum();" },
+			{ "step by step", u"t = a * 1; t *= 2; t += b; t -= c; s = t.sum();" },
+		};
+		String prepare;
+		print(fast_io::u16ostring_ref{ &prepare }, u"m = matrix(3, ", COUNT, u", 1.5); a = m[1]; b = m[2]; c = m[3];\n");
+		for (auto& [name, stmt] : modes) {
+			auto time{ WorkTime(env, RUNS, prepare, String{ stmt } + u"\n") };
+			if (time < 0.0) println(name, ": failed");
+			else println(name, ": ", COUNT, " items, ", static_cast<Size>(time * 1e6), " us");
+		}
+	}
+}
+
+namespace Bench {
+	// JSON解析与序列化的吞吐量, 文本为约1.6MB的重复记录数组, 按UTF-8字节数计算
+	void RunJson(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr auto COUNT{ 10ULL };
+		constexpr auto DOUBLINGS{ 14ULL };
+		constexpr StringView record{ uR"({"id": 12345, "name": "widget", "price": 19.99, "tags": ["red", "blue"], "ok": true, "meta": null},)" };
+		String prepare{ u"r = \"" };
+		for (auto c : record) {
+			if (c == u'"') prepare.push_back(u'\\');
+			prepare.push_back(c);
+		}
+		print(fast_io::u16ostring_ref{ &prepare }, u"\"; s = r; for (i : 1 ~ ", DOUBLINGS,
+			u") { s += s; } s = \"[\" + s + \"null]\"; b = s.utf8; v = json_parse(b);\n");
+		struct {
+			const char* name;
+			StringView stmt;
+		} modes[]{
+			{ "parse(string)", u"w = json_parse(s);" },
+			{ "parse(bin)", u"w = json_parse(b);" },
+			{ "dump", u"t = json_dump(v);" },
+		};
+		auto bytes{ ((record.size() << DOUBLINGS) + 6ULL) * COUNT };
+		for (auto& [name, stmt] : modes) {
+			String work;
+			print(fast_io::u16ostring_ref{ &work }, u"for (i : 1 ~ ", COUNT, u") { ", stmt, u" }\n");
+			auto time{ WorkTime(env, RUNS, prepare, work) };
+			if (time < 0.0) println(name, ": failed");
+			else println(name, ": ", bytes >> 10ULL, " KB, ", static_cast<Size>(time * 1e3), " ms, ",
+				time > 0.0 ? static_cast<Size>(bytes / time / 1e6) : 0ULL, " MB/s");
+		}
+	}
+
+	// 多虚拟机并发, 同一份字节码由各线程中独立的虚拟机同时运行, 比较单个与N个虚拟机的耗时
+	// 主模块开启并行导入并导入多个库模块, 运行期间采样进程的线程数与私有内存
+	// 预取线程由所有虚拟机共享, 导入的字节码经模块缓存共享, 二者均不随虚拟机数倍增
+	void RunVms(util::Args& env) noexcept {
+		constexpr auto RUNS{ 3ULL };
+		constexpr auto LIBS{ 16ULL };
+		auto compile{ [&env](const String& code, util::ByteArray& hyb) {
+			Lexer lexer;
+			Syntaxer syntaxer;
+			Compiler compiler;
+			SetCompilerConfig(env, compiler.cfg);
+			CodeResult cr{ api::hyc.LexerAnalyse(&lexer, code.data()) };
+			if (cr) cr = api::hyc.SyntaxerAnalyse(&syntaxer, &lexer);
+			if (!cr) return false;
+			api::hyc.CompilerCompile(&compiler, &syntaxer);
+			freestanding::swap(hyb, compiler.mBytes);
+			return true;
+		} };
+		// 库模块写入缓存目录下的bench目录, 作为各虚拟机的库路径
+		auto cachePath{ platform::GetCachePath() };
+		auto libPath{ cachePath + util::Path(u"bench") };
+		libPath.addSlash();
+		if (!platform::CreateFolder(cachePath) || !platform::CreateFolder(libPath)) return println("vms: create lib folder failed");
+		String libCode{ u"global data;\ndata = list(1 ~ 10000);\n"
+			u"function f(n) { s = 0; for (v : data) { s += v % n; } return s; }\n" };
+		String code;
+		fast_io::u16ostring_ref codeRef{ &code };
+		for (Index i{ 1ULL }; i <= LIBS; ++i) {
+			util::ByteArray hyb;
+			String libName;
+			print(fast_io::u16ostring_ref{ &libName }, u"benchlib", i);
+			if (!compile(libCode, hyb) || !platform::SaveFile(libPath + util::Path(libName + strings::BYTECODE_NAME), hyb))
+				return println("vms: write lib failed");
+			print(codeRef, u"import ", libName, u";\n");
+		}
+		print(codeRef, u"function fib(n) { if (n <= 1) { return n; } return fib(n - 1) + fib(n - 2); }\n"
+			u"s = 0; for (i : 1 ~ 8) { s += fib(22); } l = list(); for (i : 1 ~ 100000) { l.push(i * 2); }\n");
+		for (Index i{ 1ULL }; i <= LIBS; ++i) print(codeRef, u"s += benchlib", i, u"::f(", i + 1ULL, u");\n");
+		util::ByteArray mainHyb;
+		if (!compile(code, mainHyb)) return println("vms: compile failed");
+		// 字节码只读, 各虚拟机共享
+		auto run{ [&](bool& ok) {
+			VM vm{ env };
+			SetupVM(vm);
+			vm.libPath = libPath;
+			vm.cfg.ParallelImport = true;
+			api::hyvm.VMInitialize(&vm);
+			String mainName{ u"bench" };
+			RefView mainNameRef{ mainName };
+			auto mainModule{ vm.moduleTree.add(mainNameRef, mainName, vm.workPath, false) };
+			api::hyvm.RunByteCode(&vm, mainModule, &mainHyb, false);
+			ok = vm.ok();
+			api::hyvm.VMDestroy(&vm);
+		} };
+		auto n{ std::max(static_cast<Size>(std::thread::hardware_concurrency()), 1ULL) };
+		Vector<Byte> results(n);
+		auto baseThreads{ platform::GetThreadCount() };
+		auto baseMemory{ platform::GetPrivateMemory() };
+		auto single{ MinTime(RUNS, [&] {
+			bool ok{ };
+			run(ok);
+			results[0] = ok;
+		}) };
+		if (!results[0]) return println("vms: failed");
+		// 主线程在各虚拟机运行期间采样
+		Size peakThreads{ }, peakMemory{ };
+		auto multi{ MinTime(RUNS, [&] {
+			std::atomic<Size> running{ n };
+			Vector<std::thread> workers;
+			workers.reserve(n);
+			for (Index i{ }; i < n; ++i) workers.emplace_back([&, i] {
+				bool ok{ };
+				run(ok);
+				results[i] = ok;
+				--running;
+			});
+			while (running) {
+				peakThreads = std::max(peakThreads, platform::GetThreadCount());
+				peakMemory = std::max(peakMemory, platform::GetPrivateMemory());
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			for (auto& worker : workers) worker.join();
+		}) };
+		for (auto ok : results) if (!ok) return println("vms: failed");
+		println("1 vm: ", static_cast<Size>(single * 1e3), " ms");
+		println(n, " vms: ", static_cast<Size>(multi * 1e3), " ms, ",
+			multi > 0.0 ? static_cast<Size>(single / multi * 100.0) : 0ULL, "% scaling efficiency");
+		// 上限为主线程以外的基础线程, 各虚拟机线程与共享的预取线程之和
+		println(n, " vms with ", LIBS, " parallel imports each: peak ", peakThreads > baseThreads ? peakThreads - baseThreads : 0ULL,
+			" extra threads (bound ", n + n, "), peak ", peakMemory > baseMemory ? (peakMemory - baseMemory) >> 20ULL : 0ULL,
+			" MB extra private memory");
+	}
+}
+
+// 性能测试 bench:
+void RunBench(util::Args& env) noexcept {
+	auto name{ env.getView(Env::KEY_BENCH) };
+	if (name == u"lexer") Bench::RunLexer();
+	else if (name == u"syntaxer") Bench::RunSyntaxer();
+	else if (name == u"slice") Bench::RunSlice(env);
+	else if (name == u"concat") Bench::RunConcat(env);
+	else if (name == u"search") Bench::RunSearch(env);
+	else if (name == u"sort") Bench::RunSort(env);
+	else if (name == u"array") Bench::RunArray(env);
+	else if (name == u"matrix") Bench::RunMatrix(env);
+	else if (name == u"vector") Bench::RunVector(env);
+	else if (name == u"json") Bench::RunJson(env);
+	else if (name == u"vms") Bench::RunVms(env);
+	else RunStop();
+}
+
 // 运行 -b src:
 void RunCompileSrc(util::Args& env) noexcept {
 	// 编译主模块源码
@@ -132,12 +735,8 @@ void RunCompileSrc(util::Args& env) noexcept {
 	if (srcPath.getExtension() == u".hy") {
 		String code;
 		if (platform::BrowserFile(srcPath, code)) {
-			Lexer lexer;
-			Syntaxer syntaxer;
-			Compiler compiler; compiler.cfg.debugMode = true;
-			auto cr{ api::hyc.LexerAnalyse(&lexer, code.data()) };
-			if (cr) cr = api::hyc.SyntaxerAnalyse(&syntaxer, &lexer);
-			if (cr) api::hyc.CompilerCompile(&compiler, &syntaxer);
+			util::ByteArray hyb;
+			auto cr{ CompileSrc(env, workPath, code, hyb) };
 			if (cr) {
 				auto outPath { workPath + util::Path(mainName + strings::BYTECODE_NAME) };
 				if (env.hasValue(Env::KEY_OUT)) {
@@ -145,7 +744,7 @@ void RunCompileSrc(util::Args& env) noexcept {
 					if (targetPath.isRelative()) targetPath = workPath + targetPath;
 					outPath = util::Path(targetPath.toString() + strings::BYTECODE_NAME);
 				}
-				if (!platform::SaveFile(outPath, compiler.mBytes))
+				if (!platform::SaveFile(outPath, hyb))
 					Device::CLICharOutputFunc(u"目标路径不合法或写出文件失败");
 			}
 			else {
@@ -159,19 +758,30 @@ void RunCompileSrc(util::Args& env) noexcept {
 	else Device::CLICharOutputFunc(srcPath.toString() + u" 不是合法的源码文件");
 }
 
+// 以快照运行主模块 src: snapshot:
+// 快照有效时跳过所有导入模块的读取与初始化, 否则正常运行预处理段后生成快照
+void RunVMSnapshot(VM& vm, Module* mainModule, util::ByteArray& hyb) noexcept {
+	util::Path snapshotPath{ vm.argv.getView(Env::KEY_SNAPSHOT) };
+	if (snapshotPath.isRelative()) snapshotPath = vm.workPath + snapshotPath;
+	util::ByteArray snapshot;
+	if (!platform::BrowserFile(snapshotPath, snapshot) ||
+		!api::hyvm.LoadSnapshot(&vm, mainModule, &snapshot, &hyb)) {
+		if (vm.error()) return;
+		api::hyvm.RunByteCodePrelude(&vm, mainModule, &hyb);
+		if (vm.error()) return;
+		// 写出失败不影响本次运行
+		if (api::hyvm.SaveSnapshot(&vm, mainModule, &snapshot)) platform::SaveFileAtomic(snapshotPath, snapshot);
+	}
+	api::hyvm.RunModuleBody(&vm, mainModule);
+}
+
 // 运行 src:
 void RunVMSrc(util::Args& env) noexcept {
 	// 虚拟机初始化
 	VM vm{ env };
-	vm.libPath = vm.argv.getView(Env::KEY_LIBPATH);
-	if (vm.libPath.empty() || vm.libPath.isRelative()) vm.libPath = platform::GetLibPath();
-	vm.workPath = vm.argv.getView(Env::KEY_WORKPATH);
-	if (vm.workPath.empty() || vm.workPath.isRelative()) vm.workPath = platform::GetWorkPath();
+	SetupVM(vm);
+	// 进程当前目录为全局状态, 仅单虚拟机运行时设置, 供原生库使用
 	platform::SetWorkPath(vm.workPath);
-	vm.stdDevice = {
-		&Device::CLICharInputFunc, &Device::CLICharOutputFunc,
-		&Device::CLIErrorFunc, nullptr,
-	};
 
 	CallStackTrace cst;
 	api::hyvm.VMInitialize(&vm);
@@ -189,16 +799,8 @@ void RunVMSrc(util::Args& env) noexcept {
 	else {
 		String code;
 		if (platform::BrowserFile(srcPath, code)) {
-			Lexer lexer;
-			Syntaxer syntaxer;
-			Compiler compiler; compiler.cfg.debugMode = true;
-			CodeResult cr{ api::hyc.LexerAnalyse(&lexer, code.data()) };
-			if (cr) cr = api::hyc.SyntaxerAnalyse(&syntaxer, &lexer);
-			if (cr) {
-				api::hyc.CompilerCompile(&compiler, &syntaxer);
-				freestanding::swap(hyb, compiler.mBytes);
-			}
-			else api::hyvm.SetError_CompileError(&vm, cr, mainName);
+			if (auto cr{ CompileSrc(vm.argv, vm.workPath, code, hyb) }; !cr)
+				api::hyvm.SetError_CompileError(&vm, cr, mainName);
 		}
 		else api::hyvm.SetError_FileNotExists(&vm, srcPath.toView());
 	}
@@ -208,7 +810,8 @@ void RunVMSrc(util::Args& env) noexcept {
 		if (vm.moduleTree.find(mainNameRef)) api::hyvm.SetError_RedefinedID(&vm, mainName);
 		else {
 			auto mainModule{ vm.moduleTree.add(mainNameRef, mainName, srcPath.getParent(), false) };
-			api::hyvm.RunByteCode(&vm, mainModule, &hyb, true);
+			if (vm.argv.hasValue(Env::KEY_SNAPSHOT)) RunVMSnapshot(vm, mainModule, hyb);
+			else api::hyvm.RunByteCode(&vm, mainModule, &hyb, true);
 		}
 	}
 	// VM结束
@@ -226,9 +829,11 @@ int wmain(int argc, Str argv[]) {
 		util::Args env;
 		for (auto argi{ 1 }; argi < argc; ++argi) env.setView(argv[argi]);
 		if (env.hasValue(Env::KEY_SOURCE)) {
-			if (env.hasProp(Env::PROP_COMPILE)) RunCompileSrc(env);
+			if (env.hasProp(Env::PROP_TEST)) RunTestByteCode(env);
+			else if (env.hasProp(Env::PROP_COMPILE)) RunCompileSrc(env);
 			else RunVMSrc(env);
 		}
+		else if (env.hasValue(Env::KEY_BENCH)) RunBench(env);
 		else {
 			if (env.count() == 1ULL) {
 				if (env.hasProp(Env::PROP_VERSION) || env.hasProp(Env::PROP_VERSIONEX)) RunVersion();
@@ -53,6 +53,11 @@ namespace hy::api {
 		void (*VMDestroy)(VM* vm) noexcept {};
 
 		void (*RunByteCode)(VM* vm, Module* mod, util::ByteArray* bc, bool movebc) noexcept {};
+		bool (*LoadByteCode)(util::ByteArray* ba, ByteCode* bc) noexcept {};
+		void (*RunByteCodePrelude)(VM* vm, Module* mod, util::ByteArray* ba) noexcept {};
+		void (*RunModuleBody)(VM* vm, Module* mod) noexcept {};
+		bool (*SaveSnapshot)(VM* vm, Module* mainMod, util::ByteArray* out) noexcept {};
+		bool (*LoadSnapshot)(VM* vm, Module* mainMod, util::ByteArray* snapshot, util::ByteArray* ba) noexcept {};
 
 		void (*SetError_CompileError)(VM* vm, CodeResult cr, const StringView name) noexcept {};
 		void (*SetError_FileNotExists)(VM* vm, const StringView name) noexcept {};
@@ -68,6 +73,11 @@ namespace hy::api {
 				LOADFUNC(VMDestroy);
 
 				LOADFUNC(RunByteCode);
+				LOADFUNC(LoadByteCode);
+				LOADFUNC(RunByteCodePrelude);
+				LOADFUNC(RunModuleBody);
+				LOADFUNC(SaveSnapshot);
+				LOADFUNC(LoadSnapshot);
 
 				LOADFUNC(SetError_CompileError);
 				LOADFUNC(SetError_FileNotExists);
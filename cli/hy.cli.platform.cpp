@@ -6,9 +6,48 @@ namespace hy::platform::details {
 	inline constexpr auto MAX_PATH{ 261ULL };
 	inline constexpr auto INVALID_HANDLE_VALUE{ static_cast<Uint64>(-1LL) };
 	inline constexpr auto CP_UTF8{ 65001U };
+	inline constexpr auto MOVEFILE_REPLACE_EXISTING{ 0x1U };
+	inline constexpr auto MOVEFILE_WRITE_THROUGH{ 0x8U };
+	inline constexpr auto INVALID_FILE_ATTRIBUTES{ 0xFFFFFFFFU };
+	inline constexpr auto FILE_ATTRIBUTE_DIRECTORY{ 0x10U };
+	inline constexpr auto STD_INPUT_HANDLE{ static_cast<Uint32>(-10) };
+	inline constexpr auto STD_OUTPUT_HANDLE{ static_cast<Uint32>(-11) };
+	inline constexpr auto FILE_TYPE_CHAR{ 0x2U };
+	inline constexpr auto CONSOLE_EOF{ u'\x1A' };
+	inline constexpr auto TH32CS_SNAPTHREAD{ 0x4U };
+
+	struct THREADENTRY32 {
+		Uint32 dwSize;
+		Uint32 cntUsage;
+		Uint32 th32ThreadID;
+		Uint32 th32OwnerProcessID;
+		Int32 tpBasePri;
+		Int32 tpDeltaPri;
+		Uint32 dwFlags;
+	};
+
+	struct PROCESS_MEMORY_COUNTERS {
+		Uint32 cb;
+		Uint32 PageFaultCount;
+		Size PeakWorkingSetSize;
+		Size WorkingSetSize;
+		Size QuotaPeakPagedPoolUsage;
+		Size QuotaPagedPoolUsage;
+		Size QuotaPeakNonPagedPoolUsage;
+		Size QuotaNonPagedPoolUsage;
+		Size PagefileUsage;
+		Size PeakPagefileUsage;
+	};
 
 	extern "C" {
 		__declspec(dllimport) Int32 __stdcall SetConsoleOutputCP(Uint32 codePage);
+		__declspec(dllimport) Memory __stdcall GetStdHandle(Uint32 nStdHandle);
+		__declspec(dllimport) Uint32 __stdcall GetFileType(Memory hFile);
+		__declspec(dllimport) Int32 __stdcall GetConsoleMode(Memory hConsoleHandle, Uint32* lpMode);
+		__declspec(dllimport) Int32 __stdcall ReadConsoleW(Memory hConsoleInput, Memory lpBuffer,
+			Uint32 nNumberOfCharsToRead, Uint32* lpNumberOfCharsRead, Memory pInputControl);
+		__declspec(dllimport) Int32 __stdcall WideCharToMultiByte(Uint32 CodePage, Uint32 dwFlags, CStr lpWideCharStr,
+			Int32 cchWideChar, char* lpMultiByteStr, Int32 cbMultiByte, const char* lpDefaultChar, Int32* lpUsedDefaultChar);
 
 		__declspec(dllimport) Uint32 __stdcall GetModuleFileNameW(Memory hModule, CStr lpFilename, Uint32 nSize);
 		__declspec(dllimport) Uint32 __stdcall GetCurrentDirectoryW(Uint32 nBufferLength, Str lpBuffer);
@@ -26,7 +65,20 @@ namespace hy::platform::details {
 		__declspec(dllimport) Uint32 __stdcall GetFileSize(Memory hFile, Uint32* lpFileSizeHigh);
 		__declspec(dllimport) Int32 __stdcall WriteFile(Memory hFile, CMemory lpBuffer, Uint32 nSize,
 			Uint32* wSize, Memory lpOverlapped);
+		__declspec(dllimport) Int32 __stdcall ReadFile(Memory hFile, Memory lpBuffer, Uint32 nSize,
+			Uint32* rSize, Memory lpOverlapped);
 		__declspec(dllimport) Int32 __stdcall CloseHandle(Memory hObject);
+		__declspec(dllimport) Int32 __stdcall CreateDirectoryW(CStr lpPathName, Memory lpSecurityAttributes);
+		__declspec(dllimport) Int32 __stdcall MoveFileExW(CStr lpExistingFileName, CStr lpNewFileName, Uint32 dwFlags);
+		__declspec(dllimport) Int32 __stdcall DeleteFileW(CStr lpFileName);
+		__declspec(dllimport) Uint32 __stdcall GetFileAttributesW(CStr lpFileName);
+		__declspec(dllimport) Uint32 __stdcall GetCurrentProcessId();
+		__declspec(dllimport) Memory __stdcall GetCurrentProcess();
+		__declspec(dllimport) Memory __stdcall CreateToolhelp32Snapshot(Uint32 dwFlags, Uint32 th32ProcessID);
+		__declspec(dllimport) Int32 __stdcall Thread32First(Memory hSnapshot, THREADENTRY32* lpte);
+		__declspec(dllimport) Int32 __stdcall Thread32Next(Memory hSnapshot, THREADENTRY32* lpte);
+		__declspec(dllimport) Int32 __stdcall K32GetProcessMemoryInfo(Memory Process,
+			PROCESS_MEMORY_COUNTERS* ppsmemCounters, Uint32 cb);
 
 		__declspec(dllimport) Memory __stdcall LoadLibraryW(CStr lpLibFileName);
 		__declspec(dllimport) Int32 __stdcall FreeLibrary(Memory hLibModule);
@@ -40,6 +92,44 @@ namespace hy::platform {
 		details::SetConsoleOutputCP(details::CP_UTF8);
 	}
 
+	// 标准输出是否为控制台, 重定向到文件或管道时为假
+	bool IsConsoleOutput() noexcept {
+		return details::GetFileType(details::GetStdHandle(details::STD_OUTPUT_HANDLE)) == details::FILE_TYPE_CHAR;
+	}
+
+	// 从控制台读取UTF-16字符并转为UTF-8, 不依赖控制台的输入代码页, 行首的Ctrl+Z视为输入结束
+	Size ReadConsoleUTF8(Memory handle, Byte* buf, Size size) noexcept {
+		constexpr auto MAX_CHARS{ 4096ULL };
+		Char wbuf[MAX_CHARS + 1ULL];
+		// 每个UTF-16单元至多转为3字节, 预留一个单元以补全被截断的代理对
+		auto count{ size / 3ULL };
+		if (count > MAX_CHARS) count = MAX_CHARS;
+		if (count < 2ULL) return 0ULL;
+		--count;
+		Uint32 nChars{ };
+		if (!details::ReadConsoleW(handle, wbuf, static_cast<Uint32>(count), &nChars, nullptr) || !nChars) return 0ULL;
+		if (wbuf[0] == details::CONSOLE_EOF) return 0ULL;
+		if (wbuf[nChars - 1U] >= 0xD800U && wbuf[nChars - 1U] <= 0xDBFFU) {
+			Uint32 nExtra{ };
+			if (details::ReadConsoleW(handle, wbuf + nChars, 1U, &nExtra, nullptr)) nChars += nExtra;
+		}
+		auto nBytes{ details::WideCharToMultiByte(details::CP_UTF8, 0U, wbuf, static_cast<Int32>(nChars),
+			reinterpret_cast<char*>(buf), static_cast<Int32>(size < 0x7FFFFFFFULL ? size : 0x7FFFFFFFULL), nullptr, nullptr) };
+		return nBytes > 0 ? static_cast<Size>(nBytes) : 0ULL;
+	}
+
+	// 从标准输入读取至多size字节, 输入结束(含管道关闭)或失败时返回0
+	// 控制台输入按UTF-16读取, 重定向时按原始字节读取
+	Size ReadStandardInput(Byte* buf, Size size) noexcept {
+		constexpr auto MAX_READ{ 0x40000000ULL };
+		auto handle{ details::GetStdHandle(details::STD_INPUT_HANDLE) };
+		if (Uint32 mode; details::GetConsoleMode(handle, &mode)) return ReadConsoleUTF8(handle, buf, size);
+		Uint32 nBytes{ };
+		if (!details::ReadFile(handle, buf,
+			static_cast<Uint32>(size < MAX_READ ? size : MAX_READ), &nBytes, nullptr)) return 0ULL;
+		return nBytes;
+	}
+
 	bool BrowserFile(const util::Path& path, String& str) noexcept {
 		auto ret{ false };
 		fast_io::u16ostring_ref strRef{ &str };
@@ -91,6 +181,35 @@ namespace hy::platform {
 		return true;
 	}
 
+	bool SaveFileAtomic(const util::Path& path, const util::ByteArray& ba) noexcept {
+		// 先写出到进程独占的临时文件, 完整写出后再替换目标, 并发或中断时目标文件不会处于半写状态
+		String tmpPath{ path.toString() };
+		fast_io::u16ostring_ref tmpRef{ &tmpPath };
+		print(tmpRef, u".", details::GetCurrentProcessId(), u".tmp");
+		auto ret{ false };
+		if (auto hFile{ details::CreateFileW(tmpPath.data(), 0x40000000L, 0,
+			nullptr, 2, 128, nullptr) };
+			hFile != (Memory)details::INVALID_HANDLE_VALUE) {
+			Uint32 nBytes{ };
+			ret = details::WriteFile(hFile, ba.data(), static_cast<Size32>(ba.size()), &nBytes, nullptr)
+				&& nBytes == ba.size();
+			details::CloseHandle(hFile);
+			if (ret) ret = details::MoveFileExW(tmpPath.data(), path.toView().data(),
+				details::MOVEFILE_REPLACE_EXISTING | details::MOVEFILE_WRITE_THROUGH);
+			if (!ret) details::DeleteFileW(tmpPath.data());
+		}
+		return ret;
+	}
+
+	bool CreateFolder(const util::Path& path) noexcept {
+		// 目录已存在时同样视为成功
+		String dir{ path.toString() };
+		if (!dir.empty() && dir.back() == util::Path::SLASH) dir.pop_back();
+		details::CreateDirectoryW(dir.data(), nullptr);
+		auto attr{ details::GetFileAttributesW(dir.data()) };
+		return attr != details::INVALID_FILE_ATTRIBUTES && (attr & details::FILE_ATTRIBUTE_DIRECTORY);
+	}
+
 	void AutoCurrentFolder() noexcept {
 		Char buf[details::MAX_PATH]{ };
 		details::GetModuleFileNameW(nullptr, buf, details::MAX_PATH);
@@ -113,6 +232,33 @@ namespace hy::platform {
 		return util::Path(buf).getParent() + strings::LIB_PATH_NAME;
 	}
 
+	util::Path GetCachePath() noexcept {
+		Char buf[details::MAX_PATH]{ };
+		details::GetModuleFileNameW(nullptr, buf, details::MAX_PATH);
+		return util::Path(buf).getParent() + strings::CACHE_PATH_NAME;
+	}
+
+	// 本进程当前的线程数
+	Size GetThreadCount() noexcept {
+		auto hSnapshot{ details::CreateToolhelp32Snapshot(details::TH32CS_SNAPTHREAD, 0U) };
+		if (hSnapshot == (Memory)details::INVALID_HANDLE_VALUE) return 0ULL;
+		auto pid{ details::GetCurrentProcessId() };
+		details::THREADENTRY32 te{ sizeof(te) };
+		Size count{ };
+		for (auto ok{ details::Thread32First(hSnapshot, &te) }; ok; ok = details::Thread32Next(hSnapshot, &te)) {
+			if (te.th32OwnerProcessID == pid) ++count;
+		}
+		details::CloseHandle(hSnapshot);
+		return count;
+	}
+
+	// 本进程当前提交的私有内存字节数
+	Size GetPrivateMemory() noexcept {
+		details::PROCESS_MEMORY_COUNTERS pmc{ sizeof(pmc) };
+		if (!details::K32GetProcessMemoryInfo(details::GetCurrentProcess(), &pmc, sizeof(pmc))) return 0ULL;
+		return pmc.PagefileUsage;
+	}
+
 	Memory LoadDll(const StringView fp) noexcept {
 		return details::LoadLibraryW(fp.data());
 	}
@@ -4,13 +4,20 @@
 
 namespace hy::platform {
 	void SetConsoleUTF8() noexcept;
+	bool IsConsoleOutput() noexcept;
+	Size ReadStandardInput(Byte* buf, Size size) noexcept;
 	bool BrowserFile(const util::Path& path, String& str) noexcept;
 	bool BrowserFile(const util::Path& path, util::ByteArray& ba) noexcept;
 	bool SaveFile(const util::Path& path, const util::ByteArray& ba) noexcept;
+	bool SaveFileAtomic(const util::Path& path, const util::ByteArray& ba) noexcept;
+	bool CreateFolder(const util::Path& path) noexcept;
 	void AutoCurrentFolder() noexcept;
 	util::Path GetWorkPath() noexcept;
 	void SetWorkPath(const util::Path& path) noexcept;
 	util::Path GetLibPath() noexcept;
+	util::Path GetCachePath() noexcept;
+	Size GetThreadCount() noexcept;
+	Size GetPrivateMemory() noexcept;
 	Memory LoadDll(const StringView fp) noexcept;
 	Memory GetDll(const StringView fp) noexcept;
 	bool FreeDll(Memory handle) noexcept;
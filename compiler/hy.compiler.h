@@ -12,6 +12,7 @@
 #pragma once
 
 #include "../public/hy.util.h"
+#include "../serializer/hy.serializer.bctype.h"
 
 namespace hy {
 	// 资源集
@@ -23,6 +24,8 @@ namespace hy {
 		bool debugMode{ }; // 调试模式
 		Byte minVer[4]{ }; // 最低虚拟机版本
 		Byte maxVer[4]{ }; // 最高虚拟机版本
+		BCFormat format{ }; // 字节码格式
+		bool compress{ }; // 压缩字节码(仅紧凑格式)
 	};
 
 	// 编译器
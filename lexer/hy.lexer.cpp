@@ -12,6 +12,13 @@
 #include "hy.lexer.h"
 #include "../public/hy.error.h"
 
+#include <bit>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define HY_LEXER_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace hy {
     struct TokenPos {
         LexToken token;
@@ -42,12 +49,44 @@ namespace hy {
         return ch >= 0x4E00U && ch <= 0x9FA5U;
     }
 
+    // 字符类别
+    inline constexpr Byte CC_ID_HEAD{ 0x01U }; // 标识符首字符
+    inline constexpr Byte CC_ID{ 0x02U }; // 标识符字符
+    inline constexpr Byte CC_DIGIT{ 0x04U }; // 数字
+    inline constexpr Byte CC_BLANK{ 0x08U }; // 空白
+    inline constexpr Byte CC_ARI{ 0x10U }; // 不含减号的算术运算符
+    inline constexpr Byte CC_LOG{ 0x20U }; // 逻辑运算符
+
+    struct CharClassTable {
+        Byte data[128ULL]{ };
+    };
+
+    // ASCII字符类别表, 非ASCII字符中仅中文属于标识符, 以区间判断代替整张64K表
+    inline constexpr CharClassTable ASCII_CLASS{ [] {
+        CharClassTable table;
+        for (Char ch{ }; ch < 128U; ++ch) {
+            Byte cls{ };
+            if (freestanding::cvt::isalpha(ch) || ch == u'_') cls |= CC_ID_HEAD | CC_ID;
+            if (freestanding::cvt::isdigit(ch)) cls |= CC_DIGIT | CC_ID;
+            if (freestanding::cvt::isblank(ch)) cls |= CC_BLANK;
+            if (IsAriOptWithoutSub(ch)) cls |= CC_ARI;
+            if (IsLogOpt(ch)) cls |= CC_LOG;
+            table.data[ch] = cls;
+        }
+        return table;
+    }() };
+
+    inline constexpr Byte GetCharClass(Char ch) noexcept {
+        if (ch < 128U) return ASCII_CLASS.data[ch];
+        return IsChinese(ch) ? CC_ID_HEAD | CC_ID : Byte{ };
+    }
+
     inline constexpr bool IsIdHead(Char ch) noexcept {
-        return IsChinese(ch) || freestanding::cvt::isalpha(ch) || ch == u'_';
+        return GetCharClass(ch) & CC_ID_HEAD;
     }
 
     inline constexpr bool is_id(Char ch) noexcept {
-        return IsChinese(ch) || freestanding::cvt::isalnum(ch) || ch == u'_';
+        return GetCharClass(ch) & CC_ID;
     }
 
     inline constexpr bool IsNumber(LexToken token) noexcept {
@@ -74,6 +113,189 @@ namespace hy {
         return token >= KEYWORD_START && token <= KEYWORD_END;
     }
 
+    /*
+        快速扫描
+        每种扫描以终止条件描述, 返回第一个满足终止条件的字符位置, '\0'总是终止字符
+        SSE2下对齐前逐字符比较, 之后每次以16字节对齐读取比较8个字符
+        对齐读取不会越过'\0'所在的内存页, 因此无需知道源码长度
+    */
+#ifdef HY_LEXER_SSE2
+    inline __m128i SimdEq(__m128i block, Char ch) noexcept {
+        return _mm_cmpeq_epi16(block, _mm_set1_epi16(static_cast<short>(ch)));
+    }
+
+    // lo <= ch <= hi
+    inline __m128i SimdInRange(__m128i block, Char lo, Char hi) noexcept {
+        auto offset{ _mm_sub_epi16(block, _mm_set1_epi16(static_cast<short>(lo))) };
+        return _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(static_cast<short>(hi - lo))),
+            _mm_setzero_si128());
+    }
+
+    inline __m128i SimdNot(__m128i mask) noexcept {
+        return _mm_xor_si128(mask, _mm_set1_epi32(-1));
+    }
+
+    template<typename Scan>
+    inline CStr ScanUntil(CStr p) noexcept {
+        for (; reinterpret_cast<Size>(p) & 15ULL; ++p)
+            if (Scan::stop(*p)) return p;
+        for (;; p += 8) {
+            auto block{ _mm_load_si128(reinterpret_cast<const __m128i*>(p)) };
+            if (auto mask{ static_cast<Uint32>(_mm_movemask_epi8(Scan::mask(block))) })
+                return p + (std::countr_zero(mask) >> 1U);
+        }
+    }
+#else
+    template<typename Scan>
+    inline CStr ScanUntil(CStr p) noexcept {
+        while (!Scan::stop(*p)) ++p;
+        return p;
+    }
+#endif
+
+    // 空白串
+    struct BlankScan {
+        static constexpr bool stop(Char ch) noexcept {
+            return !freestanding::cvt::isblank(ch);
+        }
+#ifdef HY_LEXER_SSE2
+        static __m128i mask(__m128i block) noexcept {
+            return SimdNot(_mm_or_si128(SimdEq(block, u' '), SimdEq(block, u'\t')));
+        }
+#endif
+    };
+
+    // 标识符串
+    struct IdScan {
+        static constexpr bool stop(Char ch) noexcept {
+            return !is_id(ch);
+        }
+#ifdef HY_LEXER_SSE2
+        static __m128i mask(__m128i block) noexcept {
+            auto alpha{ SimdInRange(_mm_or_si128(block, _mm_set1_epi16(32)), u'a', u'z') };
+            auto digit{ SimdInRange(block, u'0', u'9') };
+            auto chinese{ SimdInRange(block, 0x4E00U, 0x9FA5U) };
+            return SimdNot(_mm_or_si128(_mm_or_si128(alpha, digit), _mm_or_si128(chinese, SimdEq(block, u'_'))));
+        }
+#endif
+    };
+
+    // 单行注释
+    struct LineAnnotateScan {
+        static constexpr bool stop(Char ch) noexcept {
+            return !ch || ch == u'\n';
+        }
+#ifdef HY_LEXER_SSE2
+        static __m128i mask(__m128i block) noexcept {
+            return _mm_or_si128(SimdEq(block, u'\0'), SimdEq(block, u'\n'));
+        }
+#endif
+    };
+
+    // 多行注释
+    struct BlockAnnotateScan {
+        static constexpr bool stop(Char ch) noexcept {
+            return !ch || ch == u'\n' || ch == u'#';
+        }
+#ifdef HY_LEXER_SSE2
+        static __m128i mask(__m128i block) noexcept {
+            return _mm_or_si128(_mm_or_si128(SimdEq(block, u'\0'), SimdEq(block, u'\n')), SimdEq(block, u'#'));
+        }
+#endif
+    };
+
+    // 字符串内容
+    struct LiteralScan {
+        static constexpr bool stop(Char ch) noexcept {
+            return !ch || ch == u'\n' || ch == u'\"' || ch == u'\\';
+        }
+#ifdef HY_LEXER_SSE2
+        static __m128i mask(__m128i block) noexcept {
+            return _mm_or_si128(_mm_or_si128(SimdEq(block, u'\0'), SimdEq(block, u'\n')),
+                _mm_or_si128(SimdEq(block, u'\"'), SimdEq(block, u'\\')));
+        }
+#endif
+    };
+}
+
+namespace hy {
+    /*
+        默认关键字的完美哈希
+        哈希只取长度, 首两个字符及末字符, 编译期搜索使默认关键字两两不冲突的种子
+        查找时仅需一次哈希与一次比较, 自定义关键字集仍使用配置中的映射表
+    */
+    struct KeywordEntry {
+        CStr key;
+        Size length;
+        LexToken token;
+    };
+
+    inline constexpr Size KeywordLength(CStr key) noexcept {
+        Size length{ };
+        while (key[length]) ++length;
+        return length;
+    }
+
+    inline constexpr KeywordEntry DEFAULT_KEYWORDS[HY_KEYWORD_COUNT]{
+#define KS(key) { HY_KEYWORD_##key, KeywordLength(HY_KEYWORD_##key), LexToken::key }
+        KS(IF), KS(ELSE), KS(WHILE), KS(FOR), KS(CONTINUE),
+        KS(BREAK), KS(SWITCH), KS(DEFAULT), KS(STATIC), KS(CONST),
+        KS(TRUE), KS(FALSE), KS(IMPORT), KS(NATIVE), KS(USING),
+        KS(FUNCTION), KS(RETURN), KS(CLASS), KS(THIS), KS(CONCEPT),
+        KS(GLOBAL),
+#undef KS
+    };
+
+    inline constexpr Size KEYWORD_TABLE_SIZE{ 64ULL };
+    inline constexpr Size KEYWORD_MIN_LENGTH{ 2ULL };
+    inline constexpr Size KEYWORD_MAX_LENGTH{ 8ULL };
+
+    // 已确定KEYWORD_MIN_LENGTH <= length
+    inline constexpr Index KeywordHash(CStr key, Size length, Uint32 seed) noexcept {
+        auto h{ static_cast<Uint32>(key[0ULL]) * seed + static_cast<Uint32>(key[1ULL]) * 31U +
+            static_cast<Uint32>(key[length - 1ULL]) * 7U + static_cast<Uint32>(length) };
+        h ^= h >> 7U;
+        return h % KEYWORD_TABLE_SIZE;
+    }
+
+    inline constexpr Uint32 KEYWORD_SEED{ [] {
+        for (Uint32 seed{ 1U };; ++seed) {
+            bool used[KEYWORD_TABLE_SIZE]{ };
+            auto ok{ true };
+            for (auto& entry : DEFAULT_KEYWORDS) {
+                auto& slot{ used[KeywordHash(entry.key, entry.length, seed)] };
+                if (slot) {
+                    ok = false;
+                    break;
+                }
+                slot = true;
+            }
+            if (ok) return seed;
+        }
+    }() };
+
+    struct KeywordTable {
+        KeywordEntry slots[KEYWORD_TABLE_SIZE]{ };
+    };
+
+    inline constexpr KeywordTable DEFAULT_KEYWORD_TABLE{ [] {
+        KeywordTable table;
+        for (auto& entry : DEFAULT_KEYWORDS)
+            table.slots[KeywordHash(entry.key, entry.length, KEYWORD_SEED)] = entry;
+        return table;
+    }() };
+
+    // 在默认关键字中查找, 不是关键字时返回ID
+    inline LexToken FindDefaultKeyword(CStr start, Size length) noexcept {
+        if (length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH) return LexToken::ID;
+        auto& entry{ DEFAULT_KEYWORD_TABLE.slots[KeywordHash(start, length, KEYWORD_SEED)] };
+        if (entry.length == length && freestanding::compare(entry.key, start, length * sizeof(Char)) == 0)
+            return entry.token;
+        return LexToken::ID;
+    }
+}
+
+namespace hy {
     // 解析算术符号
     // 已确定start == + | * | / | %
     inline constexpr TokenPos TestAriOpt(CStr start) noexcept {
@@ -108,9 +330,10 @@ namespace hy {
     }
 
     // 解析标识符及关键字
-    inline TokenPos TestId(LexerConfig& config, CStr start) noexcept {
-        auto p{ start + 1 };
-        while (is_id(*p)) ++p;
+    // defaultKeywords为真时配置使用默认关键字集
+    inline TokenPos TestId(LexerConfig& config, bool defaultKeywords, CStr start) noexcept {
+        auto p{ ScanUntil<IdScan>(start + 1) };
+        if (defaultKeywords) return { FindDefaultKeyword(start, p - start), p - 1 };
         if (auto key{ config.kwMap.get(StringView(start, p - start)) })
             return { *key, p - 1 };
         return { LexToken::ID, p - 1 };
@@ -189,9 +412,8 @@ namespace hy {
 
     // 解析空白
     // 已确定start是空白字符
-    inline constexpr CStr TestDelim(CStr start) noexcept {
-        for (++start; freestanding::cvt::isblank(*start); ++start);
-        return start - 1;
+    inline CStr TestDelim(CStr start) noexcept {
+        return ScanUntil<BlankScan>(start + 1) - 1;
     }
 
     // 解析点
@@ -204,18 +426,20 @@ namespace hy {
 
     // 解析注释
     // 已确定start是#号
-    inline constexpr PosLineError TestAnnotate(CStr start) noexcept {
+    inline PosLineError TestAnnotate(CStr start) noexcept {
         if (start[1] == u'#') {
             Index32 line{ };
-            for (++start; *start; ++start) {
+            for (++start;; ++start) {
+                start = ScanUntil<BlockAnnotateScan>(start);
+                if (!*start) break;
                 if (*start == u'\n') ++line;
-                else if (*start == u'#' && start[1] == u'#')
+                else if (start[1] == u'#')
                     return { start + 1, line, HYError::NO_ERROR };
             }
             return { start - 1, line, HYError::MISSING_ANNOTATE };
         }
         else {
-            for (++start; *start && *start != u'\n'; ++start);
+            start = ScanUntil<LineAnnotateScan>(start + 1);
             if (*start) return { start, 1U, HYError::NO_ERROR };
             return { start - 1, 0U, HYError::NO_ERROR };
         }
@@ -223,13 +447,17 @@ namespace hy {
 
     // 解析字符串
     // 已确定start是"
-    inline constexpr PosLineError TestLiteral(CStr start) noexcept {
+    inline PosLineError TestLiteral(CStr start) noexcept {
         CStr p{ };
         Index32 line{ };
-        for (p = ++start; *p; ++p) {
-            if (*p == u'\\' && *(p + 1)) ++p; // 跳过转义符
+        for (p = ++start;; ++p) {
+            p = ScanUntil<LiteralScan>(p);
+            if (!*p) break;
+            if (*p == u'\\') {
+                if (*(p + 1)) ++p; // 跳过转义符
+            }
             else if (*p == u'\n') ++line; // 新的一行
-            else if (*p == u'\"') return { p, line, HYError::NO_ERROR };
+            else return { p, line, HYError::NO_ERROR };
         }
         if (p - start > sizeof(Char) * 6) p = start + 5; // 防止引号内容过多则部分省略
         return { p, line, HYError::MISSING_QUOTE }; // 缺失另一个双引号
@@ -261,17 +489,15 @@ namespace hy {
 }
 
 namespace hy {
-    void CheckKeywords(LexerConfig& config) noexcept {
-        static util::StringMap<LexToken> hy_default_keywords;
-        if (hy_default_keywords.empty()) {
-#define KS(key) hy_default_keywords.set(HY_KEYWORD_##key, LexToken::key)
-            KS(IF); KS(ELSE); KS(WHILE); KS(FOR); KS(CONTINUE);
-            KS(BREAK); KS(SWITCH); KS(DEFAULT); KS(STATIC); KS(CONST);
-            KS(TRUE); KS(FALSE); KS(IMPORT); KS(NATIVE); KS(USING);
-            KS(FUNCTION); KS(RETURN); KS(CLASS); KS(THIS); KS(CONCEPT);
-            KS(GLOBAL);
-#undef KS
-        }
+    // 检查关键字集, 不完整时替换为默认关键字集, 返回是否与默认关键字集相同
+    bool CheckKeywords(LexerConfig& config) noexcept {
+        // 局部静态变量的初始化是线程安全的, 多个线程同时编译时不会重复填充
+        static const util::StringMap<LexToken> hy_default_keywords{ [] {
+            util::StringMap<LexToken> kw;
+            for (auto& entry : DEFAULT_KEYWORDS)
+                kw.set(StringView(entry.key, entry.length), entry.token);
+            return kw;
+        }() };
         auto useDefault{ true };
         if (config.kwMap.size() == HY_KEYWORD_COUNT) {
             HashSet<LexToken> keyset;
@@ -282,7 +508,14 @@ namespace hy {
             }
             useDefault = keyset.size() != HY_KEYWORD_COUNT;
         }
-        if (useDefault) config.kwMap = hy_default_keywords;
+        if (useDefault) {
+            config.kwMap = hy_default_keywords;
+            return true;
+        }
+        for (auto& [key, value] : config.kwMap) {
+            if (FindDefaultKeyword(key.data(), key.size()) != value) return false;
+        }
+        return true;
     }
 
     inline void Clean(Lexer* lexer) noexcept {
@@ -297,25 +530,26 @@ namespace hy {
     LIB_EXPORT CodeResult LexerAnalyse(Lexer * lexer, CStr code) noexcept {
         auto& [line, lexes, source, cfg] { *lexer };
         Clean(lexer);
-        CheckKeywords(cfg);
+        auto defaultKeywords{ CheckKeywords(cfg) };
         auto start{ code };
         for (CStr end{ }; *start;) {
-            if (IsAriOptWithoutSub(*start)) { // 分析算术运算符
+            auto cls{ GetCharClass(*start) };
+            if (cls & CC_ARI) { // 分析算术运算符
                 auto [token, end_] { TestAriOpt(start) };
                 end = end_;
                 lexes.emplace_back(token, line, start, end);
             }
-            else if (IsLogOpt(*start)) { // 分析逻辑运算符
+            else if (cls & CC_LOG) { // 分析逻辑运算符
                 auto [token, end_] { TestLogOpt(start) };
                 end = end_;
                 lexes.emplace_back(token, line, start, end);
             }
-            else if (IsIdHead(*start)) { // 分析标识符及关键字
-                auto [token, end_] { TestId(cfg, start) };
+            else if (cls & CC_ID_HEAD) { // 分析标识符及关键字
+                auto [token, end_] { TestId(cfg, defaultKeywords, start) };
                 end = end_;
                 lexes.emplace_back(token, line, start, end);
             }
-            else if (freestanding::cvt::isdigit(*start)) { // 分析数字
+            else if (cls & CC_DIGIT) { // 分析数字
                 auto [token, end_, err] { TestDigit(start) };
                 end = end_;
                 if (!err) return CodeResult{ err, line, start, end };
@@ -327,7 +561,7 @@ namespace hy {
                 }
                 else lexes.emplace_back(token, line, start, end);
             }
-            else if (freestanding::cvt::isblank(*start)) end = TestDelim(start); // 分析空白
+            else if (cls & CC_BLANK) end = TestDelim(start); // 分析空白
             else { // 分析其他字符
                 switch (*start) {
                 case u'\r':
@@ -108,8 +108,10 @@ namespace hy {
 		IO_DEVICE_ERROR, // IO设备错误
 		SCAN_ERROR, // 扫描错误
 		DLL_ERROR, // 动态链接库错误
+		JSON_ERROR, // JSON错误
+		CSV_ERROR, // CSV错误
 
-		MAX_RUNTIME_ERROR = DLL_ERROR,
+		MAX_RUNTIME_ERROR = CSV_ERROR,
 
 		// internal error
 	};
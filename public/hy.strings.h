@@ -19,6 +19,7 @@ namespace hy::strings {
 	constexpr const CStr AUTHOR{ u"钱浩宇" };
 	constexpr const CStr LIB_NAME{ u"libs" };
 	constexpr const CStr LIB_PATH_NAME{ u"libs\\" };
+	constexpr const CStr CACHE_PATH_NAME{ u"cache\\" };
 	constexpr const CStr SOURCE_NAME{ u".hy" };
 	constexpr const CStr BYTECODE_NAME{ u".hyb" };
 	constexpr const CStr BUILTIN_NAME{ u"builtin" };
@@ -403,6 +403,47 @@ namespace hy::util {
 	};
 }
 
+// util::IsASCII
+// util::NarrowASCII
+// util::WidenASCII
+namespace hy::util {
+	// 是否全为ASCII字符, 每次检查4个字符
+	[[nodiscard]] inline bool IsASCII(CStr str, Size len) noexcept {
+		Index i{ };
+		for (Uint64 word; i + 4ULL <= len; i += 4ULL) {
+			freestanding::copy(&word, str + i, sizeof(word));
+			if (word & 0xFF80FF80FF80FF80ULL) return false;
+		}
+		for (; i < len; ++i) {
+			if (str[i] >= 0x80U) return false;
+		}
+		return true;
+	}
+
+	// 是否全为ASCII字节, 每次检查8个字节
+	[[nodiscard]] inline bool IsASCII(const Byte* data, Size len) noexcept {
+		Index i{ };
+		for (Uint64 word; i + 8ULL <= len; i += 8ULL) {
+			freestanding::copy(&word, data + i, sizeof(word));
+			if (word & 0x8080808080808080ULL) return false;
+		}
+		for (; i < len; ++i) {
+			if (data[i] >= 0x80U) return false;
+		}
+		return true;
+	}
+
+	// ASCII字符直接截断为字节, 结果同时是合法的UTF-8与GB2312编码
+	inline void NarrowASCII(CStr str, Size len, Byte* out) noexcept {
+		for (Index i{ }; i < len; ++i) out[i] = static_cast<Byte>(str[i]);
+	}
+
+	// ASCII字节直接扩展为字符
+	inline void WidenASCII(const Byte* data, Size len, Char* out) noexcept {
+		for (Index i{ }; i < len; ++i) out[i] = static_cast<Char>(data[i]);
+	}
+}
+
 // util::TinyStack
 // util::BoolStack
 // util::Stack
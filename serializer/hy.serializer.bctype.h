@@ -27,6 +27,15 @@ namespace hy {
 		Android = 8U
 	};
 
+	// 字节码格式
+	enum class BCFormat : Byte {
+		V1 = 0U, // 定长格式, 可直接映射
+		V2 = 1U, // 紧凑格式, 载入时展开为定长格式
+	};
+
+	// 字节码标志
+	constexpr Byte BC_FLAG_COMPRESSED{ 0x01U }; // 紧凑格式的数据经过块压缩
+
 	// 字节码头
 	struct BCHeader {
 		Byte magic[4]; // 标识
@@ -41,7 +50,9 @@ namespace hy {
 			Byte extra2;		// 附加信息2
 			Byte extra3;		// 附加信息3
 		}platform; // 平台
-		Byte unused[16]; // 未使用
+		BCFormat format; // 字节码格式
+		Byte flags; // 字节码标志
+		Byte unused[14]; // 未使用
 	};
 
 	// 字面值类型
@@ -105,15 +105,59 @@ namespace hy {
 		Index16* dataCallOffset;
 	};
 
+	// 行号表项, 从start起直到下一项之前的指令都属于检查点cp
+	struct LineSegment {
+		Index start; // 指令起始
+		Index32 cp; // 检查点索引, INone32表示不属于任何语句
+	};
+
 	struct InsView {
 		util::Array<CheckPointView> cpViews;
 		util::ArrayView<Ins, Size> insView;
-		Index32 calcLine(const Ins* pos) noexcept {
-			auto index{ static_cast<Index>(pos - insView.cbegin()) };
-			for (auto& cpv : cpViews) {
-				if (index >= cpv.insStart && index <= cpv.insStart + cpv.insOffset) return cpv.line;
+		Vector<LineSegment> lineTable;
+
+		// 载入时由检查点构建按指令有序的行号表, 嵌套语句(如迭代, 分支)内的指令归属最内层语句
+		void buildLineTable() noexcept {
+			lineTable.clear();
+			Vector<Index32> order(cpViews.size()), stack;
+			for (Index32 i{ }; i < order.size(); ++i) order[i] = i;
+			std::stable_sort(order.begin(), order.end(), [this](Index32 a, Index32 b) noexcept {
+				return cpViews[a].insStart < cpViews[b].insStart;
+			});
+			auto setSegment{ [this](Index start, Index32 cp) noexcept {
+				if (!lineTable.empty() && lineTable.back().start == start) lineTable.back().cp = cp;
+				else if (lineTable.empty() || lineTable.back().cp != cp) lineTable.emplace_back(start, cp);
+			} };
+			auto popUntil{ [&](Index pos) noexcept { // 弹出在pos之前结束的语句, 之后的指令交还外层语句
+				while (!stack.empty()) {
+					auto& cpv{ cpViews[stack.back()] };
+					auto end{ cpv.insStart + cpv.insOffset + 1ULL };
+					if (end > pos) break;
+					stack.pop_back();
+					setSegment(end, stack.empty() ? INone32 : stack.back());
+				}
+			} };
+			for (auto i : order) {
+				popUntil(cpViews[i].insStart);
+				setSegment(cpViews[i].insStart, i);
+				stack.emplace_back(i);
 			}
-			return 0U;
+			popUntil(INone64);
+		}
+
+		// 指令所在的最内层语句
+		const CheckPointView* calcStatement(const Ins* pos) const noexcept {
+			auto index{ static_cast<Index>(pos - insView.cbegin()) };
+			auto iter{ std::upper_bound(lineTable.cbegin(), lineTable.cend(), index,
+				[](Index i, const LineSegment& seg) noexcept { return i < seg.start; }) };
+			if (iter == lineTable.cbegin()) return nullptr;
+			auto cp{ (--iter)->cp };
+			return cp == INone32 ? nullptr : &cpViews[cp];
+		}
+
+		Index32 calcLine(const Ins* pos) const noexcept {
+			auto cpv{ calcStatement(pos) };
+			return cpv ? cpv->line : 0U;
 		}
 	};
 
@@ -178,6 +222,14 @@ namespace hy {
 	};
 
 	struct LiteralSection : util::Array<LiteralView> {
+		LiteralSection() noexcept = default;
+
+		// 函数, 类与概念视图由本段独占, 只允许移动, 复制会使两份字面量段重复释放同一视图
+		LiteralSection(const LiteralSection&) = delete;
+		LiteralSection& operator = (const LiteralSection&) = delete;
+		LiteralSection(LiteralSection&&) noexcept = default;
+		LiteralSection& operator = (LiteralSection&&) noexcept = default;
+
 		~LiteralSection() noexcept {
 			for (auto& lv : *this) {
 				switch (lv.type) {
@@ -0,0 +1,178 @@
+﻿/**************************************************
+*
+* @文件				hy.serializer.compact
+* @作者				钱浩宇
+* @创建时间			2022-12-14
+* @更新时间			2022-12-14
+* @摘要
+* 紧凑字节码格式(v2)的公共编码: 变长整数, 读取游标与块压缩
+*
+**************************************************/
+
+#pragma once
+
+#include "../public/hy.util.h"
+#include "hy.serializer.bctype.h"
+
+namespace hy::serialize::compact {
+	/*
+		紧凑格式在字节码头之后的布局:
+			[压缩时] | 原始长度(varint) | 压缩块(...) |
+			| 字符串表 | 字面值段 | 主代码区 | 调试信息(字符串索引) | 资源区 |
+		整数均以LEB128变长编码, 有符号值先做zigzag变换
+		STRING, REF, 资源名及调试源码共用去重后的字符串表
+		检查点的指令起始, 行号及调用偏移均以与前一项的差值编码
+	*/
+
+	// 写出无符号变长整数
+	inline void PutVarint(util::ByteArray& ba, Uint64 v) noexcept {
+		while (v >= 0x80ULL) {
+			ba.append(static_cast<Byte>(v | 0x80ULL));
+			v >>= 7ULL;
+		}
+		ba.append(static_cast<Byte>(v));
+	}
+
+	// 写出有符号变长整数
+	inline void PutZigzag(util::ByteArray& ba, Int64 v) noexcept {
+		PutVarint(ba, (static_cast<Uint64>(v) << 1ULL) ^ static_cast<Uint64>(v >> 63LL));
+	}
+
+	// 读取游标, 任何越界读取都会使ok置假且之后的读取均返回0
+	struct Cursor {
+		const Byte* p;
+		const Byte* end;
+		bool ok{ true };
+
+		Cursor(const Byte* start, const Byte* stop) noexcept : p{ start }, end{ stop } {}
+
+		bool eof() const noexcept {
+			return p == end;
+		}
+
+		Byte byte() noexcept {
+			if (p == end) {
+				ok = false;
+				return 0U;
+			}
+			return *p++;
+		}
+
+		Uint64 varint() noexcept {
+			Uint64 v{ };
+			for (Uint64 shift{ }; shift < 64ULL; shift += 7ULL) {
+				if (p == end) break;
+				auto b{ *p++ };
+				v |= static_cast<Uint64>(b & 0x7FU) << shift;
+				if (!(b & 0x80U)) return v;
+			}
+			ok = false;
+			return 0ULL;
+		}
+
+		Int64 zigzag() noexcept {
+			auto v{ varint() };
+			return static_cast<Int64>(v >> 1ULL) ^ -static_cast<Int64>(v & 1ULL);
+		}
+
+		const Byte* bytes(Size n) noexcept {
+			if (static_cast<Size>(end - p) < n) {
+				ok = false;
+				p = end;
+				return nullptr;
+			}
+			auto ret{ p };
+			p += n;
+			return ret;
+		}
+	};
+}
+
+namespace hy::serialize::compact {
+	/*
+		块压缩(LZ77族, 与LZ4的序列结构相同)
+		序列: | 标记(1B) | [字面长度扩展(varint)] | 字面(...) | 匹配偏移(2B) | [匹配长度扩展(varint)] |
+		标记高4位为字面长度, 低4位为匹配长度减4, 取15时由扩展字段补足
+		最后一个序列只有字面部分
+	*/
+	inline constexpr Size LZ_MIN_MATCH{ 4ULL };
+	inline constexpr Size LZ_MAX_OFFSET{ 0xFFFFULL };
+	inline constexpr Size LZ_HASH_BITS{ 14ULL };
+
+	inline void LZPutSequence(util::ByteArray& out, const Byte* literal, Size literalLen,
+		Size offset, Size matchLen) noexcept {
+		auto matchCode{ matchLen ? matchLen - LZ_MIN_MATCH : 0ULL };
+		out.append(static_cast<Byte>(((literalLen < 15ULL ? literalLen : 15ULL) << 4ULL) |
+			(matchCode < 15ULL ? matchCode : 15ULL)));
+		if (literalLen >= 15ULL) PutVarint(out, literalLen - 15ULL);
+		out.append_bytes(literalLen, literal);
+		if (matchLen) {
+			out.append(static_cast<Byte>(offset & 0xFFULL), static_cast<Byte>(offset >> 8ULL));
+			if (matchCode >= 15ULL) PutVarint(out, matchCode - 15ULL);
+		}
+	}
+
+	// 压缩
+	inline void LZCompress(const Byte* src, Size size, util::ByteArray& out) noexcept {
+		Vector<Index> table(1ULL << LZ_HASH_BITS, INone64);
+		Index anchor{ }, i{ };
+		while (i + LZ_MIN_MATCH <= size) {
+			Uint32 seq;
+			freestanding::copy(&seq, src + i, sizeof(seq));
+			auto& slot{ table[(seq * 2654435761U) >> (32ULL - LZ_HASH_BITS)] };
+			auto cand{ slot };
+			slot = i;
+			if (cand != INone64 && i - cand <= LZ_MAX_OFFSET &&
+				freestanding::compare(src + cand, src + i, LZ_MIN_MATCH) == 0) {
+				auto len{ LZ_MIN_MATCH };
+				while (i + len < size && src[cand + len] == src[i + len]) ++len;
+				LZPutSequence(out, src + anchor, i - anchor, i - cand, len);
+				i += len;
+				anchor = i;
+			}
+			else ++i;
+		}
+		LZPutSequence(out, src + anchor, size - anchor, 0ULL, 0ULL);
+	}
+
+	// 解压时按压缩长度预分配的倍数
+	inline constexpr Size LZ_INITIAL_RATIO{ 4ULL };
+
+	// 解压, 输出长度必须恰好等于rawSize
+	// rawSize来自不可信的字节码头, 不据此一次性分配, 输出缓冲随实际解出的数据倍增至rawSize
+	inline bool LZDecompress(const Byte* src, Size size, Size rawSize, util::ByteArray& out) noexcept {
+		auto initial{ size > rawSize / LZ_INITIAL_RATIO ? rawSize : size * LZ_INITIAL_RATIO };
+		out.resize(initial);
+		Index pos{ };
+		// 确保可再写出n字节, 超出rawSize时失败
+		auto ensure{ [&out, &pos, rawSize](Size n) noexcept {
+			if (rawSize - pos < n) return false;
+			if (out.size() - pos < n) {
+				auto grow{ out.size() > rawSize >> 1ULL ? rawSize : out.size() << 1ULL };
+				out.resize(grow < pos + n ? pos + n : grow);
+			}
+			return true;
+		} };
+		Cursor cur{ src, src + size };
+		while (!cur.eof()) {
+			auto token{ cur.byte() };
+			Size literalLen{ static_cast<Size>(token >> 4U) };
+			if (literalLen == 15ULL) literalLen += cur.varint();
+			auto literal{ cur.bytes(literalLen) };
+			if (!cur.ok || !ensure(literalLen)) return false;
+			freestanding::copy(out.data() + pos, literal, literalLen);
+			pos += literalLen;
+			if (cur.eof()) break;
+			Size offset{ cur.byte() };
+			offset |= static_cast<Size>(cur.byte()) << 8ULL;
+			Size matchLen{ static_cast<Size>(token & 0xFU) };
+			if (matchLen == 15ULL) matchLen += cur.varint();
+			matchLen += LZ_MIN_MATCH;
+			if (!cur.ok || !offset || pos < offset || !ensure(matchLen)) return false;
+			auto dst{ out.data() + pos };
+			for (auto from{ dst - offset }, stop{ dst + matchLen }; dst != stop;) *dst++ = *from++; // 允许重叠
+			pos += matchLen;
+		}
+		return cur.ok && pos == rawSize && out.size() == rawSize;
+	}
+}
@@ -10,6 +10,7 @@
 **************************************************/
 
 #include "hy.serializer.reader.h"
+#include "hy.serializer.compact.h"
 
 namespace hy::serialize {
 	inline Byte* ReadImpl(Byte* data, LiteralType& lt) noexcept {
@@ -110,6 +111,7 @@ namespace hy::serialize {
 				end = reinterpret_cast<Uint32*>(view.insView.end()); begin != end; ++begin)
 				*begin = freestanding::endian::standard_endian(*begin);
 		}
+		view.buildLineTable();
 		return data;
 	}
 
@@ -198,6 +200,212 @@ namespace hy::serialize {
 	}
 }
 
+// 紧凑格式(v2)
+namespace hy::serialize {
+	// 紧凑格式展开器, 将紧凑格式逐项还原为定长格式的字节布局
+	struct CompactExpander {
+		compact::Cursor cur;
+		util::ByteArray& out;
+		Vector<String> strs;
+
+		template<unsigned_integral T>
+		void put(T v) noexcept {
+			if constexpr (!freestanding::endian::is_standard_endian)
+				v = freestanding::endian::standard_endian(v);
+			out.append(v);
+		}
+
+		void putString(const StringView sv) noexcept {
+			put(static_cast<Size32>(sv.size()));
+			if constexpr (freestanding::endian::is_standard_endian) {
+				out.append_bytes(sv.size() * sizeof(Char), sv.data());
+			}
+			else {
+				for (auto ch : sv) put(static_cast<Uint16>(ch));
+			}
+		}
+
+		void putFloats(Size count) noexcept {
+			if (auto p{ cur.bytes(count * sizeof(Float64)) }) out.append_bytes(count * sizeof(Float64), p);
+		}
+
+		StringView getString() noexcept {
+			auto index{ cur.varint() };
+			if (index >= strs.size()) {
+				cur.ok = false;
+				return { };
+			}
+			return strs[index];
+		}
+
+		Index32 getIndex() noexcept {
+			return static_cast<Index32>(cur.varint());
+		}
+
+		bool readStrings() noexcept {
+			auto count{ cur.varint() };
+			for (Index i{ }; cur.ok && i < count; ++i) {
+				auto head{ cur.varint() };
+				auto len{ head >> 1ULL };
+				auto& str{ strs.emplace_back() };
+				if (head & 1ULL) {
+					auto p{ cur.bytes(len * sizeof(Char)) };
+					if (!p) break;
+					str.resize(len);
+					for (Index j{ }; j < len; ++j)
+						str[j] = static_cast<Char>(p[j << 1ULL] | (p[(j << 1ULL) + 1ULL] << 8U));
+				}
+				else {
+					if (len > static_cast<Size>(cur.end - cur.p)) { // 每个字符至少1B
+						cur.ok = false;
+						break;
+					}
+					str.resize(len);
+					for (auto& ch : str) ch = static_cast<Char>(cur.varint());
+				}
+			}
+			return cur.ok;
+		}
+
+		bool expandInsBlock() noexcept {
+			auto cpCount{ cur.varint() };
+			put(static_cast<Size>(cpCount));
+			Index lastStart{ };
+			Index32 lastLine{ };
+			for (Index i{ }; cur.ok && i < cpCount; ++i) {
+				lastStart += static_cast<Index>(cur.zigzag());
+				lastLine += static_cast<Index32>(cur.zigzag());
+				auto insOffset{ static_cast<Index16>(cur.varint()) };
+				auto callCount{ static_cast<Index16>(cur.varint()) };
+				put(lastStart);
+				put(lastLine);
+				put(insOffset);
+				put(callCount);
+				Index16 lastCall{ };
+				for (Index16 j{ }; cur.ok && j < callCount; ++j) {
+					lastCall += static_cast<Index16>(cur.zigzag());
+					put(lastCall);
+				}
+			}
+			auto insCount{ cur.varint() };
+			if (insCount > static_cast<Size>(cur.end - cur.p)) return cur.ok = false; // 每条指令至少2B
+			put(static_cast<Size>(insCount));
+			for (Index i{ }; cur.ok && i < insCount; ++i) {
+				auto type{ static_cast<InsType>(cur.byte()) };
+				auto operand{ cur.varint() };
+				if (operand > INone) return cur.ok = false; // 操作数仅有24位
+				Ins ins{ type, static_cast<Size32>(operand) };
+				if constexpr (freestanding::endian::is_standard_endian) out.append(ins);
+				else put(ins.as());
+			}
+			return cur.ok;
+		}
+
+		bool expandSection() noexcept {
+			auto count{ cur.varint() };
+			put(static_cast<Size32>(count));
+			for (Index i{ }; cur.ok && i < count; ++i) {
+				auto type{ static_cast<LiteralType>(cur.byte()) };
+				out.append(static_cast<Byte>(type));
+				switch (type) {
+				case LiteralType::INT: put(static_cast<Uint64>(cur.zigzag())); break;
+				case LiteralType::FLOAT: putFloats(1ULL); break;
+				case LiteralType::COMPLEX: putFloats(2ULL); break;
+				case LiteralType::INDEXS: {
+					auto n{ cur.varint() };
+					put(static_cast<Size32>(n));
+					for (Index j{ }; cur.ok && j < n; ++j) put(getIndex());
+					break;
+				}
+				case LiteralType::STRING:
+				case LiteralType::REF: putString(getString()); break;
+				case LiteralType::VECTOR: {
+					auto n{ cur.varint() };
+					put(static_cast<Size32>(n));
+					putFloats(n);
+					break;
+				}
+				case LiteralType::MATRIX: {
+					auto row{ static_cast<Size32>(cur.varint()) }, col{ static_cast<Size32>(cur.varint()) };
+					put(row);
+					put(col);
+					putFloats(static_cast<Size>(row) * col);
+					break;
+				}
+				case LiteralType::RANGE: {
+					for (auto j{ 0 }; j < 3; ++j) put(static_cast<Uint64>(cur.zigzag()));
+					break;
+				}
+				case LiteralType::FUNCTION: {
+					for (auto j{ 0 }; j < 4; ++j) put(getIndex());
+					expandInsBlock();
+					break;
+				}
+				case LiteralType::CLASS: {
+					put(getIndex());
+					auto mvCount{ cur.varint() };
+					put(static_cast<Size32>(mvCount));
+					for (Index j{ }; cur.ok && j < mvCount; ++j) {
+						put(getIndex());
+						put(getIndex());
+					}
+					auto mfCount{ cur.varint() };
+					put(static_cast<Size32>(mfCount));
+					for (Index j{ }; cur.ok && j < mfCount; ++j) put(getIndex());
+					break;
+				}
+				case LiteralType::CONCEPT: {
+					put(getIndex());
+					auto subCount{ cur.varint() };
+					put(static_cast<Size32>(subCount));
+					for (Index j{ }; cur.ok && j < subCount; ++j) {
+						put(static_cast<Token>(cur.varint()));
+						put(getIndex());
+					}
+					break;
+				}
+				default: cur.ok = false; break;
+				}
+			}
+			return cur.ok;
+		}
+
+		bool expandResource() noexcept {
+			auto count{ cur.varint() };
+			put(static_cast<Size32>(count));
+			for (Index i{ }; cur.ok && i < count; ++i) {
+				putString(getString());
+				auto dataSize{ cur.varint() };
+				put(static_cast<Size32>(dataSize));
+				if (auto p{ cur.bytes(dataSize) }) out.append_bytes(dataSize, p);
+			}
+			return cur.ok;
+		}
+	};
+
+	// 紧凑格式展开为定长格式
+	inline bool ExpandCompact(const util::ByteArray& ba, util::ByteArray& image) noexcept {
+		auto header{ reinterpret_cast<const BCHeader*>(ba.data()) };
+		auto payload{ ba.data() + sizeof(BCHeader) }, payloadEnd{ ba.data() + ba.size() };
+		util::ByteArray raw;
+		if (header->flags & BC_FLAG_COMPRESSED) {
+			compact::Cursor cur{ payload, payloadEnd };
+			auto rawSize{ cur.varint() };
+			if (!cur.ok || !compact::LZDecompress(cur.p, static_cast<Size>(payloadEnd - cur.p), rawSize, raw))
+				return false;
+			payload = raw.data();
+			payloadEnd = payload + raw.size();
+		}
+		image.clear();
+		image.reserve(sizeof(BCHeader) + (static_cast<Size>(payloadEnd - payload) << 1ULL));
+		image.append_bytes(sizeof(BCHeader), header);
+		CompactExpander expander{ compact::Cursor{ payload, payloadEnd }, image };
+		if (!expander.readStrings() || !expander.expandSection() || !expander.expandInsBlock()) return false;
+		expander.putString(expander.getString()); // 调试信息
+		return expander.expandResource() && expander.cur.eof();
+	}
+}
+
 namespace hy::serialize {
 #define TEST_BYTECODE 0
 
@@ -207,7 +415,11 @@ namespace hy::serialize {
 	// 字节码反序列化
 	bool ReadByteCode(util::ByteArray&& ba, ByteCode& bc) noexcept {
 		if (ba.size() >= ByteCode::MIN_SIZE) {
-			bc.source = freestanding::move(ba);
+			switch (reinterpret_cast<const BCHeader*>(ba.data())->format) {
+			case BCFormat::V1: bc.source = freestanding::move(ba); break;
+			case BCFormat::V2: if (!ExpandCompact(ba, bc.source)) return false; break;
+			default: return false;
+			}
 			Byte* dataBCHeader{ bc.source.data() };
 			Byte* dataBCSection{ ReadBCHeader(dataBCHeader, bc) };
 			Byte* dataBCCode{ ReadBCSection(dataBCSection, bc.values) };
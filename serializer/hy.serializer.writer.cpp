@@ -11,6 +11,7 @@
 
 #include "hy.serializer.writer.h"
 #include "../public/hy.strings.h"
+#include "hy.serializer.compact.h"
 
 namespace hy::serialize {
 	inline Size Calculate(const StringView sv) noexcept {
@@ -34,6 +35,11 @@ namespace hy::serialize {
 		return data + 1U;
 	}
 
+	inline Byte* WriteImpl(Byte* data, BCFormat v) noexcept {
+		*data = static_cast<Byte>(v);
+		return data + 1U;
+	}
+
 	template<unsigned_integral T>
 	inline Byte* WriteImpl(Byte* data, T v) noexcept {
 		if constexpr (!freestanding::endian::is_standard_endian)
@@ -119,12 +125,14 @@ namespace hy::serialize {
 		freestanding::copy(header.maxVer, config.maxVer, freestanding::size(header.maxVer));
 		header.platform.os = PLATFORM_TYPE;
 		header.platform.extra1 = header.platform.extra2 = header.platform.extra3 = 0U;
+		header.format = config.format;
+		header.flags = config.format == BCFormat::V2 && config.compress ? BC_FLAG_COMPRESSED : 0U;
 		freestanding::initialize_n(header.unused, 0, freestanding::size(header.unused));
 
 		/*
 			| 标识(4B) | 字节码哈希值(4B) | 字节码哈希长度(8B) |
 			| 版本号(4B) | 最低虚拟机版本(4B) | 最高虚拟机版本(4B) |
-			| 平台(4B) | 未用(16B) |
+			| 平台(4B) | 格式(1B) | 标志(1B) | 未用(14B) |
 		*/
 		if constexpr (freestanding::endian::is_standard_endian) {
 			return Write(data, BytesWrapper<BCHeader>(&header, 1ULL));
@@ -132,7 +140,7 @@ namespace hy::serialize {
 		else {
 			return Write(data, header.magic, header.hash, header.hashCount,
 				header.version, header.minVer, header.maxVer,
-				header.platform, header.unused);
+				header.platform, header.format, header.flags, header.unused);
 		}
 	}
 }
@@ -351,6 +359,178 @@ namespace hy::serialize {
 	}
 }
 
+// 紧凑格式(v2)
+namespace hy::serialize {
+	// 紧凑格式编码器, 各区域的语义与定长格式一一对应
+	struct CompactWriter {
+		util::ByteArray out;
+		Vector<StringView> strs; // 去重字符串表
+		HashMap<StringView, Index32> strMap;
+
+		Index32 intern(const StringView sv) noexcept {
+			if (auto iter{ strMap.find(sv) }; iter != strMap.cend()) return iter->second;
+			auto index{ static_cast<Index32>(strs.size()) };
+			strs.emplace_back(sv);
+			strMap.try_emplace(sv, index);
+			return index;
+		}
+
+		void writeStrings() noexcept {
+			/*    | 字符串数量 | { 长度 << 1 | 宽字符标志 | 字符(varint或2B) } |    */
+			compact::PutVarint(out, strs.size());
+			for (auto& sv : strs) {
+				// 以变长编码为主, 宽字符居多(如中文)时按原始2B存储更短
+				Size varintSize{ };
+				for (auto ch : sv) varintSize += ch < 0x80U ? 1ULL : ch < 0x4000U ? 2ULL : 3ULL;
+				auto wide{ varintSize > sv.size() * sizeof(Char) };
+				compact::PutVarint(out, (sv.size() << 1ULL) | static_cast<Size>(wide));
+				if (wide) {
+					for (auto ch : sv) out.append(static_cast<Byte>(ch & 0xFFU), static_cast<Byte>(ch >> 8U));
+				}
+				else {
+					for (auto ch : sv) compact::PutVarint(out, ch);
+				}
+			}
+		}
+
+		void writeInsBlock(InsBlock& insBlock) noexcept {
+			/*
+				| 检查点数量 | { 指令起始差值 | 行号差值 | 指令偏移 | 调用数 | { 调用偏移差值 } } |
+				| 指令数 | { 操作码(1B) | 操作数 } |
+			*/
+			compact::PutVarint(out, insBlock.cps.size());
+			Index lastStart{ };
+			Index32 lastLine{ };
+			for (auto& checkpoint : insBlock.cps) {
+				compact::PutZigzag(out, static_cast<Int64>(checkpoint.insStart - lastStart));
+				compact::PutZigzag(out, static_cast<Int64>(checkpoint.line) - static_cast<Int64>(lastLine));
+				compact::PutVarint(out, checkpoint.insOffset);
+				compact::PutVarint(out, checkpoint.callOffset.size());
+				Index16 lastCall{ };
+				for (auto call_offset : checkpoint.callOffset) {
+					compact::PutZigzag(out, static_cast<Int64>(call_offset) - static_cast<Int64>(lastCall));
+					lastCall = call_offset;
+				}
+				lastStart = checkpoint.insStart;
+				lastLine = checkpoint.line;
+			}
+			compact::PutVarint(out, insBlock.iset.size());
+			for (auto& ins : insBlock.iset) {
+				out.append(static_cast<Byte>(ins.type));
+				compact::PutVarint(out, ins.get<Size32>());
+			}
+		}
+
+		void writeFloats(const Float64* data, Size count) noexcept {
+			if constexpr (freestanding::endian::is_standard_endian) {
+				out.append_bytes(count * sizeof(Float64), data);
+			}
+			else {
+				for (Index i{ }; i < count; ++i) out.append(data[i]);
+			}
+		}
+
+		void writeSection(LiteralPool& pool) noexcept {
+			/*    | 字面值数量 | { 字面值类型(1B) | 字面值(...) } |    */
+			compact::PutVarint(out, pool.count());
+			for (auto& t : pool) {
+				out.append(static_cast<Byte>(t.type));
+				switch (t.type) {
+				case LiteralType::INT: compact::PutZigzag(out, t.v.vInt); break;
+				case LiteralType::FLOAT: writeFloats(&t.v.vFloat, 1ULL); break;
+				case LiteralType::COMPLEX: writeFloats(&t.v.vComplex.re, 1ULL); writeFloats(&t.v.vComplex.im, 1ULL); break;
+				case LiteralType::INDEXS: {
+					compact::PutVarint(out, t.v.vIndexs->size());
+					for (auto index : *t.v.vIndexs) compact::PutVarint(out, index);
+					break;
+				}
+				case LiteralType::STRING: compact::PutVarint(out, intern(*t.v.vString)); break;
+				case LiteralType::REF: compact::PutVarint(out, intern(t.v.vRef->data)); break;
+				case LiteralType::VECTOR: {
+					compact::PutVarint(out, t.v.vVector->size());
+					writeFloats(t.v.vVector->data(), t.v.vVector->size());
+					break;
+				}
+				case LiteralType::MATRIX: {
+					compact::PutVarint(out, t.v.vMatrix->mRow);
+					compact::PutVarint(out, t.v.vMatrix->mCol);
+					writeFloats(t.v.vMatrix->data(), t.v.vMatrix->size());
+					break;
+				}
+				case LiteralType::RANGE: {
+					compact::PutZigzag(out, t.v.vRange->start);
+					compact::PutZigzag(out, t.v.vRange->step);
+					compact::PutZigzag(out, t.v.vRange->end);
+					break;
+				}
+				case LiteralType::FUNCTION: {
+					auto& func{ *t.v.vFunction };
+					compact::PutVarint(out, func.index_name);
+					compact::PutVarint(out, func.index_targs);
+					compact::PutVarint(out, func.index_ret);
+					compact::PutVarint(out, func.va_targs);
+					writeInsBlock(func.insFunc);
+					break;
+				}
+				case LiteralType::CLASS: {
+					auto& cls{ *t.v.vClass };
+					compact::PutVarint(out, cls.index_name);
+					compact::PutVarint(out, cls.mvs.size());
+					for (auto& [index_type, index_names] : cls.mvs) {
+						compact::PutVarint(out, index_type);
+						compact::PutVarint(out, index_names);
+					}
+					compact::PutVarint(out, cls.mfs.size());
+					for (auto index_func : cls.mfs) compact::PutVarint(out, index_func);
+					break;
+				}
+				case LiteralType::CONCEPT: {
+					auto& cpt{ *t.v.vConcept };
+					compact::PutVarint(out, cpt.index_name);
+					compact::PutVarint(out, cpt.subs.size());
+					for (auto& sub : cpt.subs) {
+						compact::PutVarint(out, static_cast<Token>(sub.type));
+						compact::PutVarint(out, sub.arg);
+					}
+					break;
+				}
+				}
+			}
+		}
+	};
+
+	// 紧凑格式序列化, header为已写好哈希值的定长格式字节码头
+	inline void WriteCompact(CompileTable& table, util::ByteArray& ba, CompilerConfig& config,
+		const StringView source, const BCHeader* header) noexcept {
+		CompactWriter writer;
+		// 字符串表须位于最前, 先收集所有字符串
+		for (auto& t : table.pool) {
+			if (t.type == LiteralType::STRING) writer.intern(*t.v.vString);
+			else if (t.type == LiteralType::REF) writer.intern(t.v.vRef->data);
+		}
+		auto debugIndex{ writer.intern(config.debugMode ? source : StringView{ }) };
+		for (auto& [name, res] : config.resMap) writer.intern(name);
+		writer.writeStrings();
+		writer.writeSection(table.pool);
+		writer.writeInsBlock(table.mainCode);
+		compact::PutVarint(writer.out, debugIndex);
+		/*    | 资源数量 | { 资源名索引 | 资源数据长度 | 资源数据(...) } |    */
+		compact::PutVarint(writer.out, config.resMap.size());
+		for (auto& [name, res] : config.resMap) {
+			compact::PutVarint(writer.out, writer.intern(name));
+			compact::PutVarint(writer.out, res.size());
+			writer.out.append_bytes(res.size(), res.data());
+		}
+		ba.clear();
+		ba.append_bytes(sizeof(BCHeader), header);
+		if (header->flags & BC_FLAG_COMPRESSED) {
+			compact::PutVarint(ba, writer.out.size());
+			compact::LZCompress(writer.out.data(), writer.out.size(), ba);
+		}
+		else ba += writer.out;
+	}
+}
+
 namespace hy::serialize {
 #define TEST_BYTECODE 0
 
@@ -377,6 +557,12 @@ namespace hy::serialize {
 		Write(dataHashCount, static_cast<Size>(dataBCDebug - dataBCSection));
 		// make sure to 'dataEnd' equals 'dataBCHeader' plus 'totalSize'
 		(void)(dataBCHeader + totalSize == dataEnd);
+		// 紧凑格式的哈希值仍以定长格式计算, 载入展开后按原方式校验
+		if (config.format == BCFormat::V2) {
+			BCHeader header;
+			freestanding::copy(&header, dataBCHeader, sizeof(BCHeader));
+			WriteCompact(table, ba, config, source, &header);
+		}
 	}
 #if TEST_BYTECODE
 #pragma optimize("", on)
@@ -1346,7 +1346,25 @@ namespace hy {
 }
 
 namespace hy {
+	// 分析期间将语法分析器的内存池设为当前线程的内存池
+	struct ASTArenaGuard {
+		ASTArena* last;
+
+		explicit ASTArenaGuard(ASTArena& arena) noexcept : last{ ASTArena::current } {
+			ASTArena::current = &arena;
+		}
+
+		~ASTArenaGuard() noexcept {
+			ASTArena::current = last;
+		}
+
+		ASTArenaGuard(const ASTArenaGuard&) = delete;
+		ASTArenaGuard& operator = (const ASTArenaGuard&) = delete;
+	};
+
+	// 上一次分析的语法树随内存池一次性释放
 	inline void Clean(Syntaxer* syntaxer) noexcept {
+		syntaxer->arena.clear();
 		syntaxer->root.reset(SyntaxToken::Program, 0U);
 	}
 
@@ -1358,6 +1376,7 @@ namespace hy {
 	}
 
 	LIB_EXPORT CodeResult SyntaxerAnalyse(Syntaxer * syntaxer, Lexer * lexer) noexcept {
+		ASTArenaGuard guard{ syntaxer->arena };
 		Clean(syntaxer);
 		syntaxer->source = lexer->source;
 		auto& root{ syntaxer->root };
@@ -13,6 +13,8 @@
 
 #include "../lexer/hy.lexer.h"
 
+#include <new>
+
 namespace hy {
 	// 语法结构符号
 	enum class SyntaxToken : Token {
@@ -83,9 +85,76 @@ namespace hy {
 		END = Program,      // 语法结构结束
 	};
 
+	// 语法树内存池
+	// 结点的子结点表均在池中按块连续分配, 不单独释放, 随语法分析器一次性释放
+	struct ASTArena {
+		static constexpr Size BLOCK_SIZE{ 64ULL << 10ULL };
+		static constexpr Size ALIGN{ alignof(void*) };
+
+		// 当前线程分析所用的内存池, 由语法分析器在分析期间设置
+		static inline thread_local ASTArena* current{ };
+
+		Vector<Byte*> blocks;
+		Byte* cur{ };
+		Byte* stop{ };
+		Size reservedBytes{ }; // 已申请的字节数
+		Size usedBytes{ }; // 已分配的字节数
+
+		ASTArena() noexcept = default;
+
+		~ASTArena() noexcept {
+			clear();
+		}
+
+		ASTArena(const ASTArena&) = delete;
+		ASTArena& operator = (const ASTArena&) = delete;
+
+		static constexpr Size align(Size bytes) noexcept {
+			return (bytes + ALIGN - 1ULL) & ~(ALIGN - 1ULL);
+		}
+
+		void clear() noexcept {
+			for (auto block : blocks) delete[] block;
+			blocks.clear();
+			cur = stop = nullptr;
+			reservedBytes = usedBytes = 0ULL;
+		}
+
+		Memory allocate(Size bytes) noexcept {
+			bytes = align(bytes);
+			if (static_cast<Size>(stop - cur) < bytes) {
+				auto blockSize{ bytes > BLOCK_SIZE ? bytes : BLOCK_SIZE };
+				cur = blocks.emplace_back(new Byte[blockSize]);
+				stop = cur + blockSize;
+				reservedBytes += blockSize;
+			}
+			auto p{ cur };
+			cur += bytes;
+			usedBytes += bytes;
+			return p;
+		}
+
+		// p为最近一次分配且当前块剩余空间足够时原地扩展
+		bool extend(Memory p, Size oldBytes, Size newBytes) noexcept {
+			auto start{ static_cast<Byte*>(p) };
+			oldBytes = align(oldBytes);
+			newBytes = align(newBytes);
+			if (start + oldBytes != cur || static_cast<Size>(stop - start) < newBytes) return false;
+			cur = start + newBytes;
+			usedBytes += newBytes - oldBytes;
+			return true;
+		}
+	};
+
 	// 语法树结点
 	struct ASTNode {
-		using ASTList = Vector<ASTNode>;
+		// 子结点表, 子结点连续存放于所属内存池
+		struct ASTList {
+			ASTArena* arena;
+			ASTNode* data;
+			Size32 size;
+			Size32 capacity;
+		};
 
 		struct ASTLeaf {
 			Lex* lex;
@@ -103,20 +172,26 @@ namespace hy {
 			ASTRoot root;
 		}v;
 
+		static ASTList* NewList(ASTArena& arena) noexcept {
+			auto list{ static_cast<ASTList*>(arena.allocate(sizeof(ASTList))) };
+			list->arena = &arena;
+			list->data = nullptr;
+			list->size = list->capacity = 0U;
+			return list;
+		}
+
 		ASTNode(Lex* p = { }) noexcept {
 			v.leaf.lex = p;
 			v.leaf.unused = nullptr;
 		}
 
-		ASTNode(SyntaxToken st, Index32 line) noexcept {
+		ASTNode(ASTArena& arena, SyntaxToken st, Index32 line) noexcept {
 			v.root.token = st;
 			v.root.line = line;
-			v.root.childs = new ASTList;
+			v.root.childs = NewList(arena);
 		}
 
-		~ASTNode() noexcept {
-			if (v.root.childs) delete v.root.childs;
-		}
+		ASTNode(SyntaxToken st, Index32 line) noexcept : ASTNode{ *ASTArena::current, st, line } {}
 
 		ASTNode(const ASTNode&) = delete;
 		ASTNode& operator = (const ASTNode&) = delete;
@@ -136,15 +211,15 @@ namespace hy {
 		}
 
 		Size size() const noexcept {
-			return v.root.childs->size();
+			return v.root.childs->size;
 		}
 
 		ASTNode* begin() noexcept {
-			return v.root.childs->data();
+			return v.root.childs->data;
 		}
 
 		ASTNode* end() noexcept {
-			return v.root.childs->data() + v.root.childs->size();
+			return v.root.childs->data + v.root.childs->size;
 		}
 
 		SyntaxToken& syntaxToken() noexcept { 
@@ -156,28 +231,42 @@ namespace hy {
 		}
 
 		ASTNode& front() noexcept {
-			return v.root.childs->front();
+			return v.root.childs->data[0ULL];
 		}
 
 		ASTNode& back() noexcept {
-			return v.root.childs->back();
+			return v.root.childs->data[v.root.childs->size - 1U];
+		}
+
+		// 扩容子结点表, 结点不持有资源故可逐字节搬移, 旧空间留在池中
+		void grow(Size32 capacity) noexcept {
+			auto& list{ *v.root.childs };
+			auto oldBytes{ sizeof(ASTNode) * list.capacity }, newBytes{ sizeof(ASTNode) * capacity };
+			if (!list.data || !list.arena->extend(list.data, oldBytes, newBytes)) {
+				auto data{ static_cast<ASTNode*>(list.arena->allocate(newBytes)) };
+				if (list.size) freestanding::copy(data, list.data, sizeof(ASTNode) * list.size);
+				list.data = data;
+			}
+			list.capacity = capacity;
 		}
 
 		void reserve(Size len) noexcept {
-			v.root.childs->reserve(len);
+			if (len > v.root.childs->capacity) grow(static_cast<Size32>(len));
 		}
 
 		template<typename... Args>
 		ASTNode& push(Args&&... args) noexcept {
-			return v.root.childs->emplace_back(freestanding::forward<Args>(args)...);
+			auto& list{ *v.root.childs };
+			if (list.size == list.capacity) grow(list.capacity ? list.capacity * 2U : 4U);
+			return *new (list.data + list.size++) ASTNode(freestanding::forward<Args>(args)...);
 		}
 
 		ASTNode& operator[] (Index index) noexcept { 
-			return (*v.root.childs)[index];
+			return v.root.childs->data[index];
 		}
 
 		const ASTNode& operator [] (Index index) const noexcept {
-			return (*v.root.childs)[index];
+			return v.root.childs->data[index];
 		}
 
 		void line(Index32 l) noexcept {
@@ -211,16 +300,14 @@ namespace hy {
 		}
 
 		void reset(Lex* p = { }) noexcept {
-			if (isRoot()) delete v.root.childs;
 			v.leaf.lex = p;
 			v.leaf.unused = nullptr;
 		}
 
 		void reset(SyntaxToken st, Index32 line) noexcept {
-			if (isRoot()) delete v.root.childs;
 			v.root.token = st;
 			v.root.line = line;
-			v.root.childs = new ASTList;
+			v.root.childs = NewList(*ASTArena::current);
 		}
 	};
 }
@@ -244,11 +331,12 @@ namespace hy {
 		constexpr static auto AST_S{ 8ULL };
 		constexpr static auto AST_COUNT{ AST_S + 1ULL };
 
+		ASTArena arena; // 语法树内存池, 需先于root构造
 		ASTNode root;
 		String source;
 		SyntaxerConfig cfg;
 
-		Syntaxer() noexcept : root{ SyntaxToken::Program, 0U } {}
+		Syntaxer() noexcept : root{ arena, SyntaxToken::Program, 0U } {}
 
 		Syntaxer(const Syntaxer&) = delete;
 		Syntaxer& operator = (const Syntaxer&) = delete;
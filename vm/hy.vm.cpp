@@ -108,29 +108,64 @@ namespace hy {
 }
 
 namespace hy {
-	// 校验字节码
-	inline IResult<void> VerifyByteCode(VM* vm, ByteCode* bc) noexcept {
-		auto& source { bc->source };
+	// 校验字节码, 不涉及虚拟机状态, 可在预取线程中调用
+	HYError CheckByteCode(const ByteCode* bc) noexcept {
+		auto& source{ bc->source };
 		auto header{ bc->pHeader };
 		// 校验字节码标识
 		if (header->magic[0] != 0x20 || header->magic[1] != 0x01 ||
 			header->magic[2] != 0x11 || header->magic[3] != 0x05)
-			return SetError(&SetError_ByteCodeBroken, vm);
+			return HYError::BYTECODE_BROKEN;
 		// 校验字节码哈希值长度
 		auto hashStart{ source.data() + ByteCode::MIN_SIZE };
 		if (source.size() < ByteCode::MIN_SIZE + header->hashCount)
-			return SetError(&SetError_ByteCodeBroken, vm);
+			return HYError::BYTECODE_BROKEN;
 		// 校验字节码哈希值
 		auto hash{ freestanding::cvt::hash_bytes<Size32>(hashStart, hashStart + header->hashCount) };
-		if (hash != bc->pHeader->hash)
-			return SetError(&SetError_ByteCodeBroken, vm);
+		if (hash != header->hash)
+			return HYError::BYTECODE_BROKEN;
 		// 校验字节码版本号
 		if (freestanding::compare(header->version, strings::VERSION_ID, freestanding::size(header->version)) != 0)
-			return SetError(&SetError_UnmatchedVersion, vm, header->version, strings::VERSION_NAME);
+			return HYError::UNMATCHED_VERSION;
 		// 校验操作系统平台
 		if (header->platform.os != PLATFORM_TYPE)
+			return HYError::UNMATCHED_PLATFORM;
+		return HYError::NO_ERROR;
+	}
+
+	// 校验字节码并设置错误
+	inline IResult<void> VerifyByteCode(VM* vm, ByteCode* bc) noexcept {
+		auto header{ bc->pHeader };
+		switch (CheckByteCode(bc)) {
+		case HYError::NO_ERROR: return IResult<void>(true);
+		case HYError::UNMATCHED_VERSION:
+			return SetError(&SetError_UnmatchedVersion, vm, header->version, strings::VERSION_NAME);
+		case HYError::UNMATCHED_PLATFORM:
 			return SetError(&SetError_UnmatchedPlatform, vm, static_cast<PlatformType>(header->platform.os), PLATFORM_TYPE);
-		return IResult<void>(true);
+		default: return SetError(&SetError_ByteCodeBroken, vm);
+		}
+	}
+
+	// 导入模块的字节码路径
+	util::Path GetModulePath(VM* vm, RefView refView) noexcept {
+		return vm->libPath + util::Path(refView.toString<util::Path::SLASH>() + strings::BYTECODE_NAME);
+	}
+
+	// 脚本中的相对路径基于虚拟机的工作路径, 不依赖进程当前目录, 多个虚拟机可各自设置
+	String GetWorkFilePath(VM* vm, const StringView path) noexcept {
+		util::Path p{ path };
+		if (p.isRelative()) p = vm->workPath + p;
+		return p.toString();
+	}
+
+	// 运行已载入并校验的模块
+	inline void RunModule(VM* vm, Module* mod) noexcept {
+		Prefetch_Import(vm, mod->bc); // 运行前预取其导入的模块
+		auto nullType{ vm->getType(TypeId::Null) };
+		vm->objectStack.push_link(obj_allocate(nullType));
+		vm->callStack.push(mod, nullType, &mod->bc->mainCode, mod->name, nullptr);
+		RunCallStack(vm, 0ULL);
+		if (vm->ok()) vm->objectStack.pop_unlink();
 	}
 
 	// 检查参数合法性
@@ -188,6 +223,32 @@ namespace hy {
 		return IResult<void>(true);
 	}
 
+	// 调用函数或成员函数对象并取得返回值, 供原生函数回调用户函数
+	// 返回值已链接, 由调用者解除链接
+	IResult<Object*> CallObject(VM* vm, Object* callable, ObjArgsView args) noexcept {
+		FunctionObject* fobj{ };
+		Object* thisObject{ };
+		if (callable->type->v_id == TypeId::Function) fobj = obj_cast<FunctionObject>(callable);
+		else if (callable->type->v_id == TypeId::MemberFunction) {
+			auto mfobj{ obj_cast<MemberFunctionObject>(callable) };
+			fobj = mfobj->funcObject;
+			thisObject = mfobj->thisObject;
+		}
+		else return SetError<Object*>(&SetError_UnmatchedCall, vm, callable->type->v_name, args);
+		if (fobj->ft == FunctionType::NATIVE) {
+			if (fobj->data.native.checkArgs && !CheckNativeArgs(&fobj->targs, args))
+				return SetError<Object*>(&SetError_UnmatchedCall, vm, fobj->name, args);
+			fobj->data.native.func(vm, args, thisObject);
+		}
+		else {
+			auto cstCount{ vm->callStack.size() };
+			if (!CallFunction(vm, fobj, args, thisObject)) return IResult<Object*>();
+			if (!RunCallStack(vm, cstCount)) return IResult<Object*>();
+		}
+		if (vm->error()) return IResult<Object*>();
+		return IResult<Object*>(vm->objectStack.pop_normal());
+	}
+
 	// 注册变量包
 	inline void RegisterPackVariable(SymbolTable& symbols, ObjArgsView args, RefView refView) noexcept {
 		Size i{ };
@@ -208,7 +269,7 @@ namespace hy {
 
 	// 提取函数结构
 	IResult<FunctionObject*> FetchFunctionView(VM* vm, Module* mod, FunctionView& fv, const StringView name) noexcept {
-		auto& ls{ mod->bc.values };
+		auto& ls{ mod->bc->values };
 		// 函数返回值类型
 		auto type_ret{ vm->getType(TypeId::Null) };
 		if (fv.hasRet()) {
@@ -270,7 +331,7 @@ namespace hy {
 		while (cst.size() != cstCount) {
 			auto& topCall{ cst.top() };
 			auto& topMod{ topCall.mod };
-			auto& ls{ topMod->bc.values };
+			auto& ls{ topMod->bc->values };
 
 			// 函数调用结束
 			if (topCall.pIns == topCall.insView->insView.cend()) {
@@ -779,9 +840,17 @@ namespace hy {
 				}
 				else {
 					auto modName{ refView.toString<u'.'>() };
-					auto modPath{ vm->libPath + util::Path(refView.toString<util::Path::SLASH>() + strings::BYTECODE_NAME) };
+					auto modPath{ GetModulePath(vm, refView) };
+					SharedByteCode* bc{ };
 					util::ByteArray ba;
-					if (platform::Platform_ReadFile(&modPath, &ba)) {
+					// 已预取或已被其他虚拟机载入并校验的字节码
+					if (Prefetch_Take(vm, modPath, &bc) || (bc = ModuleCache_Load(modPath))) {
+						auto newModule{ vm->moduleTree.add(refView, modName, modPath, isUsing) };
+						newModule->bc = bc;
+						RunModule(vm, newModule);
+						if (vm->error()) return IResult<void>();
+					}
+					else if (platform::Platform_ReadFile(&modPath, &ba)) { // 重新读取以报告具体错误
 						auto newModule{ vm->moduleTree.add(refView, modName, modPath, isUsing) };
 						RunByteCode(vm, newModule, &ba, true);
 						if (vm->error()) return IResult<void>();
@@ -982,18 +1051,54 @@ namespace hy {
 
 	// 运行字节码
 	void RunByteCode(VM* vm, Module* mod, util::ByteArray* ba, bool movebc) noexcept {
-		if (auto ret{ movebc ? serialize::ReadByteCode(freestanding::move(*ba), mod->bc)
-			: serialize::ReadByteCode(*ba, mod->bc) }) {
-			if (VerifyByteCode(vm, &mod->bc)) { // 校验字节码
-				auto nullType{ vm->getType(TypeId::Null) };
-				vm->objectStack.push_link(obj_allocate(nullType));
-				vm->callStack.push(mod, nullType, &mod->bc.mainCode, mod->name, nullptr);
-				RunCallStack(vm, 0ULL);
-				if (vm->ok()) vm->objectStack.pop_unlink();
-			}
+		mod->bc = new SharedByteCode; // 不经模块缓存, 由该模块单独持有
+		if (auto ret{ movebc ? serialize::ReadByteCode(freestanding::move(*ba), *mod->bc)
+			: serialize::ReadByteCode(*ba, *mod->bc) }) {
+			if (VerifyByteCode(vm, mod->bc)) RunModule(vm, mod); // 校验字节码
 		}
 		else SetError_ByteCodeBroken(vm); // 字节码长度不足MIN_SIZE
 	}
+
+	// 单独运行模块开头的预处理段(导入, 常量, 全局变量, 函数, 类与概念的注册)
+	void RunModulePrelude(VM* vm, Module* mod) noexcept {
+		auto& code{ mod->bc->mainCode };
+		Size count{ };
+		for (auto& ins : code.insView) {
+			if (ins.type < InsType::PRE_IMPORT) break;
+			++count;
+		}
+		mod->preludeCode = code;
+		mod->preludeCode.insView = util::ArrayView<Ins, Size>{ code.insView.data(), count };
+		vm->callStack.push(mod, vm->getType(TypeId::Null), &mod->preludeCode, mod->name, nullptr);
+		RunCallStack(vm, 0ULL);
+	}
+
+	// 载入并校验字节码, 仅运行其预处理段
+	void RunByteCodePrelude(VM* vm, Module* mod, util::ByteArray* ba) noexcept {
+		mod->bc = new SharedByteCode;
+		if (serialize::ReadByteCode(*ba, *mod->bc)) {
+			if (VerifyByteCode(vm, mod->bc)) {
+				Prefetch_Import(vm, mod->bc);
+				RunModulePrelude(vm, mod);
+			}
+		}
+		else SetError_ByteCodeBroken(vm);
+	}
+
+	// 从预处理段之后继续运行模块
+	void RunModuleBody(VM* vm, Module* mod) noexcept {
+		auto nullType{ vm->getType(TypeId::Null) };
+		vm->objectStack.push_link(obj_allocate(nullType));
+		auto& call{ vm->callStack.push(mod, nullType, &mod->bc->mainCode, mod->name, nullptr) };
+		call.pIns += mod->preludeCode.insView.size();
+		RunCallStack(vm, 0ULL);
+		if (vm->ok()) vm->objectStack.pop_unlink();
+	}
+
+	// 仅载入并校验字节码, 不运行
+	bool LoadByteCode(util::ByteArray* ba, ByteCode* bc) noexcept {
+		return serialize::ReadByteCode(*ba, *bc) && CheckByteCode(bc) == HYError::NO_ERROR;
+	}
 }
 
 namespace hy {
@@ -1043,6 +1148,8 @@ namespace hy {
 			{ &AddArrayPrototype, true },
 			{ &AddBinPrototype, true },
 			{ &AddHashSetPrototype, true },
+			{ &AddStreamPrototype, false },
+			{ &AddFilePrototype, true },
 		};
 
 		for (auto& aptFunc : aptFuncsBind) {
@@ -1064,13 +1171,19 @@ namespace hy {
 	}
 
 	LIB_EXPORT void VMClean(VM* vm) noexcept {
+		// 0. 写出标准输出缓冲
+		vm->stdDevice.flush();
+
 		// 1. 清理对象栈残留对象
 		vm->objectStack.clear();
 
 		// 2. 清理调用堆栈
 		vm->callStack.clear();
 
-		// 3. 逆向清理所有模块
+		// 3. 停止模块预取
+		Prefetch_Stop(vm);
+
+		// 4. 逆向清理所有模块
 		auto& modTable{ vm->moduleTree.modTable };
 		auto& modData{ modTable.modData };
 		while (!modData.empty()) {
@@ -1080,7 +1193,10 @@ namespace hy {
 				if (auto handle{ platform::Platform_GetDll(dllPath) })
 					platform::Platform_FreeDll(handle);
 			}
+			// 全局域先于字节码释放
+			auto bc{ mod.bc };
 			modData.pop_back();
+			if (bc) ModuleCache_Release(bc);
 		}
 		modTable.modMap.clear();
 		modTable.usingList.clear();
@@ -368,6 +368,24 @@ namespace hy {
 		fast_io::u16ostring_ref strRef{ &vm->result.msg };
 		print(strRef, u"扫描类型 ", t->v_name, u" 时发生错误");
 	}
+
+	void SetError_JsonParseError(VM* vm, Index pos) noexcept {
+		vm->result.error = HYError::JSON_ERROR;
+		fast_io::u16ostring_ref strRef{ &vm->result.msg };
+		print(strRef, u"JSON文本第 ", pos, u" 字节处解析失败");
+	}
+
+	void SetError_JsonDumpError(VM* vm, TypeObject* t) noexcept {
+		vm->result.error = HYError::JSON_ERROR;
+		fast_io::u16ostring_ref strRef{ &vm->result.msg };
+		print(strRef, t->v_name, u" 无法转换为JSON");
+	}
+
+	void SetError_CsvError(VM* vm, Index row) noexcept {
+		vm->result.error = HYError::CSV_ERROR;
+		fast_io::u16ostring_ref strRef{ &vm->result.msg };
+		print(strRef, u"CSV第 ", row, u" 条记录格式错误");
+	}
 }
 
 namespace hy {
@@ -381,6 +399,7 @@ namespace hy {
 
 	extern "C" __declspec(dllexport)
 		void VMStackTrace(CallStackTrace * cst, VM * vm) noexcept {
+		vm->stdDevice.flush(); // 错误信息之前的输出先写出
 		cst->error = vm->result.error;
 		cst->msg = vm->result.msg;
 		if (!vm->callStack.empty()) {
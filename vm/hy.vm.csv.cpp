@@ -0,0 +1,359 @@
+#include "hy.vm.impl.h"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <thread>
+
+namespace hy::impl::details {
+	/*
+		CSV读取
+		首条记录为表头, 依据其后至多CSV_INFER_ROWS条记录推断各列类型:
+			全为整数时为int, 全为数值(空字段视为NaN)时为float, 否则为string
+		正文在不位于引号内的换行处切分为若干段, 由多个线程并行解析, 线程中只产生整数, 浮点数与字段范围而不分配对象
+		若某列之后出现不符合推断类型的字段, 则提升该列类型(int -> float -> string)后重新解析
+		对象在主线程中统一构造, 同一列中内容相同的字符串字段共享同一个字符串对象
+	*/
+	constexpr auto CSV_INFER_ROWS{ 1000ULL };
+	constexpr auto CSV_CHUNK_MIN{ 1ULL << 20ULL };
+
+	enum class CsvType : Byte {
+		INT, FLOAT, STRING
+	};
+
+	// 字段内容, 引号字段不含两端引号, escaped为真时其中的""需还原为"
+	struct CsvField {
+		const Byte* data;
+		Size size;
+		bool escaped;
+	};
+
+	// 读取一条记录的各字段并前进到下一条记录开头, 格式错误时返回false
+	bool CsvRecord(const Byte*& p, const Byte* end, Byte sep, Vector<CsvField>& fields) noexcept {
+		fields.clear();
+		for (;;) {
+			CsvField field{ p, 0ULL, false };
+			if (p != end && *p == '"') {
+				field.data = ++p;
+				for (;; ++p) {
+					if (p == end) return false;
+					if (*p == '"') {
+						if (p + 1 == end || p[1] != '"') break;
+						field.escaped = true;
+						++p;
+					}
+				}
+				field.size = static_cast<Size>(p++ - field.data);
+			}
+			else {
+				while (p != end && *p != sep && *p != '\n' && *p != '\r' && *p != '"') ++p;
+				field.size = static_cast<Size>(p - field.data);
+			}
+			fields.emplace_back(field);
+			if (p == end) return true;
+			if (*p == sep) ++p;
+			else if (*p == '\n') return ++p, true;
+			else if (*p == '\r') {
+				if (++p != end && *p == '\n') ++p;
+				return true;
+			}
+			else return false; // 未加引号的字段中出现引号, 或闭引号后紧随其他字符
+		}
+	}
+
+	inline bool CsvInt(const CsvField& field, Int64& value) noexcept {
+		auto first{ reinterpret_cast<const char*>(field.data) }, last{ first + field.size };
+		auto [ptr, ec] { std::from_chars(first, last, value) };
+		return field.size && ec == std::errc{ } && ptr == last;
+	}
+
+	inline bool CsvFloat(const CsvField& field, Float64& value) noexcept {
+		if (!field.size) {
+			value = std::numeric_limits<Float64>::quiet_NaN();
+			return true;
+		}
+		auto first{ reinterpret_cast<const char*>(field.data) }, last{ first + field.size };
+		auto [ptr, ec] { std::from_chars(first, last, value) };
+		return ec == std::errc{ } && ptr == last;
+	}
+
+	// 一列在一段中的解析结果, 按列类型只使用其中之一
+	struct CsvColumn {
+		Vector<Int64> ints;
+		Vector<Float64> floats;
+		Vector<CsvField> strings;
+		bool mismatch; // 存在不符合列类型的字段
+	};
+
+	// 由一个线程解析的一段正文
+	struct CsvChunk {
+		const Byte* begin;
+		const Byte* end;
+		Vector<CsvColumn> columns;
+		Size rows;
+		bool ok;
+	};
+
+	void CsvParseChunk(CsvChunk& chunk, const Vector<CsvType>& types, Byte sep) noexcept {
+		auto n{ types.size() };
+		chunk.columns.assign(n, CsvColumn{ });
+		chunk.rows = 0ULL;
+		chunk.ok = true;
+		Vector<CsvField> fields;
+		fields.reserve(n);
+		for (auto p{ chunk.begin }; p != chunk.end;) {
+			if (*p == '\n' || *p == '\r') { // 跳过空行
+				++p;
+				continue;
+			}
+			if (!CsvRecord(p, chunk.end, sep, fields) || fields.size() != n) {
+				chunk.ok = false;
+				return;
+			}
+			for (Index i{ }; i < n; ++i) {
+				auto& column{ chunk.columns[i] };
+				switch (types[i]) {
+				case CsvType::INT: {
+					Int64 value{ };
+					if (!CsvInt(fields[i], value)) column.mismatch = true;
+					column.ints.emplace_back(value);
+					break;
+				}
+				case CsvType::FLOAT: {
+					Float64 value{ };
+					if (!CsvFloat(fields[i], value)) column.mismatch = true;
+					column.floats.emplace_back(value);
+					break;
+				}
+				default:
+					column.strings.emplace_back(fields[i]);
+					break;
+				}
+			}
+			++chunk.rows;
+		}
+	}
+
+	void CsvParseChunks(Vector<CsvChunk>& chunks, const Vector<CsvType>& types, Byte sep) noexcept {
+		if (chunks.size() == 1ULL) return CsvParseChunk(chunks.front(), types, sep);
+		Vector<std::thread> workers;
+		workers.reserve(chunks.size());
+		for (auto& chunk : chunks)
+			workers.emplace_back([&chunk, &types, sep] { CsvParseChunk(chunk, types, sep); });
+		for (auto& worker : workers) worker.join();
+	}
+
+	// 依据样本记录推断列类型, 样本中格式错误的记录留待正式解析时报告
+	Vector<CsvType> CsvInfer(const Byte* p, const Byte* end, Byte sep, Size n) noexcept {
+		Vector<bool> canInt(n, true), canFloat(n, true), any(n, false);
+		Vector<CsvField> fields;
+		for (Index row{ }; row < CSV_INFER_ROWS && p != end;) {
+			if (*p == '\n' || *p == '\r') {
+				++p;
+				continue;
+			}
+			if (!CsvRecord(p, end, sep, fields) || fields.size() != n) break;
+			for (Index i{ }; i < n; ++i) {
+				Int64 iv;
+				Float64 fv;
+				if (fields[i].size) any[i] = true;
+				if (canInt[i] && !CsvInt(fields[i], iv)) canInt[i] = false;
+				if (canFloat[i] && !CsvFloat(fields[i], fv)) canFloat[i] = false;
+			}
+			++row;
+		}
+		Vector<CsvType> types(n);
+		for (Index i{ }; i < n; ++i)
+			types[i] = !any[i] ? CsvType::STRING : canInt[i] ? CsvType::INT : canFloat[i] ? CsvType::FLOAT : CsvType::STRING;
+		return types;
+	}
+
+	// 在引号外的换行处切分正文, 每段至少CSV_CHUNK_MIN字节
+	Vector<CsvChunk> CsvSplit(const Byte* begin, const Byte* end) noexcept {
+		auto size{ static_cast<Size>(end - begin) };
+		Size threads{ std::thread::hardware_concurrency() };
+		threads = std::clamp(std::min(threads, size / CSV_CHUNK_MIN), 1ULL, 64ULL);
+		Vector<CsvChunk> chunks;
+		chunks.reserve(threads);
+		auto inQuote{ false };
+		auto start{ begin }, scanned{ begin };
+		for (Index i{ 1ULL }; i < threads; ++i) {
+			auto p{ begin + size * i / threads };
+			if (p <= start) continue;
+			// 累计引号数的奇偶得到p是否位于引号内, 再前进到引号外的下一行开头
+			inQuote ^= (std::count(scanned, p, static_cast<Byte>('"')) & 1) != 0;
+			for (; p != end; ++p) {
+				if (*p == '"') inQuote = !inQuote;
+				else if (*p == '\n' && !inQuote) break;
+			}
+			if (p == end) break;
+			scanned = ++p;
+			chunks.emplace_back(CsvChunk{ start, p });
+			start = p;
+		}
+		chunks.emplace_back(CsvChunk{ start, end });
+		return chunks;
+	}
+
+	// 构造字符串对象, 字符串可原地修改, 每个字段均为独立的对象
+	// 同一列中原文相同的字段共享首个对象的字符数据(写时复制), 修改其一不影响其他字段
+	struct CsvStrings {
+		VM* vm;
+		HashMap<std::string_view, StringObject*> pool;
+		Vector<Byte> buffer;
+
+		StringObject* get(const CsvField& field) noexcept {
+			std::string_view key{ reinterpret_cast<const char*>(field.data), field.size };
+			if (auto iter{ pool.find(key) }; iter != pool.end()) {
+				auto src{ iter->second };
+				auto sobj{ obj_allocate<StringObject>(src->type) };
+				sobj->share(src, 0ULL, src->size());
+				return sobj;
+			}
+			auto sobj{ make(field) };
+			pool.try_emplace(key, sobj);
+			return sobj;
+		}
+
+		StringObject* make(const CsvField& field) noexcept {
+			auto sobj{ obj_allocate<StringObject>(vm->getType(TypeId::String)) };
+			if (field.escaped) {
+				buffer.clear();
+				for (Index i{ }; i < field.size; ++i) {
+					buffer.emplace_back(field.data[i]);
+					if (field.data[i] == '"') ++i;
+				}
+				platform::Platform_UTF8BytesToString(buffer.data(), buffer.size(), &sobj->value);
+			}
+			else platform::Platform_UTF8BytesToString(field.data, field.size, &sobj->value);
+			return sobj;
+		}
+	};
+
+	// 按列类型构造整列对象, int为数组, float为向量, string为列表
+	Object* CsvMakeColumn(VM* vm, const Vector<CsvChunk>& chunks, Index col, CsvType type, Size rows) noexcept {
+		switch (type) {
+		case CsvType::INT: {
+			auto aobj{ obj_allocate<ArrayObject>(vm->getType(TypeId::Array), nullptr, arg_cast(rows)) };
+			auto dst{ aobj->data.data() };
+			for (auto& chunk : chunks) {
+				auto& src{ chunk.columns[col].ints };
+				freestanding::copy_n(dst, src.data(), src.size());
+				dst += src.size();
+			}
+			return aobj;
+		}
+		case CsvType::FLOAT: {
+			auto vobj{ obj_allocate<VectorObject>(vm->getType(TypeId::Vector), nullptr, arg_cast(rows)) };
+			auto dst{ vobj->data.data() };
+			for (auto& chunk : chunks) {
+				auto& src{ chunk.columns[col].floats };
+				freestanding::copy_n(dst, src.data(), src.size());
+				dst += src.size();
+			}
+			return vobj;
+		}
+		default: {
+			CsvStrings strings{ vm };
+			auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
+			lobj->objects.reserve(rows);
+			for (auto& chunk : chunks) {
+				for (auto& field : chunk.columns[col].strings) {
+					auto sobj{ strings.get(field) };
+					sobj->link();
+					lobj->objects.emplace_back(sobj);
+				}
+			}
+			return lobj;
+		}
+		}
+	}
+}
+
+namespace hy::impl {
+	// 读取UTF-8编码的CSV文本, rows为真时返回记录列表(首项为表头), 否则返回表头到整列的映射
+	// 失败时设置错误并返回空
+	Object* Csv_Read(VM* vm, const Byte* data, Size size, Byte sep, bool rows) noexcept {
+		using details::CsvType;
+		auto p{ data }, end{ data + size };
+		if (size >= 3ULL && p[0] == 0xEFU && p[1] == 0xBBU && p[2] == 0xBFU) p += 3;
+		Vector<details::CsvField> header;
+		if (p != end && !details::CsvRecord(p, end, sep, header)) {
+			SetError_CsvError(vm, 1ULL);
+			return nullptr;
+		}
+		auto n{ header.size() };
+		auto types{ details::CsvInfer(p, end, sep, n) };
+		auto chunks{ details::CsvSplit(p, end) };
+		for (;;) {
+			details::CsvParseChunks(chunks, types, sep);
+			Size total{ 1ULL };
+			for (auto& chunk : chunks) {
+				total += chunk.rows;
+				if (!chunk.ok) {
+					SetError_CsvError(vm, total + 1ULL);
+					return nullptr;
+				}
+			}
+			auto promoted{ false };
+			for (Index i{ }; i < n; ++i) {
+				if (std::any_of(chunks.cbegin(), chunks.cend(), [i](auto& chunk) { return chunk.columns[i].mismatch; })) {
+					types[i] = types[i] == CsvType::INT ? CsvType::FLOAT : CsvType::STRING;
+					promoted = true;
+				}
+			}
+			if (!promoted) break;
+		}
+		Size count{ };
+		for (auto& chunk : chunks) count += chunk.rows;
+		details::CsvStrings names{ vm };
+		if (!rows) {
+			auto mobj{ obj_allocate<MapObject>(vm->getType(TypeId::Map)) };
+			for (Index i{ }; i < n; ++i) {
+				auto key{ names.make(header[i]) }; // 映射复制键, 不可共享
+				auto column{ details::CsvMakeColumn(vm, chunks, i, types[i], count) };
+				key->link();
+				column->link();
+				Map_Set(vm, mobj, key, column);
+				key->unlink();
+				column->unlink();
+			}
+			return mobj;
+		}
+		auto listType{ vm->getType(TypeId::List) };
+		auto lobj{ obj_allocate<ListObject>(listType) };
+		lobj->objects.reserve(count + 1ULL);
+		auto headerRow{ obj_allocate<ListObject>(listType) };
+		headerRow->objects.reserve(n);
+		for (auto& field : header) {
+			auto sobj{ names.get(field) };
+			sobj->link();
+			headerRow->objects.emplace_back(sobj);
+		}
+		headerRow->link();
+		lobj->objects.emplace_back(headerRow);
+		Vector<details::CsvStrings> strings(n, details::CsvStrings{ vm });
+		auto intType{ vm->getType(TypeId::Int) }, floatType{ vm->getType(TypeId::Float) };
+		for (auto& chunk : chunks) {
+			for (Index r{ }; r < chunk.rows; ++r) {
+				auto row{ obj_allocate<ListObject>(listType) };
+				row->objects.reserve(n);
+				for (Index i{ }; i < n; ++i) {
+					auto& column{ chunk.columns[i] };
+					Object* item;
+					switch (types[i]) {
+					case CsvType::INT: item = obj_allocate(intType, arg_cast(column.ints[r])); break;
+					case CsvType::FLOAT: item = obj_allocate(floatType, arg_cast(column.floats[r])); break;
+					default: item = strings[i].get(column.strings[r]); break;
+					}
+					item->link();
+					row->objects.emplace_back(item);
+				}
+				row->link();
+				lobj->objects.emplace_back(row);
+			}
+		}
+		return lobj;
+	}
+}
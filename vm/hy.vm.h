@@ -45,6 +45,10 @@ namespace hy {
 		bool hasSymbol(const StringView name) const noexcept {
 			return has(name);
 		}
+
+		// 遍历符号
+		using util::StringMap<Object*>::begin;
+		using util::StringMap<Object*>::end;
 	};
 
 	// 常量表
@@ -53,6 +57,18 @@ namespace hy {
 	// 软链接表
 	using LinkTable = util::StringViewMap<Object*>;
 
+	// 持有表, 表中对象随表释放
+	struct HoldTable : Vector<Object*> {
+		HoldTable() noexcept = default;
+
+		~HoldTable() noexcept {
+			for (auto obj : *this) obj->unlink();
+		}
+
+		HoldTable(const HoldTable&) = delete;
+		HoldTable& operator = (const HoldTable&) = delete;
+	};
+
 	// 作用域
 	struct Dom {
 		SymbolTable symbols; // 符号表
@@ -63,6 +79,26 @@ namespace hy {
 		SymbolTable symbols; // 全局符号表
 		ConstTable consts; // 常量表
 		LinkTable links; // 软链接表
+		HoldTable holds; // 由快照恢复的软链接目标, 软链接不持有引用, 由此表持有至模块释放
+	};
+
+	// 文件标识, 大小或最后写入时间变化即视为文件已更新
+	struct FileStamp {
+		Uint64 size;
+		Uint64 time;
+
+		bool operator == (const FileStamp&) const noexcept = default;
+	};
+
+	// 模块字节码
+	// 导入的模块经进程级模块缓存载入, 各虚拟机中的同一模块引用同一份只读字节码, 各自只持有全局域
+	struct SharedByteCode : ByteCode {
+		Size refCount{ 1ULL }; // 引用计数, 由模块缓存的锁保护
+		String cacheKey; // 模块缓存中的键, 为空时仅由单个模块持有
+		FileStamp stamp{ }; // 载入时的文件标识
+
+		SharedByteCode() noexcept = default;
+		explicit SharedByteCode(ByteCode&& bc) noexcept : ByteCode(freestanding::move(bc)) {}
 	};
 
 	// 模块
@@ -70,11 +106,12 @@ namespace hy {
 		Index id; // 模块编号
 		String name; // 模块名
 		util::Path modulePath; // 模块路径
-		ByteCode bc; // 字节码
+		SharedByteCode* bc; // 字节码
+		InsView preludeCode; // 预处理段指令视图, 仅在单独运行预处理段时有效
 		HashSet<String> dllPaths; // 动态链接库路径表
 		GlobalDom dom; // 全局域
 
-		Module(Index i, StringView modName, const util::Path& modPath) noexcept : id{ i }, name(modName), modulePath(modPath) {}
+		Module(Index i, StringView modName, const util::Path& modPath) noexcept : id{ i }, name(modName), modulePath(modPath), bc{ } {}
 	};
 
 	// Dll接口
@@ -242,19 +279,49 @@ namespace hy {
 	// 标准图形输出函数
 	using GraphicOutputFunc = bool(*)() noexcept;
 
+	// 标准字节输入函数, 读取至多size字节到buf, 返回实际读取的字节数, 为0表示输入结束
+	using ByteInputFunc = Size(*)(Byte* buf, Size size) noexcept;
+
 	// 标准设备
+	// 字符输出先写入缓冲区, 缓冲区满, 显式刷新, 出错或虚拟机清理时才批量交给charOutputFunc
 	struct StandardDevice {
 		CharInputFunc charInputFunc{ };
 		CharOutputFunc charOutputFunc{ };
 		ErrorFunc errorFunc{ };
 		GraphicOutputFunc graphicOutputFunc{ };
+		ByteInputFunc byteInputFunc{ }; // 可空, 为空时输入逐行经charInputFunc读取
+		Vector<Byte> inputBuffer; // 输入缓冲区, inputPos之后为未读字节
+		Index inputPos{ };
+		bool inputEnd{ }; // 输入已结束
+		Size outputBufferSize{ 0x10000ULL }; // 输出缓冲区字符数, 为0时不缓冲
+		bool lineFlush{ }; // 遇换行即刷新, 用于交互式终端
+		String outputBuffer; // 输出缓冲区
+
+		// 写出缓冲区内容
+		bool flush() noexcept {
+			if (outputBuffer.empty()) return true;
+			auto ret{ charOutputFunc && charOutputFunc(outputBuffer) };
+			outputBuffer.clear();
+			return ret;
+		}
+
+		// 缓冲区自start起追加了新的输出, 按缓冲策略决定是否刷新
+		bool commit(Size start) noexcept {
+			if (outputBuffer.size() >= outputBufferSize ||
+				(lineFlush && outputBuffer.find(u'\n', start) != String::npos)) return flush();
+			return true;
+		}
 	};
 }
 
 namespace hy {
+	// 模块预取器
+	struct ModulePrefetcher;
+
 	// 虚拟机配置
 	struct VMConfig {
 		Size MaxStackDepth{ 0x1000ULL };
+		bool ParallelImport{ true }; // 并行预取导入模块, 预取线程由进程内所有虚拟机共享
 	};
 
 	// 虚拟机
@@ -277,10 +344,13 @@ namespace hy {
 
 		Memory(*syscall)(const StringView) noexcept; // 系统调用
 
+		ModulePrefetcher* prefetcher; // 模块预取器
+
 		VM(const util::Args& args) noexcept {
 			result.error = HYError::NO_ERROR;
 			argv = freestanding::move(args);
 			syscall = nullptr;
+			prefetcher = nullptr;
 		}
 
 		VM(const VM&) = delete;
@@ -9,14 +9,31 @@ namespace hy::platform {
 	LIB_EXPORT bool Platform_FreeDll(Memory handle) noexcept;
 	LIB_EXPORT Memory Platform_GetDllFunction(Memory handle, const char* name) noexcept;
 	LIB_EXPORT void Platform_UTF8ToString(util::ByteArray* ba, String* str) noexcept;
+	LIB_EXPORT void Platform_UTF8BytesToString(const Byte* data, Size size, String* str) noexcept;
 	LIB_EXPORT void Platform_GB2312ToString(util::ByteArray* ba, String* str) noexcept;
-	LIB_EXPORT void Platform_StringToUTF8(String* str, util::ByteArray* ba) noexcept;
-	LIB_EXPORT void Platform_StringToGB2312(String* str, util::ByteArray* ba) noexcept;
+	LIB_EXPORT void Platform_GB2312BytesToString(const Byte* data, Size size, String* str) noexcept;
+	LIB_EXPORT void Platform_StringToUTF8(const StringView str, util::ByteArray* ba) noexcept;
+	LIB_EXPORT void Platform_StringToGB2312(const StringView str, util::ByteArray* ba) noexcept;
+	LIB_EXPORT Memory Platform_OpenFile(const StringView path, FileMode mode) noexcept;
+	LIB_EXPORT Size Platform_ReadHandle(Memory handle, Byte* buf, Size size) noexcept;
+	LIB_EXPORT bool Platform_WriteHandle(Memory handle, const Byte* buf, Size size) noexcept;
+	LIB_EXPORT Int64 Platform_SeekHandle(Memory handle, Int64 offset, Uint32 origin) noexcept;
+	LIB_EXPORT Int64 Platform_HandleSize(Memory handle) noexcept;
+	LIB_EXPORT void Platform_CloseHandle(Memory handle) noexcept;
+	LIB_EXPORT bool Platform_MapFile(const StringView path, const Byte** data, Size* size) noexcept;
+	LIB_EXPORT void Platform_UnmapFile(const Byte* data) noexcept;
+	LIB_EXPORT bool Platform_FileStamp(const StringView path, FileStamp* stamp) noexcept;
 }
 
 namespace hy::impl {
 	IResult<void> String_Concat(VM* vm, String* str, ObjArgsView args, bool newLine) noexcept;
 	IResult<MapObject::ItemPointer> Map_Set(VM* vm, MapObject* obj, Object* key, Object* value) noexcept;
+	IResult<HashSetObject::ItemPointer> HashSet_Set(VM* vm, HashSetObject* obj, Object* key) noexcept;
+	bool Stdin_ReadLine(VM* vm, String* str) noexcept;
+	BinObject* Bin_Map(VM* vm, const StringView path) noexcept;
+	Object* Json_Parse(VM* vm, const Byte* data, Size size) noexcept;
+	bool Json_Dump(VM* vm, Object* obj, String* str) noexcept;
+	Object* Csv_Read(VM* vm, const Byte* data, Size size, Byte sep, bool rows) noexcept;
 }
 
 namespace hy {
@@ -39,6 +56,8 @@ namespace hy {
 	TypeObject* AddArrayPrototype(TypeObject*) noexcept;
 	TypeObject* AddBinPrototype(TypeObject*) noexcept;
 	TypeObject* AddHashSetPrototype(TypeObject*) noexcept;
+	TypeObject* AddStreamPrototype(TypeObject*) noexcept;
+	TypeObject* AddFilePrototype(TypeObject*) noexcept;
 
 	TypeObject* AddObjectPrototype(VM* vm, const StringView name) noexcept;
 	void SetObjectPrototype(VM* vm, TypeObject* type, TypeClassStruct* classStruct) noexcept;
@@ -85,8 +104,30 @@ namespace hy {
 	LIB_EXPORT void SetError_UnsupportedScan(VM* vm, TypeObject* t) noexcept;
 	LIB_EXPORT void SetError_IODeviceError(VM* vm) noexcept;
 	LIB_EXPORT void SetError_ScanError(VM* vm, TypeObject* t) noexcept;
+	LIB_EXPORT void SetError_JsonParseError(VM* vm, Index pos) noexcept;
+	LIB_EXPORT void SetError_JsonDumpError(VM* vm, TypeObject* t) noexcept;
+	LIB_EXPORT void SetError_CsvError(VM* vm, Index row) noexcept;
+
+	HYError CheckByteCode(const ByteCode* bc) noexcept;
+	util::Path GetModulePath(VM* vm, RefView refView) noexcept;
+	String GetWorkFilePath(VM* vm, const StringView path) noexcept;
+
+	SharedByteCode* ModuleCache_Load(const util::Path& modPath) noexcept;
+	void ModuleCache_Release(SharedByteCode* bc) noexcept;
+
+	void Prefetch_Import(VM* vm, const ByteCode* bc) noexcept;
+	bool Prefetch_Take(VM* vm, const util::Path& modPath, SharedByteCode** bc) noexcept;
+	void Prefetch_Stop(VM* vm) noexcept;
 
 	IResult<void> CallFunction(VM* vm, FunctionObject* fobj, ObjArgsView args, Object* thisObject) noexcept;
 	IResult<void> RunCallStack(VM* vm, Size cstCount) noexcept;
+	IResult<Object*> CallObject(VM* vm, Object* callable, ObjArgsView args) noexcept;
 	LIB_EXPORT void RunByteCode(VM* vm, Module* mod, util::ByteArray* ba, bool movebc) noexcept;
+	LIB_EXPORT bool LoadByteCode(util::ByteArray* ba, ByteCode* bc) noexcept;
+
+	void RunModulePrelude(VM* vm, Module* mod) noexcept;
+	LIB_EXPORT void RunByteCodePrelude(VM* vm, Module* mod, util::ByteArray* ba) noexcept;
+	LIB_EXPORT void RunModuleBody(VM* vm, Module* mod) noexcept;
+	LIB_EXPORT bool SaveSnapshot(VM* vm, Module* mainMod, util::ByteArray* out) noexcept;
+	LIB_EXPORT bool LoadSnapshot(VM* vm, Module* mainMod, util::ByteArray* snapshot, util::ByteArray* ba) noexcept;
 }
\ No newline at end of file
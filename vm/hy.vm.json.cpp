@@ -0,0 +1,488 @@
+﻿#include "hy.vm.impl.h"
+
+#include <fast_io/fast_io.h>
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define HY_JSON_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace hy::impl::details {
+	/*
+		JSON解析
+		阶段一: 每次取64字节, 以SIMD比较得到引号, 反斜杠, 结构字符({}[]:,)与空白的位掩码,
+			经位运算排除被转义的引号与字符串内部, 得到结构字符与标量(字符串, 数值, 字面量)起始位置的索引
+		阶段二: 沿索引递归下降构造对象, 仅在字符串与数值内部逐字节处理
+		对象经各类型的对象池分配, 字符串直接解码到新字符串对象中
+	*/
+	constexpr auto JSON_BLOCK{ 64ULL };
+	constexpr auto JSON_MAX_DEPTH{ 1024ULL };
+
+	// 块内各类字符的位掩码, 第i位对应块内第i个字节
+	struct JsonBlock {
+		Uint64 quote;
+		Uint64 backslash;
+		Uint64 op;
+		Uint64 space;
+	};
+
+	constexpr bool JsonIsOp(Byte c) noexcept {
+		return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+	}
+
+	constexpr bool JsonIsSpace(Byte c) noexcept {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+#ifdef HY_JSON_SSE2
+	inline __m128i JsonEq(__m128i block, char c) noexcept {
+		return _mm_cmpeq_epi8(block, _mm_set1_epi8(c));
+	}
+
+	inline Uint64 JsonMask(__m128i mask, Index shift) noexcept {
+		return static_cast<Uint64>(static_cast<Uint32>(_mm_movemask_epi8(mask))) << shift;
+	}
+
+	inline void JsonClassify(const Byte* p, JsonBlock& b) noexcept {
+		b = { };
+		for (Index i{ }; i < JSON_BLOCK; i += 16ULL) {
+			auto block{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)) };
+			// '['与']'置第5位后即为'{'与'}'
+			auto folded{ _mm_or_si128(block, _mm_set1_epi8(0x20)) };
+			b.quote |= JsonMask(JsonEq(block, '"'), i);
+			b.backslash |= JsonMask(JsonEq(block, '\\'), i);
+			b.op |= JsonMask(_mm_or_si128(_mm_or_si128(JsonEq(folded, '{'), JsonEq(folded, '}')),
+				_mm_or_si128(JsonEq(block, ':'), JsonEq(block, ','))), i);
+			b.space |= JsonMask(_mm_or_si128(_mm_or_si128(JsonEq(block, ' '), JsonEq(block, '\t')),
+				_mm_or_si128(JsonEq(block, '\n'), JsonEq(block, '\r'))), i);
+		}
+	}
+#else
+	inline void JsonClassify(const Byte* p, JsonBlock& b) noexcept {
+		b = { };
+		for (Index i{ }; i < JSON_BLOCK; ++i) {
+			auto bit{ 1ULL << i };
+			if (p[i] == '"') b.quote |= bit;
+			else if (p[i] == '\\') b.backslash |= bit;
+			else if (JsonIsOp(p[i])) b.op |= bit;
+			else if (JsonIsSpace(p[i])) b.space |= bit;
+		}
+	}
+#endif
+
+	// 前缀异或, 第i位为第0至i位的异或, 用于由引号位置得到字符串内部
+	inline Uint64 JsonPrefixXor(Uint64 x) noexcept {
+		x ^= x << 1ULL;
+		x ^= x << 2ULL;
+		x ^= x << 4ULL;
+		x ^= x << 8ULL;
+		x ^= x << 16ULL;
+		x ^= x << 32ULL;
+		return x;
+	}
+
+	// 阶段一, index以size结尾, 字符串未闭合或输入超过4GB时返回false
+	bool JsonIndex(const Byte* data, Size size, Vector<Uint32>& index) noexcept {
+		constexpr auto EVEN_BITS{ 0x5555555555555555ULL };
+		if (size >= 0xFFFFFFFFULL) return false;
+		index.clear();
+		index.reserve((size >> 2ULL) + 1ULL);
+		Uint64 prevEscaped{ }, prevInString{ }, prevScalar{ };
+		for (Index pos{ }; pos < size; pos += JSON_BLOCK) {
+			JsonBlock b;
+			if (size - pos >= JSON_BLOCK) JsonClassify(data + pos, b);
+			else { // 末尾不足一块时以空白补齐
+				Byte tail[JSON_BLOCK];
+				freestanding::initialize(tail, ' ', JSON_BLOCK);
+				freestanding::copy(tail, data + pos, size - pos);
+				JsonClassify(tail, b);
+			}
+			// 奇数长度反斜杠序列之后的字符被转义
+			auto backslash{ b.backslash & ~prevEscaped };
+			auto followsEscape{ backslash << 1ULL | prevEscaped };
+			auto oddStarts{ backslash & ~EVEN_BITS & ~followsEscape };
+			auto evenCarries{ oddStarts + backslash };
+			prevEscaped = evenCarries < oddStarts ? 1ULL : 0ULL;
+			auto escaped{ (EVEN_BITS ^ (evenCarries << 1ULL)) & followsEscape };
+			// 字符串内部含开引号而不含闭引号
+			auto quote{ b.quote & ~escaped };
+			auto inString{ JsonPrefixXor(quote) ^ prevInString };
+			prevInString = static_cast<Uint64>(static_cast<Int64>(inString) >> 63LL);
+			// 标量起始为不紧随其他非引号标量字符的标量字符
+			auto scalar{ ~(b.op | b.space) };
+			auto nonQuoteScalar{ scalar & ~quote };
+			auto followsScalar{ nonQuoteScalar << 1ULL | prevScalar };
+			prevScalar = nonQuoteScalar >> 63ULL;
+			auto structural{ (b.op | (scalar & ~followsScalar)) & ~(inString ^ quote) };
+			for (; structural; structural &= structural - 1ULL)
+				index.emplace_back(static_cast<Uint32>(pos + static_cast<Size>(std::countr_zero(structural))));
+		}
+		index.emplace_back(static_cast<Uint32>(size));
+		return !prevInString;
+	}
+
+	// 阶段二
+	struct JsonParser {
+		VM* vm;
+		const Byte* data;
+		Size size;
+		const Uint32* token;
+		const Uint32* last;
+		Index errorPos;
+
+		bool fail(Index pos) noexcept {
+			errorPos = pos;
+			return false;
+		}
+
+		// 数值与字面量之后须为结尾, 空白或结构字符
+		// 紧随其后的引号不计入索引, 因而必须在此拒绝
+		bool delimited(Index pos) const noexcept {
+			return pos == size || JsonIsSpace(data[pos]) || JsonIsOp(data[pos]);
+		}
+
+		static Int32 hex(Byte c) noexcept {
+			if (c >= '0' && c <= '9') return c - '0';
+			if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') return (c | 0x20) - 'a' + 10;
+			return -1;
+		}
+
+		// 自开引号pos解码字符串到str, 校验UTF-8与转义
+		bool string(Index pos, String& str) noexcept {
+			auto p{ data + pos + 1ULL }, end{ data + size };
+			for (;;) {
+				// 连续的普通ASCII字符整段追加
+				auto run{ p };
+				while (run != end && *run >= 0x20U && *run < 0x80U && *run != '"' && *run != '\\') ++run;
+				if (run != p) {
+					auto old{ str.size() };
+					str.resize(old + static_cast<Size>(run - p));
+					for (auto dst{ str.data() + old }; p != run; ++p, ++dst) *dst = static_cast<Char>(*p);
+				}
+				if (p == end) return fail(size);
+				auto c{ *p };
+				if (c == '"') return true;
+				if (c == '\\') {
+					if (++p == end) return fail(size);
+					switch (*p++) {
+					case '"': str.push_back(u'"'); break;
+					case '\\': str.push_back(u'\\'); break;
+					case '/': str.push_back(u'/'); break;
+					case 'b': str.push_back(u'\b'); break;
+					case 'f': str.push_back(u'\f'); break;
+					case 'n': str.push_back(u'\n'); break;
+					case 'r': str.push_back(u'\r'); break;
+					case 't': str.push_back(u'\t'); break;
+					case 'u': {
+						if (end - p < 4) return fail(size);
+						Int32 u{ };
+						for (Index i{ }; i < 4ULL; ++i) {
+							auto h{ hex(p[i]) };
+							if (h < 0) return fail(static_cast<Index>(p + i - data));
+							u = u << 4 | h;
+						}
+						str.push_back(static_cast<Char>(u));
+						p += 4;
+						break;
+					}
+					default: return fail(static_cast<Index>(p - 1 - data));
+					}
+				}
+				else if (c < 0x20U) return fail(static_cast<Index>(p - data));
+				else { // 多字节UTF-8
+					Uint32 cp;
+					Size n;
+					if ((c & 0xE0U) == 0xC0U) cp = c & 0x1FU, n = 1ULL;
+					else if ((c & 0xF0U) == 0xE0U) cp = c & 0x0FU, n = 2ULL;
+					else if ((c & 0xF8U) == 0xF0U) cp = c & 0x07U, n = 3ULL;
+					else return fail(static_cast<Index>(p - data));
+					if (static_cast<Size>(end - p) <= n) return fail(static_cast<Index>(p - data));
+					for (Index i{ 1ULL }; i <= n; ++i) {
+						if ((p[i] & 0xC0U) != 0x80U) return fail(static_cast<Index>(p + i - data));
+						cp = cp << 6U | (p[i] & 0x3FU);
+					}
+					// 过长编码, 代理区与超出范围的码点
+					constexpr Uint32 minCp[]{ 0U, 0x80U, 0x800U, 0x10000U };
+					if (cp < minCp[n] || cp > 0x10FFFFU || (cp >= 0xD800U && cp <= 0xDFFFU))
+						return fail(static_cast<Index>(p - data));
+					if (cp >= 0x10000U) {
+						cp -= 0x10000U;
+						str.push_back(static_cast<Char>(0xD800U | (cp >> 10U)));
+						str.push_back(static_cast<Char>(0xDC00U | (cp & 0x3FFU)));
+					}
+					else str.push_back(static_cast<Char>(cp));
+					p += n + 1ULL;
+				}
+			}
+		}
+
+		// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, 无小数与指数且不溢出时为整数
+		Object* number(Index pos) noexcept {
+			auto p{ data + pos }, end{ data + size };
+			auto negative{ *p == '-' };
+			if (negative) ++p;
+			if (p == end || *p < '0' || *p > '9') return fail(pos), nullptr;
+			Uint64 value{ };
+			auto overflow{ false };
+			if (*p == '0') ++p;
+			else {
+				for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+					auto digit{ static_cast<Uint64>(*p - '0') };
+					if (value > (0xFFFFFFFFFFFFFFFFULL - digit) / 10ULL) overflow = true;
+					else value = value * 10ULL + digit;
+				}
+			}
+			auto integral{ true };
+			if (p != end && *p == '.') {
+				integral = false;
+				if (++p == end || *p < '0' || *p > '9') return fail(static_cast<Index>(p - data)), nullptr;
+				while (p != end && *p >= '0' && *p <= '9') ++p;
+			}
+			if (p != end && (*p == 'e' || *p == 'E')) {
+				integral = false;
+				if (++p != end && (*p == '+' || *p == '-')) ++p;
+				if (p == end || *p < '0' || *p > '9') return fail(static_cast<Index>(p - data)), nullptr;
+				while (p != end && *p >= '0' && *p <= '9') ++p;
+			}
+			auto stop{ static_cast<Index>(p - data) };
+			if (!delimited(stop)) return fail(stop), nullptr;
+			if (integral && !overflow && value <= (negative ? 0x8000000000000000ULL : 0x7FFFFFFFFFFFFFFFULL)) {
+				auto i{ negative ? static_cast<Int64>(0ULL - value) : static_cast<Int64>(value) };
+				return obj_allocate(vm->getType(TypeId::Int), arg_cast(i));
+			}
+			Float64 f;
+			auto first{ reinterpret_cast<const char*>(data + pos) };
+			if (std::from_chars(first, reinterpret_cast<const char*>(p), f).ec != std::errc{ }) return fail(pos), nullptr;
+			return obj_allocate(vm->getType(TypeId::Float), arg_cast(f));
+		}
+
+		// true, false, null
+		bool literal(Index pos, const char* word, Size len) noexcept {
+			if (size - pos < len || freestanding::compare(data + pos, word, len) || !delimited(pos + len)) return fail(pos);
+			return true;
+		}
+
+		// 取下一个索引, 已至结尾时返回size
+		Index next() noexcept {
+			return token == last ? size : *token++;
+		}
+
+		Object* value(Size depth) noexcept {
+			if (depth >= JSON_MAX_DEPTH) return SetError_StackOverflow(vm), nullptr;
+			auto pos{ next() };
+			if (pos == size) return fail(pos), nullptr;
+			switch (data[pos]) {
+			case '{': return object(depth);
+			case '[': return array(depth);
+			case '"': {
+				auto sobj{ obj_allocate<StringObject>(vm->getType(TypeId::String)) };
+				if (string(pos, sobj->value)) return sobj;
+				sobj->type->f_deallocate(sobj);
+				return nullptr;
+			}
+			case 't': return literal(pos, "true", 4ULL) ? obj_allocate(vm->getType(TypeId::Bool), arg_cast(1LL)) : nullptr;
+			case 'f': return literal(pos, "false", 5ULL) ? obj_allocate(vm->getType(TypeId::Bool), arg_cast(0LL)) : nullptr;
+			case 'n': return literal(pos, "null", 4ULL) ? obj_allocate(vm->getType(TypeId::Null)) : nullptr;
+			default: return number(pos);
+			}
+		}
+
+		Object* array(Size depth) noexcept {
+			auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
+			if (token != last && data[*token] == ']') {
+				++token;
+				return lobj;
+			}
+			for (;;) {
+				auto item{ value(depth + 1ULL) };
+				if (!item) break;
+				item->link();
+				lobj->objects.emplace_back(item);
+				auto pos{ next() };
+				if (pos != size && data[pos] == ']') return lobj;
+				if (pos == size || data[pos] != ',') {
+					fail(pos);
+					break;
+				}
+			}
+			lobj->type->f_deallocate(lobj);
+			return nullptr;
+		}
+
+		Object* object(Size depth) noexcept {
+			auto mobj{ obj_allocate<MapObject>(vm->getType(TypeId::Map)) };
+			if (token != last && data[*token] == '}') {
+				++token;
+				return mobj;
+			}
+			for (;;) {
+				auto pos{ next() };
+				if (pos == size || data[pos] != '"') {
+					fail(pos);
+					break;
+				}
+				auto key{ obj_allocate<StringObject>(vm->getType(TypeId::String)) };
+				key->link(); // 映射复制可变的键, 此处的引用在插入后释放
+				if (!string(pos, key->value)) {
+					key->unlink();
+					break;
+				}
+				if (pos = next(); pos == size || data[pos] != ':') {
+					key->unlink();
+					fail(pos);
+					break;
+				}
+				auto item{ value(depth + 1ULL) };
+				if (!item) {
+					key->unlink();
+					break;
+				}
+				item->link();
+				auto ok{ static_cast<bool>(Map_Set(vm, mobj, key, item)) };
+				key->unlink();
+				item->unlink();
+				if (!ok) break;
+				pos = next();
+				if (pos != size && data[pos] == '}') return mobj;
+				if (pos == size || data[pos] != ',') {
+					fail(pos);
+					break;
+				}
+			}
+			mobj->type->f_deallocate(mobj);
+			return nullptr;
+		}
+	};
+
+	// 序列化
+	struct JsonWriter {
+		VM* vm;
+		String* out;
+
+		void string(const StringView sv) noexcept {
+			constexpr char digits[]{ "0123456789abcdef" };
+			out->push_back(u'"');
+			for (auto c : sv) {
+				switch (c) {
+				case u'"': out->append(u"\\\""); break;
+				case u'\\': out->append(u"\\\\"); break;
+				case u'\n': out->append(u"\\n"); break;
+				case u'\r': out->append(u"\\r"); break;
+				case u'\t': out->append(u"\\t"); break;
+				case u'\b': out->append(u"\\b"); break;
+				case u'\f': out->append(u"\\f"); break;
+				default:
+					if (c < 0x20U) {
+						out->append(u"\\u00");
+						out->push_back(static_cast<Char>(digits[c >> 4U]));
+						out->push_back(static_cast<Char>(digits[c & 0xFU]));
+					}
+					else out->push_back(c);
+				}
+			}
+			out->push_back(u'"');
+		}
+
+		bool write(Object* obj, Size depth) noexcept {
+			if (depth >= JSON_MAX_DEPTH) return SetError_StackOverflow(vm), false;
+			switch (obj->type->v_id) {
+			case TypeId::Null: out->append(u"null"); return true;
+			case TypeId::Bool: out->append(obj_cast<BoolObject>(obj)->value ? u"true" : u"false"); return true;
+			case TypeId::Int: return static_cast<bool>(obj->type->f_string(vm, obj, out));
+			case TypeId::Float:
+				if (!std::isfinite(obj_cast<FloatObject>(obj)->value)) break;
+				return static_cast<bool>(obj->type->f_string(vm, obj, out));
+			case TypeId::String: string(obj_cast<StringObject>(obj)->view()); return true;
+			case TypeId::List: {
+				out->push_back(u'[');
+				for (auto item : obj_cast<ListObject>(obj)->view()) {
+					if (!write(item, depth + 1ULL)) return false;
+					out->push_back(u',');
+				}
+				close(u'[', u']');
+				return true;
+			}
+			case TypeId::Array: {
+				fast_io::u16ostring_ref strRef{ out };
+				out->push_back(u'[');
+				for (auto i : obj_cast<ArrayObject>(obj)->data) print(strRef, i, fast_io::mnp::chvw(u','));
+				close(u'[', u']');
+				return true;
+			}
+			case TypeId::Vector: {
+				fast_io::u16ostring_ref strRef{ out };
+				auto& data{ obj_cast<VectorObject>(obj)->value() };
+				out->push_back(u'[');
+				for (auto f : data) {
+					if (!std::isfinite(f)) return SetError_JsonDumpError(vm, obj->type), false;
+					print(strRef, f, fast_io::mnp::chvw(u','));
+				}
+				close(u'[', u']');
+				return true;
+			}
+			case TypeId::Map: {
+				auto mobj{ obj_cast<MapObject>(obj) };
+				out->push_back(u'{');
+				for (Index i{ }; i < mobj->mCapacity; ++i) {
+					for (auto item{ mobj->mTable[i] }; item; item = item->next) {
+						// 非字符串的键以其字符串形式作为键名
+						auto key{ item->key };
+						if (key->type->v_id == TypeId::String) string(obj_cast<StringObject>(key)->view());
+						else if (key->type->v_id == TypeId::Int || key->type->v_id == TypeId::Float ||
+							key->type->v_id == TypeId::Bool) {
+							out->push_back(u'"');
+							if (!key->type->f_string(vm, key, out)) return false;
+							out->push_back(u'"');
+						}
+						else return SetError_JsonDumpError(vm, key->type), false;
+						out->push_back(u':');
+						if (!write(item->value, depth + 1ULL)) return false;
+						out->push_back(u',');
+					}
+				}
+				close(u'{', u'}');
+				return true;
+			}
+			default: break;
+			}
+			SetError_JsonDumpError(vm, obj->type);
+			return false;
+		}
+
+		// 以闭括号替换末尾逗号, 容器为空时追加闭括号
+		void close(Char open, Char end) noexcept {
+			if (out->back() == open) out->push_back(end);
+			else out->back() = end;
+		}
+	};
+}
+
+namespace hy::impl {
+	// 解析UTF-8编码的JSON文本, 失败时设置错误并返回空
+	Object* Json_Parse(VM* vm, const Byte* data, Size size) noexcept {
+		Vector<Uint32> index;
+		if (!details::JsonIndex(data, size, index)) {
+			SetError_JsonParseError(vm, size + 1ULL);
+			return nullptr;
+		}
+		details::JsonParser parser{ vm, data, size, index.data(), index.data() + index.size() - 1ULL, size };
+		auto obj{ parser.value(0ULL) };
+		if (obj && parser.token != parser.last) {
+			parser.fail(*parser.token);
+			obj->type->f_deallocate(obj);
+			obj = nullptr;
+		}
+		if (!obj && vm->ok()) SetError_JsonParseError(vm, parser.errorPos + 1ULL);
+		return obj;
+	}
+
+	// 序列化为JSON文本并追加到str, 失败时设置错误并返回false
+	bool Json_Dump(VM* vm, Object* obj, String* str) noexcept {
+		details::JsonWriter writer{ vm, str };
+		return writer.write(obj, 0ULL);
+	}
+}
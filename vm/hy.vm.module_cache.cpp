@@ -0,0 +1,74 @@
+﻿#include "hy.vm.impl.h"
+#include "../serializer/hy.serializer.reader.h"
+
+#include <mutex>
+
+namespace hy {
+	// 进程级模块缓存
+	// 同一路径的导入模块在进程内只读取, 反序列化与校验一次, 字节码及其中的字面量段与函数视图由所有虚拟机只读共享
+	// 每次导入都比对文件的大小与最后写入时间, 文件更新后重新载入并替换缓存项, 旧字节码由仍在使用的模块持有至释放
+	// 缓存不持有引用, 最后一个引用它的模块释放时移除
+	struct ModuleCache {
+		std::mutex mtx;
+		HashMap<String, SharedByteCode*> entries;
+
+		// [需持有锁] 查找与文件标识一致的缓存项并增加引用
+		SharedByteCode* acquire(const String& key, const FileStamp& stamp) noexcept {
+			auto iter{ entries.find(key) };
+			if (iter == entries.cend() || !(iter->second->stamp == stamp)) return nullptr;
+			++iter->second->refCount;
+			return iter->second;
+		}
+	};
+
+	inline ModuleCache& GetModuleCache() noexcept {
+		static ModuleCache cache;
+		return cache;
+	}
+
+	// 载入失败时返回空, 由调用者重新读取以报告具体错误
+	SharedByteCode* ModuleCache_Load(const util::Path& modPath) noexcept {
+		auto& cache{ GetModuleCache() };
+		auto key{ modPath.toString() };
+		FileStamp stamp;
+		if (!platform::Platform_FileStamp(key, &stamp)) return nullptr;
+		{
+			std::lock_guard lock{ cache.mtx };
+			if (auto bc{ cache.acquire(key, stamp) }) return bc;
+		}
+		// 读取与反序列化不持有锁, 不同模块可并行载入
+		// 标识取自读取之前, 读取期间文件被改写时下次导入会因标识不符而重新载入
+		util::Path path{ modPath };
+		util::ByteArray ba;
+		if (!platform::Platform_ReadFile(&path, &ba)) return nullptr;
+		auto bc{ new SharedByteCode };
+		if (!serialize::ReadByteCode(freestanding::move(ba), *bc) || CheckByteCode(bc) != HYError::NO_ERROR) {
+			delete bc;
+			return nullptr;
+		}
+		bc->stamp = stamp;
+		std::lock_guard lock{ cache.mtx };
+		// 其他线程已先完成同一版本的载入时使用已登记的字节码
+		if (auto other{ cache.acquire(key, stamp) }) {
+			delete bc;
+			return other;
+		}
+		bc->cacheKey = key;
+		cache.entries.insert_or_assign(freestanding::move(key), bc); // 替换过期项, 过期项不再能被找到
+		return bc;
+	}
+
+	void ModuleCache_Release(SharedByteCode* bc) noexcept {
+		if (bc->cacheKey.empty()) { // 未登记的字节码仅由单个模块持有
+			delete bc;
+			return;
+		}
+		auto& cache{ GetModuleCache() };
+		std::lock_guard lock{ cache.mtx };
+		if (--bc->refCount) return;
+		// 已被新版本替换的过期项不在表中
+		if (auto iter{ cache.entries.find(bc->cacheKey) }; iter != cache.entries.cend() && iter->second == bc)
+			cache.entries.erase(iter);
+		delete bc;
+	}
+}
@@ -17,55 +17,129 @@ namespace hy {
 	template<bool newLine>
 	void Builtin_Print(HVM hvm, ObjArgsView args, Object*) noexcept {
 		auto vm{ vm_cast(hvm) };
-		if (vm->stdDevice.charOutputFunc) {
-			String totalString;
-			if (impl::String_Concat(vm, &totalString, args, newLine)) {
-				vm->stdDevice.charOutputFunc(totalString);
-				vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+		if (auto& device{ vm->stdDevice }; device.charOutputFunc) {
+			// 直接格式化到输出缓冲区, 失败时撤销本次已写入的部分
+			auto start{ device.outputBuffer.size() };
+			if (impl::String_Concat(vm, &device.outputBuffer, args, newLine)) {
+				if (device.commit(start)) vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+				else SetError_IODeviceError(vm);
 			}
+			else device.outputBuffer.resize(start);
 		}
 		else SetError_IODeviceError(vm);
 	}
 
+	void Builtin_Flush(HVM hvm, ObjArgsView, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		if (vm->stdDevice.charOutputFunc && vm->stdDevice.flush())
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+		else SetError_IODeviceError(vm);
+	}
+
 	void Builtin_Scan(HVM hvm, ObjArgsView args, Object*) noexcept {
 		auto vm{ vm_cast(hvm) };
-		if (vm->stdDevice.charInputFunc) {
-			String scanString;
-			if (vm->stdDevice.charInputFunc(&scanString)) {
-				auto begin{ scanString.data() };
-				auto count{ scanString.size() };
-				auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
-				lobj->link();
-				lobj->objects.reserve(args.size());
-				for (auto arg : args) {
-					if (arg->type->v_id != TypeId::Type) {
-						SetError_UnmatchedCall(vm, u"scan", args);
-						lobj->unlink();
-						return;
-					}
-					auto type{ obj_cast<TypeObject>(arg) };
-					if (!type->f_scan) {
-						SetError_UnsupportedScan(vm, type);
-						lobj->unlink();
-						return;
-					}
-					if (auto ir{ type->f_scan(vm, type, StringView{ begin, count }) }) {
-						count -= ir.data;
-						begin += ir.data;
-						lobj->objects.emplace_back(vm->objectStack.pop_normal());
-					}
-					else {
-						lobj->unlink();
-						return;
-					}
+		vm->stdDevice.flush(); // 读取前写出提示信息
+		String scanString;
+		if (impl::Stdin_ReadLine(vm, &scanString)) {
+			auto begin{ scanString.data() };
+			auto count{ scanString.size() };
+			auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
+			lobj->link();
+			lobj->objects.reserve(args.size());
+			for (auto arg : args) {
+				if (arg->type->v_id != TypeId::Type) {
+					SetError_UnmatchedCall(vm, u"scan", args);
+					lobj->unlink();
+					return;
+				}
+				auto type{ obj_cast<TypeObject>(arg) };
+				if (!type->f_scan) {
+					SetError_UnsupportedScan(vm, type);
+					lobj->unlink();
+					return;
+				}
+				if (auto ir{ type->f_scan(vm, type, StringView{ begin, count }) }) {
+					count -= ir.data;
+					begin += ir.data;
+					lobj->objects.emplace_back(vm->objectStack.pop_normal());
+				}
+				else {
+					lobj->unlink();
+					return;
 				}
-				vm->objectStack.push_normal(lobj);
-				return;
 			}
+			vm->objectStack.push_normal(lobj);
+			return;
 		}
 		SetError_IODeviceError(vm);
 	}
 
+	// 只读映射文件为字节集
+	void Builtin_Mmap(HVM hvm, ObjArgsView args, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto path{ GetWorkFilePath(vm, obj_cast<StringObject>(args[0])->view()) };
+		if (auto bobj{ impl::Bin_Map(vm, path) }) vm->objectStack.push_link(bobj);
+		else SetError_FileNotExists(vm, path);
+	}
+
+	// 解析JSON文本, 字符串按UTF-8编码解析, 字节集(如mmap的结果)直接解析
+	void Builtin_JsonParse(HVM hvm, ObjArgsView args, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto arg{ args[0] };
+		Object* obj;
+		if (arg->type->v_id == TypeId::Bin) {
+			auto bytes{ obj_cast<BinObject>(arg)->view() };
+			obj = impl::Json_Parse(vm, bytes.data(), bytes.size());
+		}
+		else if (arg->type->v_id == TypeId::String) {
+			util::ByteArray ba;
+			platform::Platform_StringToUTF8(obj_cast<StringObject>(arg)->view(), &ba);
+			obj = impl::Json_Parse(vm, ba.data(), ba.size());
+		}
+		else return SetError_UnmatchedCall(vm, u"json_parse", args);
+		if (obj) vm->objectStack.push_link(obj);
+	}
+
+	// 序列化为JSON文本, 支持null, bool, int, float, string, list, array, vector与map
+	void Builtin_JsonDump(HVM hvm, ObjArgsView args, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto sobj{ obj_allocate<StringObject>(vm->getType(TypeId::String)) };
+		if (impl::Json_Dump(vm, args[0], &sobj->value)) vm->objectStack.push_link(sobj);
+		else sobj->type->f_deallocate(sobj);
+	}
+
+	// csv_read(source, sep = ","), csv_rows(source, sep = ",")
+	// source为文件路径(映射读取)或字节集, sep为单个ASCII字符
+	template<bool rows>
+	void Builtin_Csv(HVM hvm, ObjArgsView args, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto name{ rows ? u"csv_rows" : u"csv_read" };
+		auto argc{ args.size() };
+		Byte sep{ ',' };
+		if (argc == 2ULL && args[1]->type->v_id == TypeId::String) {
+			auto sv{ obj_cast<StringObject>(args[1])->view() };
+			if (sv.size() != 1ULL || sv.front() >= 0x80U || sv.front() == u'"' ||
+				sv.front() == u'\n' || sv.front() == u'\r') return SetError_UnmatchedCall(vm, name, args);
+			sep = static_cast<Byte>(sv.front());
+		}
+		else if (argc != 1ULL) return SetError_UnmatchedCall(vm, name, args);
+		Object* obj;
+		if (auto arg{ args[0] }; arg->type->v_id == TypeId::Bin) {
+			auto bytes{ obj_cast<BinObject>(arg)->view() };
+			obj = impl::Csv_Read(vm, bytes.data(), bytes.size(), sep, rows);
+		}
+		else if (arg->type->v_id == TypeId::String) {
+			auto path{ GetWorkFilePath(vm, obj_cast<StringObject>(arg)->view()) };
+			const Byte* data;
+			Size size;
+			if (!platform::Platform_MapFile(path, &data, &size)) return SetError_FileNotExists(vm, path);
+			obj = impl::Csv_Read(vm, data, size, sep, rows);
+			platform::Platform_UnmapFile(data);
+		}
+		else return SetError_UnmatchedCall(vm, name, args);
+		if (obj) vm->objectStack.push_link(obj);
+	}
+
 	void Builtin_Prototype(HVM hvm, ObjArgsView args, Object*) noexcept {
 		auto vm{ vm_cast(hvm) };
 		vm->objectStack.push_link(args[0]->type);
@@ -153,11 +227,13 @@ namespace hy {
 		auto typeType{ funcType->type };
 
 		Object* __any[] { nullptr, typeType };
-		ObjArgsView empty, any1{ __any, 1ULL }, any1_tt{ __any, 2ULL };
+		Object* __str[] { vm->getType(TypeId::String) };
+		ObjArgsView empty, any1{ __any, 1ULL }, any1_tt{ __any, 2ULL }, str1{ __str, 1ULL };
 
 		st.setSymbol(u"write", MakeNative(funcType, u"write", &Builtin_Write, empty));
 		st.setSymbol(u"print", MakeNative(funcType, u"print", &Builtin_Print<false>, empty));
 		st.setSymbol(u"println", MakeNative(funcType, u"println", &Builtin_Print<true>, empty));
+		st.setSymbol(u"flush", MakeNative<true>(funcType, u"flush", &Builtin_Flush, empty));
 		st.setSymbol(u"scan", MakeNative(funcType, u"scan", &Builtin_Scan, empty));
 		st.setSymbol(u"prototype", MakeNative<true>(funcType, u"prototype", &Builtin_Prototype, any1));
 		st.setSymbol(u"address", MakeNative<true>(funcType, u"address", &Builtin_Address, any1));
@@ -167,5 +243,12 @@ namespace hy {
 		st.setSymbol(u"copy", MakeNative<true>(funcType, u"copy", &Builtin_Copy, any1));
 		st.setSymbol(u"args", MakeNative<true>(funcType, u"args", &Builtin_Args, empty));
 		st.setSymbol(u"assert", MakeNative(funcType, u"assert", &Builtin_Assert, empty));
+		st.setSymbol(u"mmap", MakeNative<true>(funcType, u"mmap", &Builtin_Mmap, str1));
+		st.setSymbol(u"json_parse", MakeNative<true>(funcType, u"json_parse", &Builtin_JsonParse, any1));
+		st.setSymbol(u"json_dump", MakeNative<true>(funcType, u"json_dump", &Builtin_JsonDump, any1));
+		st.setSymbol(u"csv_read", MakeNative(funcType, u"csv_read", &Builtin_Csv<false>, empty));
+		st.setSymbol(u"csv_rows", MakeNative(funcType, u"csv_rows", &Builtin_Csv<true>, empty));
+
+		st.setSymbol(u"stdin", obj_allocate(vm->getType(TypeId::Stream)));
 	}
 }
\ No newline at end of file
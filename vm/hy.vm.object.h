@@ -8,10 +8,11 @@ namespace hy {
 		Type, Null, Int, Float, Complex,
 		Bool, LV, Iterator, Function, MemberFunction,
 		String, List, Map, Vector, Matrix,
-		Range, Array, Bin, HashSet,
+		Range, Array, Bin, HashSet, Stream,
+		File,
 	};
 
-	constexpr auto TypeIdBuiltinCount{ 19ULL };
+	constexpr auto TypeIdBuiltinCount{ 21ULL };
 	constexpr auto UserTypeIdStart{ 100ULL };
 
 	constexpr auto UserClassFunctionString{ u"__string__" };
@@ -599,16 +600,165 @@ namespace hy {
 		explicit ObjectObject(TypeObject* t) noexcept : Object{ t } {}
 	};
 
+	// 切片共享策略
+	// 切片长度不小于SHARE_MIN_LENGTH且不小于源数据的1/SHARE_MAX_RATIO时与源对象共享数据
+	// 否则直接复制, 避免短切片长期占用大块源数据
+	struct SliceShare {
+		constexpr static auto SHARE_MIN_LENGTH{ 64ULL };
+		constexpr static auto SHARE_MAX_RATIO{ 16ULL };
+
+		static bool check(Size len, Size total) noexcept {
+			return len >= SHARE_MIN_LENGTH && len * SHARE_MAX_RATIO >= total;
+		}
+	};
+
+	// 共享字符串数据
+	struct SharedString {
+		Size refs; // 共享者数量
+		String data;
+	};
+
+	// 字符串字符范围, 惰性计算并在修改时失效
+	// 全为ASCII的字符串与UTF-8, GB2312互转时逐字节截断或扩展而不经过编码转换
+	enum class StringKind : Byte {
+		UNKNOWN, ASCII, WIDE
+	};
+
 	// 字符串
+	// shared为空时数据位于value, 否则为shared->data中[offset, offset + length)的只读视图
+	// 读取使用view(), 修改前使用str()取得独占数据(写时复制), 新分配的字符串总是独占的
 	struct StringObject : Object {
 		String value;
-		explicit StringObject(TypeObject* t) noexcept : Object{ t } {}
+		SharedString* shared;
+		Index offset;
+		Size length;
+		StringKind kind;
+
+		explicit StringObject(TypeObject* t) noexcept :
+			Object{ t }, shared{ }, offset{ }, length{ }, kind{ StringKind::UNKNOWN } {}
+
+		StringView view() const noexcept {
+			if (shared) return StringView{ shared->data.data() + offset, length };
+			return value;
+		}
+
+		Size size() const noexcept {
+			return shared ? length : value.size();
+		}
+
+		bool ascii() noexcept {
+			if (kind == StringKind::UNKNOWN) {
+				auto sv{ view() };
+				kind = util::IsASCII(sv.data(), sv.size()) ? StringKind::ASCII : StringKind::WIDE;
+			}
+			return kind == StringKind::ASCII;
+		}
+
+		String& str() noexcept {
+			kind = StringKind::UNKNOWN;
+			if (shared) {
+				if (shared->refs == 1ULL && offset == 0ULL && length == shared->data.size())
+					value = freestanding::move(shared->data);
+				else value.assign(shared->data.data() + offset, length);
+				release();
+			}
+			return value;
+		}
+
+		// 追加字符, 视图位于共享数据末尾时直接在共享数据后追加而不复制
+		// 其他视图只引用各自的范围, 不受末尾追加影响, 因此反复连接为均摊O(1)
+		void append(const StringView sv) noexcept {
+			kind = StringKind::UNKNOWN;
+			if (shared && offset + length == shared->data.size()) {
+				shared->data.append(sv);
+				length += sv.size();
+			}
+			else str().append(sv);
+		}
+
+		void release() noexcept {
+			if (shared && !--shared->refs) delete shared;
+			shared = nullptr;
+		}
+
+		// 成为src中[pos, pos + len)的视图, src的独占数据先转为共享数据
+		void share(StringObject* src, Index pos, Size len) noexcept {
+			if (!src->shared) {
+				src->shared = new SharedString{ 1ULL, freestanding::move(src->value) };
+				src->offset = 0ULL;
+				src->length = src->shared->data.size();
+				src->value.clear();
+			}
+			release();
+			value.clear();
+			shared = src->shared;
+			++shared->refs;
+			offset = src->offset + pos;
+			length = len;
+			kind = src->kind == StringKind::ASCII ? StringKind::ASCII : StringKind::UNKNOWN;
+		}
+	};
+
+	// 共享列表元素, 每个元素由共享数据持有一次引用
+	struct SharedList {
+		Size refs; // 共享者数量
+		Vector<Object*> data;
 	};
 
 	// 列表
+	// shared为空时元素位于objects, 否则为shared->data中[offset, offset + length)的只读视图
+	// 读取使用view(), 修改前使用vec()取得独占数组(写时复制), 新分配的列表总是独占的
 	struct ListObject : Object {
 		Vector<Object*> objects;
-		explicit ListObject(TypeObject* t) noexcept : Object{ t } {}
+		SharedList* shared;
+		Index offset;
+		Size length;
+
+		explicit ListObject(TypeObject* t) noexcept : Object{ t }, shared{ }, offset{ }, length{ } {}
+
+		ObjArgsView view() noexcept {
+			if (shared) return ObjArgsView{ shared->data.data() + offset, length };
+			return ObjArgsView{ objects.data(), objects.size() };
+		}
+
+		Size size() const noexcept {
+			return shared ? length : objects.size();
+		}
+
+		Vector<Object*>& vec() noexcept {
+			if (shared) {
+				if (shared->refs == 1ULL && offset == 0ULL && length == shared->data.size()) {
+					objects = freestanding::move(shared->data); // 元素引用随数组转移
+					shared->data.clear();
+				}
+				else {
+					objects.assign(shared->data.cbegin() + offset, shared->data.cbegin() + offset + length);
+					for (auto item : objects) item->link();
+				}
+				release();
+			}
+			return objects;
+		}
+
+		inline void release() noexcept;
+
+		// 释放所有元素
+		inline void clear() noexcept;
+
+		// 成为src中[pos, pos + len)的视图, src的独占数组先转为共享数组
+		void share(ListObject* src, Index pos, Size len) noexcept {
+			if (!src->shared) {
+				src->shared = new SharedList{ 1ULL, freestanding::move(src->objects) };
+				src->offset = 0ULL;
+				src->length = src->shared->data.size();
+				src->objects.clear();
+			}
+			release();
+			shared = src->shared;
+			++shared->refs;
+			offset = src->offset + pos;
+			length = len;
+		}
 	};
 
 	// 映射
@@ -633,10 +783,44 @@ namespace hy {
 			Object{ t }, mCapacity{ }, mSize{ }, mThreshold{ }, mTable{ } {}
 	};
 
+	struct VectorObject;
+
+	// 向量的延迟运算
+	// 逐元素运算链只记录步骤, 读取结果时分块一次求值, 省去中间向量的分配与内存往返
+	// source为空表示以结果向量自身的数据为初值, 否则为首个操作数
+	// 作为操作数的向量均持有一次引用, 且在其dependents中登记了结果向量
+	struct VectorExpr {
+		struct Step {
+			BOPTType opt;
+			Float64 scalar;
+			VectorObject* operand; // 为空时使用scalar
+		};
+
+		VectorObject* source;
+		Vector<Step> steps;
+	};
+
 	// 向量
+	// expr非空时data尚未求值, 读取使用value(), 修改使用mutate()
 	struct VectorObject : Object {
 		util::Array<Float64> data;
-		explicit VectorObject(TypeObject* t) noexcept : Object{ t } {}
+		VectorExpr* expr;
+		Vector<VectorObject*> dependents; // 以此向量为操作数且尚未求值的向量
+
+		explicit VectorObject(TypeObject* t) noexcept : Object{ t }, expr{ } {}
+
+		void evaluate() noexcept;
+		void discard() noexcept;
+
+		util::Array<Float64>& value() noexcept {
+			if (expr) evaluate();
+			return data;
+		}
+
+		util::Array<Float64>& mutate() noexcept {
+			while (!dependents.empty()) dependents.back()->evaluate();
+			return value();
+		}
 	};
 
 	// 矩阵
@@ -662,10 +846,73 @@ namespace hy {
 		explicit ArrayObject(TypeObject* t) noexcept : Object{ t } {}
 	};
 
+	// 流
+	// 目前仅有标准输入一个实例, 数据缓冲在虚拟机的标准设备中
+	struct StreamObject : Object {
+		explicit StreamObject(TypeObject* t) noexcept : Object{ t } {}
+	};
+
+	// 共享的只读文件映射
+	struct MappedBin {
+		Size refs; // 共享者数量
+		const Byte* data;
+		Size size;
+	};
+
 	// 字节集
+	// mapped为空时数据位于data, 否则为文件映射中[offset, offset + length)的只读视图
+	// 读取使用view(), 修改前使用bin()取得独占数据(写时复制)
 	struct BinObject : Object {
+		using View = util::ArrayView<const Byte, Size>;
+
 		util::ByteArray data;
-		explicit BinObject(TypeObject* t) noexcept : Object{ t } {}
+		MappedBin* mapped;
+		Index offset;
+		Size length;
+
+		explicit BinObject(TypeObject* t) noexcept : Object{ t }, mapped{ }, offset{ }, length{ } {}
+
+		View view() const noexcept {
+			if (mapped) return View{ mapped->data + offset, length };
+			return View{ data.data(), data.size() };
+		}
+
+		Size size() const noexcept {
+			return mapped ? length : data.size();
+		}
+
+		util::ByteArray& bin() noexcept {
+			if (mapped) {
+				data.assign(mapped->data + offset, length);
+				release();
+			}
+			return data;
+		}
+
+		// 解除对映射的引用, 最后一个引用者负责解除映射
+		void release() noexcept;
+
+		// 成为src中[pos, pos + len)的视图, src须为映射
+		void share(BinObject* src, Index pos, Size len) noexcept {
+			++src->mapped->refs;
+			release();
+			data.clear();
+			mapped = src->mapped;
+			offset = src->offset + pos;
+			length = len;
+		}
+	};
+
+	// 文件打开方式
+	enum class FileMode : Uint32 {
+		READ, WRITE, APPEND, UPDATE
+	};
+
+	// 文件
+	// handle为空表示已关闭
+	struct FileObject : Object {
+		Memory handle;
+		explicit FileObject(TypeObject* t) noexcept : Object{ t }, handle{ } {}
 	};
 
 	// 集合
@@ -694,6 +941,22 @@ namespace hy {
 	inline void Object::unlink() noexcept {
 		if (!--lc) type->f_deallocate(this);
 	}
+
+	inline void ListObject::release() noexcept {
+		if (shared && !--shared->refs) {
+			for (auto item : shared->data) item->unlink();
+			delete shared;
+		}
+		shared = nullptr;
+	}
+
+	inline void ListObject::clear() noexcept {
+		if (shared) release();
+		else {
+			for (auto item : objects) item->unlink();
+			objects.clear();
+		}
+	}
 }
 
 namespace hy {
@@ -7,6 +7,33 @@ namespace hy::platform {
 		constexpr auto CP_GB2312{ 936U };
 		constexpr auto CP_UTF8{ 65001U };
 
+		constexpr auto GENERIC_READ{ 0x80000000U };
+		constexpr auto GENERIC_WRITE{ 0x40000000U };
+		constexpr auto FILE_SHARE_READ_WRITE{ 0x3U };
+		constexpr auto CREATE_ALWAYS{ 2U };
+		constexpr auto OPEN_EXISTING{ 3U };
+		constexpr auto OPEN_ALWAYS{ 4U };
+		constexpr auto FILE_ATTRIBUTE_NORMAL{ 128U };
+		constexpr auto FILE_END{ 2U };
+		constexpr auto PAGE_READONLY{ 0x2U };
+		constexpr auto FILE_MAP_READ{ 0x4U };
+		constexpr auto MAX_IO_SIZE{ 0x40000000ULL }; // 单次读写上限
+		constexpr auto GET_FILE_EX_INFO_STANDARD{ 0 };
+
+		struct FILETIME {
+			Uint32 dwLowDateTime;
+			Uint32 dwHighDateTime;
+		};
+
+		struct WIN32_FILE_ATTRIBUTE_DATA {
+			Uint32 dwFileAttributes;
+			FILETIME ftCreationTime;
+			FILETIME ftLastAccessTime;
+			FILETIME ftLastWriteTime;
+			Uint32 nFileSizeHigh;
+			Uint32 nFileSizeLow;
+		};
+
 		extern "C" {
 			__declspec(dllimport) Memory __stdcall CreateFileMappingFromApp(Memory hFile, Memory SecurityAttributes,
 				Uint32 PageProtection, Uint64 MaximumSize, CStr Name);
@@ -18,7 +45,16 @@ namespace hy::platform {
 				Uint32 dwShareMode, Memory lpSecurityAttributes, Uint32 dwCreationDisposition,
 				Uint32 dwFlagsAndAttributes, Memory hTemplateFile);
 			__declspec(dllimport) Uint32 __stdcall GetFileSize(Memory hFile, Uint32* lpFileSizeHigh);
+			__declspec(dllimport) Int32 __stdcall GetFileSizeEx(Memory hFile, Int64* lpFileSize);
+			__declspec(dllimport) Int32 __stdcall ReadFile(Memory hFile, Memory lpBuffer, Uint32 nSize,
+				Uint32* rSize, Memory lpOverlapped);
+			__declspec(dllimport) Int32 __stdcall WriteFile(Memory hFile, CMemory lpBuffer, Uint32 nSize,
+				Uint32* wSize, Memory lpOverlapped);
+			__declspec(dllimport) Int32 __stdcall SetFilePointerEx(Memory hFile, Int64 liDistanceToMove,
+				Int64* lpNewFilePointer, Uint32 dwMoveMethod);
 			__declspec(dllimport) Int32 __stdcall CloseHandle(Memory hObject);
+			__declspec(dllimport) Int32 __stdcall GetFileAttributesExW(CStr lpFileName, Int32 fInfoLevelId,
+				Memory lpFileInformation);
 
 			__declspec(dllimport) Memory __stdcall LoadLibraryW(CStr lpLibFileName);
 			__declspec(dllimport) Int32 __stdcall FreeLibrary(Memory hLibModule);
@@ -70,43 +106,189 @@ namespace hy::platform {
 		return details::GetProcAddress(handle, name);
 	}
 
+	// 编码转换接口的长度参数为32位, 更长的文本在字符边界处分块转换
+	inline constexpr Size CVT_CHUNK_SIZE{ 0x40000000ULL };
+
+	// UTF-8分块长度, 不在后续字节处切分
+	inline Size UTF8ChunkSize(const Byte* data) noexcept {
+		auto n{ CVT_CHUNK_SIZE };
+		while (n > CVT_CHUNK_SIZE - 4ULL && (data[n] & 0xC0U) == 0x80U) --n;
+		return n;
+	}
+
+	// GB2312分块长度, 首字节不小于0x81的双字节字符不被切分, 尾字节与首字节取值重叠, 需从块首顺序扫描
+	inline Size GB2312ChunkSize(const Byte* data) noexcept {
+		Size n{ };
+		while (n < CVT_CHUNK_SIZE) n += data[n] >= 0x81U ? 2ULL : 1ULL;
+		return n > CVT_CHUNK_SIZE ? n - 2ULL : n;
+	}
+
+	// UTF-16分块长度, 不切分代理对
+	inline Size UTF16ChunkSize(const Char* data) noexcept {
+		auto n{ CVT_CHUNK_SIZE };
+		if (data[n - 1ULL] >= 0xD800U && data[n - 1ULL] <= 0xDBFFU) --n;
+		return n;
+	}
+
+	template<typename ChunkSize>
+	inline void MultiByteToString(Uint32 codePage, const Byte* data, Size size, String* str, ChunkSize&& chunkSize) noexcept {
+		str->clear();
+		while (size) {
+			auto n{ size > CVT_CHUNK_SIZE ? chunkSize(data) : size };
+			auto len{ details::MultiByteToWideChar(codePage, 0, data, static_cast<Int32>(n), nullptr, 0) };
+			auto pos{ str->size() };
+			str->resize(pos + static_cast<Size>(len));
+			details::MultiByteToWideChar(codePage, 0, data, static_cast<Int32>(n), str->data() + pos, len);
+			data += n;
+			size -= n;
+		}
+	}
+
+	inline void StringToMultiByte(Uint32 codePage, const StringView str, util::ByteArray* ba) noexcept {
+		ba->clear();
+		auto data{ str.data() };
+		for (auto size{ str.size() }; size;) {
+			auto n{ size > CVT_CHUNK_SIZE ? UTF16ChunkSize(data) : size };
+			auto len{ details::WideCharToMultiByte(codePage, 0, data, static_cast<Int32>(n), nullptr, 0, nullptr, nullptr) };
+			auto pos{ ba->size() };
+			ba->resize(pos + static_cast<Size>(len));
+			details::WideCharToMultiByte(codePage, 0, data, static_cast<Int32>(n), ba->data() + pos, len, nullptr, nullptr);
+			data += n;
+			size -= n;
+		}
+	}
+
 	void Platform_UTF8ToString(util::ByteArray* ba, String* str) noexcept {
-		auto u8data{ ba->data() };
-		auto u8size{ static_cast<Size32>(ba->size()) };
-		auto u16len{ details::MultiByteToWideChar(details::CP_UTF8, 0,
-			u8data, u8size, nullptr, 0) };
-		str->resize(u16len);
-		details::MultiByteToWideChar(details::CP_UTF8, 0,
-			u8data, u8size, str->data(), u16len);
+		Platform_UTF8BytesToString(ba->data(), ba->size(), str);
+	}
+
+	void Platform_UTF8BytesToString(const Byte* data, Size size, String* str) noexcept {
+		if (util::IsASCII(data, size)) {
+			str->resize(size);
+			util::WidenASCII(data, size, str->data());
+			return;
+		}
+		MultiByteToString(details::CP_UTF8, data, size, str, &UTF8ChunkSize);
 	}
 
 	void Platform_GB2312ToString(util::ByteArray* ba, String* str) noexcept {
-		auto gb2312data{ ba->data() };
-		auto gb2312size{ static_cast<Size32>(ba->size()) };
-		auto u16len{ details::MultiByteToWideChar(details::CP_GB2312, 0,
-			gb2312data, gb2312size, nullptr, 0) };
-		str->resize(u16len);
-		details::MultiByteToWideChar(details::CP_GB2312, 0,
-			gb2312data, gb2312size, str->data(), u16len);
-	}
-
-	void Platform_StringToUTF8(String* str, util::ByteArray* ba) noexcept {
-		auto u16data{ static_cast<CStr>(str->data()) };
-		auto u16size{ static_cast<Size32>(str->size()) };
-		auto u8len{ details::WideCharToMultiByte(details::CP_UTF8, 0, u16data, u16size,
-			nullptr, 0, nullptr, nullptr) };
-		ba->resize(u8len);
-		details::WideCharToMultiByte(details::CP_UTF8, 0, u16data, u16size,
-			ba->data(), u8len, nullptr, nullptr);
-	}
-
-	void Platform_StringToGB2312(String* str, util::ByteArray* ba) noexcept {
-		auto u16data{ static_cast<CStr>(str->data()) };
-		auto u16size{ static_cast<Size32>(str->size()) };
-		auto gb2312len{ details::WideCharToMultiByte(details::CP_GB2312, 0, u16data, u16size,
-			nullptr, 0, nullptr, nullptr) };
-		ba->resize(gb2312len);
-		details::WideCharToMultiByte(details::CP_GB2312, 0, u16data, u16size,
-			ba->data(), gb2312len, nullptr, nullptr);
+		Platform_GB2312BytesToString(ba->data(), ba->size(), str);
+	}
+
+	void Platform_GB2312BytesToString(const Byte* data, Size size, String* str) noexcept {
+		if (util::IsASCII(data, size)) {
+			str->resize(size);
+			util::WidenASCII(data, size, str->data());
+			return;
+		}
+		MultiByteToString(details::CP_GB2312, data, size, str, &GB2312ChunkSize);
+	}
+
+	void Platform_StringToUTF8(const StringView str, util::ByteArray* ba) noexcept {
+		if (util::IsASCII(str.data(), str.size())) {
+			ba->resize(str.size());
+			util::NarrowASCII(str.data(), str.size(), ba->data());
+			return;
+		}
+		StringToMultiByte(details::CP_UTF8, str, ba);
+	}
+
+	void Platform_StringToGB2312(const StringView str, util::ByteArray* ba) noexcept {
+		if (util::IsASCII(str.data(), str.size())) {
+			ba->resize(str.size());
+			util::NarrowASCII(str.data(), str.size(), ba->data());
+			return;
+		}
+		StringToMultiByte(details::CP_GB2312, str, ba);
+	}
+
+	Memory Platform_OpenFile(const StringView path, FileMode mode) noexcept {
+		Uint32 access, disposition;
+		switch (mode) {
+		case FileMode::WRITE: access = details::GENERIC_WRITE; disposition = details::CREATE_ALWAYS; break;
+		case FileMode::APPEND: access = details::GENERIC_WRITE; disposition = details::OPEN_ALWAYS; break;
+		case FileMode::UPDATE: access = details::GENERIC_READ | details::GENERIC_WRITE; disposition = details::OPEN_ALWAYS; break;
+		default: access = details::GENERIC_READ; disposition = details::OPEN_EXISTING; break;
+		}
+		auto hFile{ details::CreateFileW(path.data(), access, details::FILE_SHARE_READ_WRITE,
+			nullptr, disposition, details::FILE_ATTRIBUTE_NORMAL, nullptr) };
+		if (hFile == (Memory)details::INVALID_HANDLE_VALUE) return nullptr;
+		if (mode == FileMode::APPEND) details::SetFilePointerEx(hFile, 0LL, nullptr, details::FILE_END);
+		return hFile;
+	}
+
+	// 读满size字节或到达文件末尾为止, 返回实际读取的字节数
+	Size Platform_ReadHandle(Memory handle, Byte* buf, Size size) noexcept {
+		Size total{ };
+		while (total < size) {
+			auto request{ static_cast<Uint32>(size - total < details::MAX_IO_SIZE ? size - total : details::MAX_IO_SIZE) };
+			Uint32 nBytes{ };
+			if (!details::ReadFile(handle, buf + total, request, &nBytes, nullptr) || !nBytes) break;
+			total += nBytes;
+		}
+		return total;
+	}
+
+	bool Platform_WriteHandle(Memory handle, const Byte* buf, Size size) noexcept {
+		Size total{ };
+		while (total < size) {
+			auto request{ static_cast<Uint32>(size - total < details::MAX_IO_SIZE ? size - total : details::MAX_IO_SIZE) };
+			Uint32 nBytes{ };
+			if (!details::WriteFile(handle, buf + total, request, &nBytes, nullptr) || !nBytes) return false;
+			total += nBytes;
+		}
+		return true;
+	}
+
+	// origin: 0文件开头, 1当前位置, 2文件末尾; 返回新位置, 失败时返回-1
+	Int64 Platform_SeekHandle(Memory handle, Int64 offset, Uint32 origin) noexcept {
+		Int64 pos{ };
+		return details::SetFilePointerEx(handle, offset, &pos, origin) ? pos : -1LL;
+	}
+
+	Int64 Platform_HandleSize(Memory handle) noexcept {
+		Int64 size{ };
+		return details::GetFileSizeEx(handle, &size) ? size : -1LL;
+	}
+
+	void Platform_CloseHandle(Memory handle) noexcept {
+		details::CloseHandle(handle);
+	}
+
+	// 只读映射整个文件, 映射视图在关闭文件与映射句柄后依然有效, 空文件不建立映射
+	bool Platform_MapFile(const StringView path, const Byte** data, Size* size) noexcept {
+		auto ret{ false };
+		if (auto hFile{ details::CreateFileW(path.data(), details::GENERIC_READ, details::FILE_SHARE_READ_WRITE,
+			nullptr, details::OPEN_EXISTING, details::FILE_ATTRIBUTE_NORMAL, nullptr) };
+			hFile != (Memory)details::INVALID_HANDLE_VALUE) {
+			Int64 fileSize{ };
+			if (details::GetFileSizeEx(hFile, &fileSize)) {
+				*data = nullptr;
+				*size = static_cast<Size>(fileSize);
+				if (!fileSize) ret = true;
+				else if (auto hFileMap{ details::CreateFileMappingFromApp(hFile, nullptr, details::PAGE_READONLY, 0, nullptr) }) {
+					if (auto view{ details::MapViewOfFileFromApp(hFileMap, details::FILE_MAP_READ, 0, 0) }) {
+						*data = static_cast<const Byte*>(view);
+						ret = true;
+					}
+					details::CloseHandle(hFileMap);
+				}
+			}
+			details::CloseHandle(hFile);
+		}
+		return ret;
+	}
+
+	void Platform_UnmapFile(const Byte* data) noexcept {
+		if (data) details::UnmapViewOfFile(data);
+	}
+
+	// 取文件大小与最后写入时间, 不打开文件
+	bool Platform_FileStamp(const StringView path, FileStamp* stamp) noexcept {
+		details::WIN32_FILE_ATTRIBUTE_DATA fad;
+		if (!details::GetFileAttributesExW(path.data(), details::GET_FILE_EX_INFO_STANDARD, &fad)) return false;
+		stamp->size = (static_cast<Uint64>(fad.nFileSizeHigh) << 32ULL) | fad.nFileSizeLow;
+		stamp->time = (static_cast<Uint64>(fad.ftLastWriteTime.dwHighDateTime) << 32ULL) | fad.ftLastWriteTime.dwLowDateTime;
+		return true;
 	}
 }
\ No newline at end of file
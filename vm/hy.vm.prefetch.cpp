@@ -0,0 +1,225 @@
+﻿#include "hy.vm.impl.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace hy {
+	// 预取项
+	struct PrefetchEntry {
+		util::Path modPath; // 模块路径
+		SharedByteCode* bc{ }; // 经模块缓存载入的字节码
+		bool started{ }; // 已被某线程领取
+		bool done{ }; // 已完成
+		bool ready{ }; // 读取, 反序列化且校验成功, 或已在模块缓存中
+		bool taken{ }; // 已被虚拟机取走
+
+		explicit PrefetchEntry(const util::Path& path) noexcept : modPath{ path } {}
+	};
+
+	struct ModulePrefetcher;
+
+	// 预取任务
+	struct PrefetchTask {
+		ModulePrefetcher* owner;
+		PrefetchEntry* entry;
+	};
+
+	// 预取线程池
+	// 进程内所有虚拟机的预取器共享同一组线程, 线程数为硬件线程数, 多个虚拟机同时运行时线程总数不随虚拟机数增长
+	// 第一个预取器创建时启动, 最后一个预取器销毁时结束, 所有虚拟机销毁后不残留线程
+	struct PrefetchPool {
+		std::mutex mtx; // 保护任务队列与各预取器的running
+		std::condition_variable cvTask, cvIdle;
+		std::deque<PrefetchTask> tasks;
+		bool stop{ };
+		std::mutex lifeMtx; // 保护线程的启动与结束
+		Vector<std::thread> workers;
+		Size users{ };
+
+		void attach() noexcept {
+			std::lock_guard lifeLock{ lifeMtx };
+			if (users++) return;
+			{
+				std::lock_guard lock{ mtx };
+				stop = false;
+			}
+			auto count{ static_cast<Size>(std::thread::hardware_concurrency()) };
+			if (!count) count = 1ULL;
+			workers.reserve(count);
+			for (Index i{ }; i < count; ++i) workers.emplace_back(&PrefetchPool::work, this);
+		}
+
+		// 移除预取器尚未开始的任务并等待其正在执行的任务完成, 最后一个使用者离开时结束线程
+		void release(ModulePrefetcher* owner) noexcept;
+
+		// 预取器持有自身的锁时调用, 锁的顺序为预取器在前, 线程池在后
+		void push(ModulePrefetcher* owner, PrefetchEntry* entry) noexcept {
+			{
+				std::lock_guard lock{ mtx };
+				tasks.emplace_back(PrefetchTask{ owner, entry });
+			}
+			cvTask.notify_one();
+		}
+
+		void work() noexcept;
+	};
+
+	inline PrefetchPool& GetPrefetchPool() noexcept {
+		static PrefetchPool pool;
+		return pool;
+	}
+
+	// 模块预取器
+	// 虚拟机运行模块前扫描其开头的导入指令, 由共享线程池并行完成导入图中各模块的读取, 反序列化与校验
+	// 模块的初始化仍由虚拟机在执行到导入指令时按原顺序完成
+	struct ModulePrefetcher {
+		VM* vm;
+		std::mutex mtx;
+		std::condition_variable cvDone;
+		LinkListEx<PrefetchEntry> entries;
+		HashMap<String, PrefetchEntry*> entryMap;
+		Size running{ }; // 线程池中正在执行的任务数, 由线程池的锁保护
+		bool stop{ };
+
+		explicit ModulePrefetcher(VM* v) noexcept : vm{ v } {
+			GetPrefetchPool().attach();
+		}
+
+		~ModulePrefetcher() noexcept {
+			{
+				std::lock_guard lock{ mtx };
+				stop = true; // 此后正在执行的任务不再登记新任务
+			}
+			GetPrefetchPool().release(this);
+			// 归还未被取走的字节码
+			for (auto& entry : entries) {
+				if (entry.bc) ModuleCache_Release(entry.bc);
+			}
+		}
+
+		ModulePrefetcher(const ModulePrefetcher&) = delete;
+		ModulePrefetcher& operator = (const ModulePrefetcher&) = delete;
+
+		// [需持有锁] 登记模块路径, 已登记的路径忽略
+		void enqueue(util::Path&& modPath) noexcept {
+			if (stop) return;
+			auto key{ modPath.toString() };
+			if (entryMap.contains(key)) return;
+			auto entry{ &entries.emplace_back(modPath) };
+			entryMap.try_emplace(freestanding::move(key), entry);
+			GetPrefetchPool().push(this, entry);
+		}
+
+		// [需持有锁] 登记字节码开头的所有导入指令
+		void enqueueImports(const ByteCode& bc) noexcept {
+			for (auto& ins : bc.mainCode.insView) {
+				if (ins.type < InsType::PRE_IMPORT) break; // 预处理指令均位于主代码开头
+				if (ins.type == InsType::PRE_IMPORT || ins.type == InsType::PRE_IMPORT_USING)
+					enqueue(GetModulePath(vm, bc.values.getRef(ins)));
+			}
+		}
+
+		// 经模块缓存载入, 成功后继续登记其导入的模块
+		void load(PrefetchEntry* entry) noexcept {
+			auto bc{ ModuleCache_Load(entry->modPath) };
+			auto ready{ bc != nullptr };
+			std::lock_guard lock{ mtx };
+			entry->bc = bc;
+			if (ready) enqueueImports(*bc);
+			entry->ready = ready;
+			entry->done = true;
+			cvDone.notify_all();
+		}
+
+		// 由线程池调用, 已被虚拟机线程领取的项跳过
+		void run(PrefetchEntry* entry) noexcept {
+			{
+				std::lock_guard lock{ mtx };
+				if (entry->started) return;
+				entry->started = true;
+			}
+			load(entry);
+		}
+
+		// 取出已预取的字节码, 尚未开始的由调用线程直接完成, 正在进行的则等待其完成
+		bool take(const util::Path& modPath, SharedByteCode** bc) noexcept {
+			std::unique_lock lock{ mtx };
+			auto iter{ entryMap.find(modPath.toString()) };
+			if (iter == entryMap.cend()) return false;
+			auto entry{ iter->second };
+			if (entry->taken) return false;
+			if (!entry->started) {
+				entry->started = true;
+				lock.unlock();
+				load(entry);
+				lock.lock();
+			}
+			else cvDone.wait(lock, [entry] { return entry->done; });
+			if (!entry->ready) return false; // 交由虚拟机重新读取以报告具体错误
+			entry->taken = true;
+			*bc = entry->bc;
+			entry->bc = nullptr;
+			return true;
+		}
+	};
+
+	void PrefetchPool::release(ModulePrefetcher* owner) noexcept {
+		{
+			std::unique_lock lock{ mtx };
+			std::erase_if(tasks, [owner](const PrefetchTask& task) { return task.owner == owner; });
+			cvIdle.wait(lock, [owner] { return !owner->running; });
+		}
+		std::lock_guard lifeLock{ lifeMtx };
+		if (--users) return;
+		{
+			std::lock_guard lock{ mtx };
+			stop = true;
+		}
+		cvTask.notify_all();
+		for (auto& worker : workers) worker.join();
+		workers.clear();
+	}
+
+	void PrefetchPool::work() noexcept {
+		for (;;) {
+			PrefetchTask task;
+			{
+				std::unique_lock lock{ mtx };
+				cvTask.wait(lock, [this] { return stop || !tasks.empty(); });
+				if (stop) return;
+				task = tasks.front();
+				tasks.pop_front();
+				++task.owner->running;
+			}
+			task.owner->run(task.entry);
+			{
+				std::lock_guard lock{ mtx };
+				--task.owner->running;
+			}
+			cvIdle.notify_all();
+		}
+	}
+
+	void Prefetch_Import(VM* vm, const ByteCode* bc) noexcept {
+		if (!vm->cfg.ParallelImport) return;
+		auto& ins{ bc->mainCode.insView };
+		if (ins.empty() || (ins[0ULL].type != InsType::PRE_IMPORT && ins[0ULL].type != InsType::PRE_IMPORT_USING))
+			return; // 无导入时不启动线程池
+		if (!vm->prefetcher) vm->prefetcher = new ModulePrefetcher(vm);
+		std::lock_guard lock{ vm->prefetcher->mtx };
+		vm->prefetcher->enqueueImports(*bc);
+	}
+
+	bool Prefetch_Take(VM* vm, const util::Path& modPath, SharedByteCode** bc) noexcept {
+		return vm->prefetcher && vm->prefetcher->take(modPath, bc);
+	}
+
+	void Prefetch_Stop(VM* vm) noexcept {
+		if (vm->prefetcher) {
+			delete vm->prefetcher;
+			vm->prefetcher = nullptr;
+		}
+	}
+}
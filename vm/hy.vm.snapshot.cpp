@@ -0,0 +1,750 @@
+﻿#include "hy.vm.impl.h"
+#include "../public/hy.strings.h"
+#include "../serializer/hy.serializer.reader.h"
+#include "../serializer/hy.serializer.compact.h"
+
+namespace hy {
+	/*
+		虚拟机快照
+		主模块的预处理段(及其导入的全部模块的初始化)运行完成后, 记录模块树与各模块全局域中的对象
+		之后的进程恢复快照即可跳过各模块的读取与初始化, 直接从主模块预处理段之后继续运行
+			| 标识(4B) | 版本(4B) | 主模块哈希值 | 主模块哈希长度 | 模块数 |
+			| 模块: 名称 | 路径 | 是否引用(1B) | 文件大小 | 文件写入时间 | 字节码长度 | 字节码(...) |
+			| 根: 主模块及各模块的全局变量表与软链接表 (名称 -> 对象编号) |
+			| 对象数 | 对象: 标记(1B) | 数据(...) |
+		整数均以变长编码, 对象间以编号互相引用, 快照中不含任何地址, 因而可重定位
+		类型与函数不复制, 仅记录其所在模块与名称, 恢复时由各模块重新运行预处理段得到
+		任一导入模块的文件大小或写入时间与快照不符时快照失效, 由调用者重新运行并生成
+		记录的模块状态:
+			global声明的全局变量与软链接, 及由其可达的全部对象(容器内容按生成快照时记录)
+			常量为字面量, 由预处理段重建; 未以global声明的顶层变量随模块主体结束而释放, 无需记录
+		不记录的模块状态, 生成快照时可检出的返回失败:
+			模块主体改写了函数或类的符号(检出)
+			全局域中存在无法记录的对象, 如原生库创建的对象(检出)
+			原生库内部的状态, 恢复时仅重新调用其初始化函数(未检出)
+			模块主体中的其他副作用, 如输出, 读写文件等(未检出)
+	*/
+	inline constexpr Byte SNAPSHOT_MAGIC[]{ 0x20U, 0x01U, 0x11U, 0x06U };
+
+	// 快照对象标记
+	enum class SnapshotTag : Byte {
+		NIL, INT, FLOAT, COMPLEX, BOOL, STRING, LIST, MAP, VECTOR,
+		MATRIX, RANGE, ARRAY, BIN, HASHSET, BUILTIN_TYPE, SYMBOL, OBJECT,
+	};
+
+	// 模块序号: 0为builtin模块, 1为主模块, 其后按模块编号排列
+	inline constexpr Index SNAPSHOT_MAIN_INDEX{ 1ULL };
+
+	inline void PutString(util::ByteArray& ba, const StringView sv) noexcept {
+		serialize::compact::PutVarint(ba, sv.size());
+		ba.append_bytes(sv.size() * sizeof(Char), sv.data());
+	}
+
+	inline bool GetString(serialize::compact::Cursor& cur, String& str) noexcept {
+		auto size{ cur.varint() };
+		if (size > static_cast<Size>(cur.end - cur.p) / sizeof(Char)) cur.ok = false;
+		auto data{ cur.bytes(size * sizeof(Char)) };
+		if (!cur.ok) return false;
+		str.resize(size);
+		freestanding::copy(str.data(), data, size * sizeof(Char));
+		return true;
+	}
+
+	// 读取元素数量, 每个元素至少占minBytes字节
+	inline Size GetCount(serialize::compact::Cursor& cur, Size minBytes) noexcept {
+		auto count{ cur.varint() };
+		if (count > static_cast<Size>(cur.end - cur.p) / minBytes) {
+			cur.ok = false;
+			return 0ULL;
+		}
+		return count;
+	}
+
+	// 遍历模块开头的预处理指令
+	template<typename Func>
+	inline void ForEachPrelude(const ByteCode& bc, Func&& func) noexcept {
+		for (auto& ins : bc.mainCode.insView) {
+			if (ins.type < InsType::PRE_IMPORT) break;
+			func(ins);
+		}
+	}
+
+	// 模块以global声明的全局变量名
+	inline HashSet<StringView> GetGlobalNames(const ByteCode& bc) noexcept {
+		HashSet<StringView> names;
+		ForEachPrelude(bc, [&bc, &names](const Ins& ins) {
+			if (ins.type == InsType::PRE_GLOBAL) {
+				for (auto strView : bc.values.getRef(ins)) names.emplace(strView.data(), strView.size());
+			}
+		});
+		return names;
+	}
+
+	inline String GetModuleRef(const StringView name) noexcept {
+		String ref{ name };
+		for (auto& ch : ref) {
+			if (ch == u'.') ch = u'\0';
+		}
+		return ref;
+	}
+
+	// 符号仍为预处理段创建的函数或类型, 其自身名称为符号名或以"::符号名"结尾
+	inline bool IsPreludeSymbol(const StringView name, Object* obj) noexcept {
+		StringView objName;
+		switch (obj->type->v_id) {
+		case TypeId::Function: objName = obj_cast<FunctionObject>(obj)->name; break;
+		case TypeId::Type: objName = obj_cast<TypeObject>(obj)->v_name; break;
+		default: return false;
+		}
+		if (objName == name) return true;
+		return objName.size() > name.size() + 2ULL && objName.ends_with(name) &&
+			objName.substr(objName.size() - name.size() - 2ULL, 2ULL) == u"::";
+	}
+
+	inline TypeObject** GetBuiltinTypes(VM* vm) noexcept {
+		return static_cast<TypeStaticData*>(vm->moduleTree.prototype->v_static)->builtinTypes;
+	}
+
+	inline bool IsBuiltinType(TypeObject** builtinTypes, TypeObject* type) noexcept {
+		auto token{ static_cast<Token>(type->v_id) };
+		return token < TypeIdBuiltinCount && builtinTypes[token] == type;
+	}
+
+	// 符号引用, 类成员函数以类名与函数名共同表示
+	struct SymbolRef {
+		Index mod; // 模块序号
+		StringView name; // 符号名
+		StringView member; // 成员函数名, 非成员函数时为空
+	};
+
+	// 快照写出
+	struct SnapshotWriter {
+		VM* vm;
+		TypeObject** builtinTypes;
+		Vector<Module*> modules;
+		HashMap<Object*, SymbolRef> symbols;
+		HashMap<Object*, Index> ids;
+		Vector<Object*> objects;
+		util::ByteArray table;
+
+		explicit SnapshotWriter(VM* v) noexcept : vm{ v }, builtinTypes{ GetBuiltinTypes(v) } {}
+
+		// 对象编号, 首次出现的对象追加到对象表末尾
+		Index id(Object* obj) noexcept {
+			auto [iter, added] { ids.try_emplace(obj, objects.size()) };
+			if (added) objects.emplace_back(obj);
+			return iter->second;
+		}
+
+		// 登记模块中可按名称找回的类型与函数, 全局变量的值可能被改写, 不作为引用
+		// 其他符号被模块主体改写时恢复后无法重现, 返回假
+		bool indexSymbols(Index modIndex) noexcept {
+			auto mod{ modules[modIndex] };
+			HashSet<StringView> globals;
+			if (modIndex) globals = GetGlobalNames(*mod->bc);
+			for (auto& [name, obj] : mod->dom.symbols) {
+				if (globals.contains(name)) continue;
+				if (modIndex && !IsPreludeSymbol(name, obj)) return false;
+				auto typeId{ obj->type->v_id };
+				if (typeId == TypeId::Function) symbols.try_emplace(obj, SymbolRef{ modIndex, name, { } });
+				else if (typeId == TypeId::Type) {
+					symbols.try_emplace(obj, SymbolRef{ modIndex, name, { } });
+					if (auto cls{ obj_cast<TypeObject>(obj)->v_cls }) {
+						for (auto& [funcName, fobj] : cls->funcs)
+							symbols.try_emplace(fobj, SymbolRef{ modIndex, name, funcName });
+					}
+				}
+			}
+			return true;
+		}
+
+		void putTag(SnapshotTag tag) noexcept {
+			table.append(static_cast<Byte>(tag));
+		}
+
+		bool putSymbol(Object* obj) noexcept {
+			auto iter{ symbols.find(obj) };
+			if (iter == symbols.cend()) return false;
+			auto& ref{ iter->second };
+			serialize::compact::PutVarint(table, ref.mod);
+			PutString(table, ref.name);
+			PutString(table, ref.member);
+			return true;
+		}
+
+		bool writeObject(Object* obj) noexcept {
+			using serialize::compact::PutVarint;
+			using serialize::compact::PutZigzag;
+			auto type{ obj->type };
+			if (!IsBuiltinType(builtinTypes, type)) { // 自定义类对象
+				if (!type->v_cls) return false;
+				putTag(SnapshotTag::OBJECT);
+				if (!putSymbol(type)) return false;
+				auto& membersData{ obj_cast<ObjectObject>(obj)->membersData };
+				PutVarint(table, membersData.size());
+				for (auto member : membersData) PutVarint(table, id(member));
+				return true;
+			}
+			switch (type->v_id) {
+			case TypeId::Type: {
+				auto tobj{ obj_cast<TypeObject>(obj) };
+				if (IsBuiltinType(builtinTypes, tobj)) {
+					putTag(SnapshotTag::BUILTIN_TYPE);
+					PutVarint(table, static_cast<Token>(tobj->v_id));
+					return true;
+				}
+				putTag(SnapshotTag::SYMBOL);
+				return putSymbol(obj);
+			}
+			case TypeId::Function: {
+				putTag(SnapshotTag::SYMBOL);
+				return putSymbol(obj);
+			}
+			case TypeId::Null: {
+				putTag(SnapshotTag::NIL);
+				return true;
+			}
+			case TypeId::Int: {
+				putTag(SnapshotTag::INT);
+				PutZigzag(table, obj_cast<IntObject>(obj)->value);
+				return true;
+			}
+			case TypeId::Float: {
+				putTag(SnapshotTag::FLOAT);
+				table.append(obj_cast<FloatObject>(obj)->value);
+				return true;
+			}
+			case TypeId::Complex: {
+				auto cobj{ obj_cast<ComplexObject>(obj) };
+				putTag(SnapshotTag::COMPLEX);
+				table.append(cobj->re, cobj->im);
+				return true;
+			}
+			case TypeId::Bool: {
+				putTag(SnapshotTag::BOOL);
+				table.append(static_cast<Byte>(obj_cast<BoolObject>(obj)->value));
+				return true;
+			}
+			case TypeId::String: {
+				putTag(SnapshotTag::STRING);
+				PutString(table, obj_cast<StringObject>(obj)->view());
+				return true;
+			}
+			case TypeId::List: {
+				auto objects{ obj_cast<ListObject>(obj)->view() };
+				putTag(SnapshotTag::LIST);
+				PutVarint(table, objects.size());
+				for (auto item : objects) PutVarint(table, id(item));
+				return true;
+			}
+			case TypeId::Map: {
+				auto mobj{ obj_cast<MapObject>(obj) };
+				putTag(SnapshotTag::MAP);
+				PutVarint(table, mobj->mSize);
+				for (Index i{ }; i < mobj->mCapacity; ++i) {
+					for (auto item{ mobj->mTable[i] }; item; item = item->next) {
+						PutVarint(table, id(item->key));
+						PutVarint(table, id(item->value));
+					}
+				}
+				return true;
+			}
+			case TypeId::Vector: {
+				auto& data{ obj_cast<VectorObject>(obj)->value() };
+				putTag(SnapshotTag::VECTOR);
+				PutVarint(table, data.size());
+				table.append_bytes(data.size() * sizeof(Float64), data.data());
+				return true;
+			}
+			case TypeId::Matrix: {
+				auto mobj{ obj_cast<MatrixObject>(obj) };
+				putTag(SnapshotTag::MATRIX);
+				PutVarint(table, mobj->row);
+				PutVarint(table, mobj->col);
+				table.append_bytes(static_cast<Size>(mobj->row) * mobj->col * sizeof(Float64), mobj->data.data());
+				return true;
+			}
+			case TypeId::Range: {
+				auto robj{ obj_cast<RangeObject>(obj) };
+				putTag(SnapshotTag::RANGE);
+				PutZigzag(table, robj->start);
+				PutZigzag(table, robj->step);
+				PutZigzag(table, robj->end);
+				return true;
+			}
+			case TypeId::Array: {
+				auto& data{ obj_cast<ArrayObject>(obj)->data };
+				putTag(SnapshotTag::ARRAY);
+				PutVarint(table, data.size());
+				for (auto v : data) PutZigzag(table, v);
+				return true;
+			}
+			case TypeId::Bin: {
+				auto data{ obj_cast<BinObject>(obj)->view() };
+				putTag(SnapshotTag::BIN);
+				PutVarint(table, data.size());
+				table.append_bytes(data.size(), data.data());
+				return true;
+			}
+			case TypeId::HashSet: {
+				auto hsobj{ obj_cast<HashSetObject>(obj) };
+				putTag(SnapshotTag::HASHSET);
+				PutVarint(table, hsobj->mSize);
+				for (Index i{ }; i < hsobj->mCapacity; ++i) {
+					for (auto item{ hsobj->mTable[i] }; item; item = item->next) PutVarint(table, id(item->key));
+				}
+				return true;
+			}
+			default: return false; // 左值, 迭代器与成员函数对象不会长期存在于全局域中, 不予记录
+			}
+		}
+	};
+
+	// 生成快照, 应在主模块预处理段运行完成后调用
+	// 全局域中存在无法记录的对象(如原生库创建的对象)时失败, 不影响虚拟机继续运行
+	bool SaveSnapshot(VM* vm, Module* mainMod, util::ByteArray* out) noexcept {
+		using serialize::compact::PutVarint;
+		// 非标准字节序平台在载入时就地转换了字节码, 无法原样写出
+		if constexpr (!freestanding::endian::is_standard_endian) return false;
+		SnapshotWriter writer{ vm };
+		auto& modules{ writer.modules };
+		modules.emplace_back(vm->moduleTree.builtin);
+		modules.emplace_back(mainMod);
+		for (auto& mod : vm->moduleTree.modTable.modData) {
+			if (&mod != mainMod) modules.emplace_back(&mod);
+		}
+		for (Index i{ }; i < modules.size(); ++i) {
+			if (!writer.indexSymbols(i)) return false;
+		}
+
+		auto& ba{ *out };
+		ba.clear();
+		ba.append_bytes(sizeof(SNAPSHOT_MAGIC), SNAPSHOT_MAGIC);
+		ba.append_bytes(4ULL, strings::VERSION_ID);
+		PutVarint(ba, mainMod->bc->pHeader->hash);
+		PutVarint(ba, mainMod->bc->pHeader->hashCount);
+		// 模块
+		PutVarint(ba, modules.size() - SNAPSHOT_MAIN_INDEX - 1ULL);
+		auto& usingList{ vm->moduleTree.modTable.usingList };
+		for (auto i{ SNAPSHOT_MAIN_INDEX + 1ULL }; i < modules.size(); ++i) {
+			auto mod{ modules[i] };
+			auto use{ false };
+			for (auto usingMod : usingList) {
+				if (usingMod == mod) {
+					use = true;
+					break;
+				}
+			}
+			auto path{ mod->modulePath.toString() };
+			FileStamp stamp;
+			if (!platform::Platform_FileStamp(path, &stamp)) return false;
+			PutString(ba, mod->name);
+			PutString(ba, path);
+			ba.append(static_cast<Byte>(use));
+			PutVarint(ba, stamp.size);
+			PutVarint(ba, stamp.time);
+			PutVarint(ba, mod->bc->source.size());
+			ba.append_bytes(mod->bc->source.size(), mod->bc->source.data());
+		}
+		// 根
+		for (auto i{ SNAPSHOT_MAIN_INDEX }; i < modules.size(); ++i) {
+			auto mod{ modules[i] };
+			auto globals{ GetGlobalNames(*mod->bc) };
+			PutVarint(ba, globals.size());
+			for (auto name : globals) {
+				auto obj{ mod->dom.symbols.getSymbol(name) };
+				if (!obj) return false;
+				PutString(ba, name);
+				PutVarint(ba, writer.id(obj));
+			}
+			PutVarint(ba, mod->dom.links.size());
+			for (auto& [name, obj] : mod->dom.links) {
+				PutString(ba, name);
+				PutVarint(ba, writer.id(obj));
+			}
+		}
+		// 对象, 写出过程中新遇到的对象追加在表尾
+		for (Index i{ }; i < writer.objects.size(); ++i) {
+			if (!writer.writeObject(writer.objects[i])) return false;
+		}
+		PutVarint(ba, writer.objects.size());
+		ba.append_bytes(writer.table.size(), writer.table.data());
+		return true;
+	}
+}
+
+namespace hy {
+	// 快照中的模块
+	struct SnapshotModule {
+		String name;
+		util::Path path;
+		bool use{ };
+		ByteCode bc;
+	};
+
+	// 快照中的根
+	struct SnapshotRoot {
+		String name;
+		Index id;
+	};
+
+	struct SnapshotRoots {
+		Vector<SnapshotRoot> globals;
+		Vector<SnapshotRoot> links;
+	};
+
+	// 快照恢复
+	struct SnapshotReader {
+		VM* vm;
+		TypeObject** builtinTypes;
+		Vector<Module*> modules;
+		Vector<Object*> objects;
+		Vector<SnapshotTag> tags;
+		Vector<const Byte*> starts;
+
+		explicit SnapshotReader(VM* v) noexcept : vm{ v }, builtinTypes{ GetBuiltinTypes(v) } {}
+
+		~SnapshotReader() noexcept {
+			for (auto obj : objects) { // 释放恢复期间持有的引用
+				if (obj) obj->unlink();
+			}
+		}
+
+		Object* getSymbol(serialize::compact::Cursor& cur) noexcept {
+			auto modIndex{ cur.varint() };
+			String name, member;
+			if (!GetString(cur, name) || !GetString(cur, member) || modIndex >= modules.size()) return nullptr;
+			auto obj{ modules[modIndex]->dom.symbols.getSymbol(name) };
+			if (!obj || member.empty()) return obj;
+			if (obj->type->v_id != TypeId::Type) return nullptr;
+			auto cls{ obj_cast<TypeObject>(obj)->v_cls };
+			if (!cls) return nullptr;
+			auto pFobj{ cls->funcs.get(member) };
+			return pFobj ? *pFobj : nullptr;
+		}
+
+		Object* getObject(serialize::compact::Cursor& cur) noexcept {
+			auto index{ cur.varint() };
+			if (!cur.ok || index >= objects.size()) return nullptr;
+			return objects[index];
+		}
+
+		void skipIds(serialize::compact::Cursor& cur, Size count) noexcept {
+			for (Index i{ }; i < count && cur.ok; ++i) cur.varint();
+		}
+
+		// 创建对象, 容器与自定义类对象的元素留待之后填充
+		Object* create(serialize::compact::Cursor& cur, SnapshotTag tag) noexcept {
+			switch (tag) {
+			case SnapshotTag::NIL: return obj_allocate(vm->getType(TypeId::Null));
+			case SnapshotTag::INT: {
+				auto v{ cur.zigzag() };
+				return cur.ok ? obj_allocate(vm->getType(TypeId::Int), arg_cast(v)) : nullptr;
+			}
+			case SnapshotTag::FLOAT: {
+				Float64 v;
+				auto data{ cur.bytes(sizeof(v)) };
+				if (!cur.ok) return nullptr;
+				freestanding::copy(&v, data, sizeof(v));
+				return obj_allocate(vm->getType(TypeId::Float), arg_cast(v));
+			}
+			case SnapshotTag::COMPLEX: {
+				Float64 v[2];
+				auto data{ cur.bytes(sizeof(v)) };
+				if (!cur.ok) return nullptr;
+				freestanding::copy(v, data, sizeof(v));
+				return obj_allocate(vm->getType(TypeId::Complex), arg_cast(v[0]), arg_cast(v[1]));
+			}
+			case SnapshotTag::BOOL: {
+				auto v{ cur.byte() };
+				return cur.ok ? obj_allocate(vm->getType(TypeId::Bool), arg_cast(static_cast<Int64>(v != 0U))) : nullptr;
+			}
+			case SnapshotTag::STRING: {
+				String str;
+				if (!GetString(cur, str)) return nullptr;
+				return obj_allocate(vm->getType(TypeId::String), str.data(), arg_cast(static_cast<Size>(str.size())));
+			}
+			case SnapshotTag::LIST: {
+				auto count{ GetCount(cur, 1ULL) };
+				skipIds(cur, count);
+				if (!cur.ok) return nullptr;
+				auto obj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
+				obj->objects.reserve(count);
+				return obj;
+			}
+			case SnapshotTag::MAP: {
+				skipIds(cur, GetCount(cur, 2ULL) << 1ULL);
+				return cur.ok ? obj_allocate(vm->getType(TypeId::Map)) : nullptr;
+			}
+			case SnapshotTag::HASHSET: {
+				skipIds(cur, GetCount(cur, 1ULL));
+				return cur.ok ? obj_allocate(vm->getType(TypeId::HashSet)) : nullptr;
+			}
+			case SnapshotTag::VECTOR: {
+				auto count{ GetCount(cur, sizeof(Float64)) };
+				auto data{ cur.bytes(count * sizeof(Float64)) };
+				if (!cur.ok) return nullptr;
+				auto obj{ obj_allocate<VectorObject>(vm->getType(TypeId::Vector), nullptr, arg_cast(count)) };
+				freestanding::copy(obj->data.data(), data, count * sizeof(Float64));
+				return obj;
+			}
+			case SnapshotTag::MATRIX: {
+				Size sizeData[]{ cur.varint(), cur.varint() };
+				auto count{ sizeData[0] * sizeData[1] };
+				if (sizeData[0] && count / sizeData[0] != sizeData[1]) cur.ok = false;
+				if (count > static_cast<Size>(cur.end - cur.p) / sizeof(Float64)) cur.ok = false;
+				auto data{ cur.bytes(count * sizeof(Float64)) };
+				if (!cur.ok) return nullptr;
+				auto obj{ obj_allocate<MatrixObject>(vm->getType(TypeId::Matrix), nullptr, sizeData) };
+				if (count) freestanding::copy(obj->data.data(), data, count * sizeof(Float64));
+				return obj;
+			}
+			case SnapshotTag::RANGE: {
+				Int64 data[]{ cur.zigzag(), cur.zigzag(), cur.zigzag() };
+				if (!cur.ok || !RangeObject::check(data[0], data[1], data[2])) return nullptr;
+				return obj_allocate(vm->getType(TypeId::Range), data);
+			}
+			case SnapshotTag::ARRAY: {
+				auto count{ GetCount(cur, 1ULL) };
+				if (!cur.ok) return nullptr;
+				auto obj{ obj_allocate<ArrayObject>(vm->getType(TypeId::Array), nullptr, arg_cast(count)) };
+				for (auto& v : obj->data) v = cur.zigzag();
+				if (cur.ok) return obj;
+				obj->type->f_deallocate(obj);
+				return nullptr;
+			}
+			case SnapshotTag::BIN: {
+				auto count{ GetCount(cur, 1ULL) };
+				auto data{ cur.bytes(count) };
+				if (!cur.ok) return nullptr;
+				return obj_allocate(vm->getType(TypeId::Bin), const_cast<Byte*>(data), arg_cast(count));
+			}
+			case SnapshotTag::BUILTIN_TYPE: {
+				auto token{ cur.varint() };
+				return cur.ok && token < TypeIdBuiltinCount ? builtinTypes[token] : nullptr;
+			}
+			case SnapshotTag::SYMBOL: return getSymbol(cur);
+			case SnapshotTag::OBJECT: {
+				auto obj{ getSymbol(cur) };
+				if (!obj || obj->type->v_id != TypeId::Type) return nullptr;
+				auto type{ obj_cast<TypeObject>(obj) };
+				auto count{ GetCount(cur, 1ULL) };
+				skipIds(cur, count);
+				if (!cur.ok || !type->v_cls || type->v_cls->members.size() != count) return nullptr;
+				return obj_allocate(type);
+			}
+			default: return nullptr;
+			}
+		}
+
+		// 填充列表与自定义类对象
+		bool fill(Index index) noexcept {
+			serialize::compact::Cursor cur{ starts[index], starts.back() };
+			auto obj{ objects[index] };
+			switch (tags[index]) {
+			case SnapshotTag::LIST: {
+				auto& items{ obj_cast<ListObject>(obj)->objects };
+				for (auto count{ cur.varint() }; count; --count) {
+					auto item{ getObject(cur) };
+					if (!item) return false;
+					item->link();
+					items.emplace_back(item);
+				}
+				return true;
+			}
+			case SnapshotTag::OBJECT: {
+				String name, member;
+				cur.varint();
+				GetString(cur, name);
+				GetString(cur, member);
+				auto& membersData{ obj_cast<ObjectObject>(obj)->membersData };
+				auto count{ cur.varint() };
+				for (Index i{ }; i < count; ++i) {
+					auto item{ getObject(cur) };
+					if (!item) return false;
+					item->link();
+					membersData[i]->unlink();
+					membersData[i] = item;
+				}
+				return true;
+			}
+			default: return true;
+			}
+		}
+
+		// 填充映射与集合, 需在其键完整后进行
+		bool fillHashed(Index index) noexcept {
+			serialize::compact::Cursor cur{ starts[index], starts.back() };
+			auto obj{ objects[index] };
+			switch (tags[index]) {
+			case SnapshotTag::MAP: {
+				for (auto count{ cur.varint() }; count; --count) {
+					auto key{ getObject(cur) };
+					auto value{ getObject(cur) };
+					if (!key || !value) return false;
+					if (!impl::Map_Set(vm, obj_cast<MapObject>(obj), key, value)) return false;
+				}
+				return true;
+			}
+			case SnapshotTag::HASHSET: {
+				for (auto count{ cur.varint() }; count; --count) {
+					auto key{ getObject(cur) };
+					if (!key) return false;
+					if (!impl::HashSet_Set(vm, obj_cast<HashSetObject>(obj), key)) return false;
+				}
+				return true;
+			}
+			default: return true;
+			}
+		}
+
+		bool readObjects(serialize::compact::Cursor& cur) noexcept {
+			auto count{ GetCount(cur, 1ULL) };
+			if (!cur.ok) return false;
+			objects.resize(count);
+			tags.resize(count);
+			starts.resize(count + 1ULL);
+			// 1. 按编号创建全部对象
+			for (Index i{ }; i < count; ++i) {
+				tags[i] = static_cast<SnapshotTag>(cur.byte());
+				starts[i] = cur.p;
+				auto obj{ create(cur, tags[i]) };
+				if (!obj) return false;
+				obj->link();
+				objects[i] = obj;
+			}
+			starts[count] = cur.p;
+			if (!cur.eof()) return false;
+			// 2. 填充列表与自定义类对象
+			for (Index i{ }; i < count; ++i) {
+				if (!fill(i)) return false;
+			}
+			// 3. 逆序填充映射与集合, 编号较大者先完成, 嵌套作为键的容器均已完整
+			for (auto i{ count }; i; --i) {
+				if (!fillHashed(i - 1ULL)) return false;
+			}
+			return true;
+		}
+	};
+
+	// 按导入顺序深度优先运行各模块的预处理段, 被导入模块先于导入者完成, 与初次运行的顺序一致
+	inline bool RunSnapshotPrelude(VM* vm, Vector<Module*>& modules, Vector<bool>& visited,
+		HashMap<Module*, Index>& indexMap, Index index) noexcept {
+		visited[index] = true;
+		auto mod{ modules[index] };
+		Vector<Index> deps;
+		ForEachPrelude(*mod->bc, [vm, mod, &deps, &indexMap](const Ins& ins) {
+			if (ins.type == InsType::PRE_IMPORT || ins.type == InsType::PRE_IMPORT_USING) {
+				if (auto dep{ vm->moduleTree.find(mod->bc->values.getRef(ins)) }) {
+					if (auto iter{ indexMap.find(dep) }; iter != indexMap.cend()) deps.emplace_back(iter->second);
+				}
+			}
+		});
+		for (auto dep : deps) {
+			if (!visited[dep] && !RunSnapshotPrelude(vm, modules, visited, indexMap, dep)) return false;
+		}
+		RunModulePrelude(vm, mod);
+		return vm->ok();
+	}
+
+	// 恢复快照, 成功后以RunModuleBody继续运行主模块
+	// 快照与主模块字节码不匹配或已损坏时返回假且不改动虚拟机, 恢复过程中出错时返回假并设置错误
+	bool LoadSnapshot(VM* vm, Module* mainMod, util::ByteArray* snapshot, util::ByteArray* ba) noexcept {
+		serialize::compact::Cursor cur{ snapshot->data(), snapshot->data() + snapshot->size() };
+		auto magic{ cur.bytes(sizeof(SNAPSHOT_MAGIC)) };
+		auto version{ cur.bytes(4ULL) };
+		if (!cur.ok || freestanding::compare(magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+			freestanding::compare(version, strings::VERSION_ID, 4ULL) != 0) return false;
+		// 主模块字节码须与生成快照时一致
+		ByteCode mainBC;
+		if (!serialize::ReadByteCode(*ba, mainBC) || CheckByteCode(&mainBC) != HYError::NO_ERROR) return false;
+		auto hash{ cur.varint() };
+		auto hashCount{ cur.varint() };
+		if (hash != mainBC.pHeader->hash || hashCount != mainBC.pHeader->hashCount) return false;
+		// 读取并校验各模块字节码
+		Vector<SnapshotModule> records(GetCount(cur, 4ULL));
+		for (auto& record : records) {
+			String path;
+			if (!GetString(cur, record.name) || !GetString(cur, path)) return false;
+			record.path = util::Path(path);
+			record.use = cur.byte() != 0U;
+			// 模块文件已更新
+			FileStamp stamp{ cur.varint(), cur.varint() }, current;
+			if (!cur.ok || !platform::Platform_FileStamp(path, &current) || !(current == stamp)) return false;
+			auto size{ cur.varint() };
+			auto image{ cur.bytes(size) };
+			if (!cur.ok || !serialize::ReadByteCode(util::ByteArray{ image, size }, record.bc) ||
+				CheckByteCode(&record.bc) != HYError::NO_ERROR) return false;
+			if (vm->moduleTree.find(RefView{ GetModuleRef(record.name) })) return false;
+		}
+		// 读取根
+		Vector<SnapshotRoots> roots(records.size() + 1ULL);
+		for (auto& root : roots) {
+			for (auto table : { &root.globals, &root.links }) {
+				table->resize(GetCount(cur, 2ULL));
+				for (auto& [name, id] : *table) {
+					GetString(cur, name);
+					id = cur.varint();
+				}
+			}
+			if (!cur.ok) return false;
+		}
+
+		// 建立模块树
+		SnapshotReader reader{ vm };
+		auto& modules{ reader.modules };
+		HashMap<Module*, Index> indexMap;
+		modules.emplace_back(vm->moduleTree.builtin);
+		modules.emplace_back(mainMod);
+		mainMod->bc = new SharedByteCode(freestanding::move(mainBC));
+		for (auto& record : records) {
+			auto ref{ GetModuleRef(record.name) };
+			auto mod{ vm->moduleTree.add(RefView{ ref }, record.name, record.path, record.use) };
+			if (!mod) {
+				SetError_RedefinedID(vm, record.name);
+				return false;
+			}
+			mod->bc = new SharedByteCode(freestanding::move(record.bc));
+			modules.emplace_back(mod);
+		}
+		for (Index i{ }; i < modules.size(); ++i) indexMap.try_emplace(modules[i], i);
+
+		// 运行各模块预处理段, 重建类型, 函数, 常量与软链接
+		Vector<bool> visited(modules.size());
+		for (auto i{ SNAPSHOT_MAIN_INDEX }; i < modules.size(); ++i) {
+			if (!visited[i] && !RunSnapshotPrelude(vm, modules, visited, indexMap, i)) return false;
+		}
+
+		// 恢复对象并写回全局域
+		if (!reader.readObjects(cur)) {
+			if (vm->ok()) SetError_ByteCodeBroken(vm);
+			return false;
+		}
+		auto& objects{ reader.objects };
+		for (Index i{ }; i < roots.size(); ++i) {
+			auto mod{ modules[SNAPSHOT_MAIN_INDEX + i] };
+			for (auto& [name, id] : roots[i].globals) {
+				auto pObj{ mod->dom.symbols.getSymbolLV(name) };
+				if (!pObj || id >= objects.size()) {
+					SetError_ByteCodeBroken(vm);
+					return false;
+				}
+				objects[id]->link();
+				(*pObj)->unlink();
+				*pObj = objects[id];
+			}
+			for (auto& [name, id] : roots[i].links) {
+				auto pObj{ mod->dom.links.get(name) };
+				if (!pObj || id >= objects.size()) {
+					SetError_ByteCodeBroken(vm);
+					return false;
+				}
+				// 软链接不持有引用, 恢复的对象可能仅由软链接可达
+				objects[id]->link();
+				mod->dom.holds.emplace_back(objects[id]);
+				*pObj = objects[id];
+			}
+		}
+		return true;
+	}
+}
@@ -2,6 +2,199 @@
 
 #include <fast_io/fast_io.h>
 
+#include <bit>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define HY_ARRAY_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace hy::impl::details {
+	/*
+	整数数组的批量运算
+	加减, 求和, 查找与计数: SSE2下每次处理2个元素, 并以多路累加掩盖指令延迟
+	乘除与最值: SSE2缺少对应的64位指令, 使用多路独立的标量循环, 交由编译器在更高指令集下向量化
+	除数为0时与整数运算一致: 除法得最大值, 取模得0
+	*/
+#ifdef HY_ARRAY_SSE2
+	inline __m128i SimdLoad(const Int64* p) noexcept {
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	}
+
+	inline void SimdStore(Int64* p, __m128i v) noexcept {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+	}
+
+	// 64位相等比较, 由高低两个32位的比较结果合并
+	inline __m128i SimdEqual(__m128i a, __m128i b) noexcept {
+		auto eq{ _mm_cmpeq_epi32(a, b) };
+		return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+
+	inline Uint64 SimdHorizontalSum(__m128i v) noexcept {
+		alignas(16) Uint64 lanes[2];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+		return lanes[0] + lanes[1];
+	}
+#endif
+
+	// 返回首个等于v的下标, 不存在时返回n
+	Index IntFind(const Int64* p, Size n, Int64 v) noexcept {
+		Index i{ };
+#ifdef HY_ARRAY_SSE2
+		auto vv{ _mm_set1_epi64x(v) };
+		for (; i + 8ULL <= n; i += 8ULL) {
+			auto e01{ _mm_or_si128(SimdEqual(SimdLoad(p + i), vv), SimdEqual(SimdLoad(p + i + 2ULL), vv)) };
+			auto e23{ _mm_or_si128(SimdEqual(SimdLoad(p + i + 4ULL), vv), SimdEqual(SimdLoad(p + i + 6ULL), vv)) };
+			if (_mm_movemask_epi8(_mm_or_si128(e01, e23))) break;
+		}
+#endif
+		for (; i < n; ++i) {
+			if (p[i] == v) return i;
+		}
+		return n;
+	}
+
+	Size IntCount(const Int64* p, Size n, Int64 v) noexcept {
+		Index i{ };
+		Size cnt{ };
+#ifdef HY_ARRAY_SSE2
+		auto vv{ _mm_set1_epi64x(v) };
+		auto acc0{ _mm_setzero_si128() }, acc1{ _mm_setzero_si128() };
+		for (; i + 4ULL <= n; i += 4ULL) { // 相等时比较结果为-1, 相减即计数
+			acc0 = _mm_sub_epi64(acc0, SimdEqual(SimdLoad(p + i), vv));
+			acc1 = _mm_sub_epi64(acc1, SimdEqual(SimdLoad(p + i + 2ULL), vv));
+		}
+		cnt = SimdHorizontalSum(_mm_add_epi64(acc0, acc1));
+#endif
+		for (; i < n; ++i) cnt += static_cast<Size>(p[i] == v);
+		return cnt;
+	}
+
+	// 溢出时按补码回绕
+	Int64 IntSum(const Int64* p, Size n) noexcept {
+		Index i{ };
+		Uint64 sum{ };
+#ifdef HY_ARRAY_SSE2
+		auto acc0{ _mm_setzero_si128() }, acc1{ _mm_setzero_si128() };
+		for (; i + 4ULL <= n; i += 4ULL) {
+			acc0 = _mm_add_epi64(acc0, SimdLoad(p + i));
+			acc1 = _mm_add_epi64(acc1, SimdLoad(p + i + 2ULL));
+		}
+		sum = SimdHorizontalSum(_mm_add_epi64(acc0, acc1));
+#endif
+		for (; i < n; ++i) sum += static_cast<Uint64>(p[i]);
+		return static_cast<Int64>(sum);
+	}
+
+	// 最值, 要求n大于0
+	template<bool isMax>
+	Int64 IntExtreme(const Int64* p, Size n) noexcept {
+		auto better{ [](Int64 a, Int64 b) noexcept { return isMax ? (a < b ? b : a) : (b < a ? b : a); } };
+		Int64 r[4]{ p[0], p[0], p[0], p[0] };
+		Index i{ };
+		for (; i + 4ULL <= n; i += 4ULL) {
+			r[0] = better(r[0], p[i]);
+			r[1] = better(r[1], p[i + 1ULL]);
+			r[2] = better(r[2], p[i + 2ULL]);
+			r[3] = better(r[3], p[i + 3ULL]);
+		}
+		for (; i < n; ++i) r[0] = better(r[0], p[i]);
+		return better(better(r[0], r[1]), better(r[2], r[3]));
+	}
+
+	// 最值所在的首个下标, 先求最值再查找, 两趟均可向量化
+	template<bool isMax>
+	Index IntArgExtreme(const Int64* p, Size n) noexcept {
+		return IntFind(p, n, IntExtreme<isMax>(p, n));
+	}
+
+	void IntPrefixSum(Int64* dst, const Int64* src, Size n) noexcept {
+		Uint64 sum{ };
+		for (Index i{ }; i < n; ++i) dst[i] = static_cast<Int64>(sum += static_cast<Uint64>(src[i]));
+	}
+
+	// 无分支压缩, dst至少容纳n个元素, 返回保留的元素数
+	Size IntFilter(Int64* dst, const Int64* src, const Int64* mask, Size n) noexcept {
+		Size k{ };
+		for (Index i{ }; i < n; ++i) {
+			dst[k] = src[i];
+			k += static_cast<Size>(mask[i] != 0LL);
+		}
+		return k;
+	}
+
+	// 逐元素运算, scalar为真时b指向单个标量, dst可与a相同
+	template<bool scalar>
+	void IntCalc(Int64* dst, const Int64* a, const Int64* b, Size n, BOPTType opt) noexcept {
+		auto at{ [b](Index i) noexcept {
+			if constexpr (scalar) return *b;
+			else return b[i];
+		} };
+		Index i{ };
+		switch (opt) {
+		case BOPTType::ADD:
+		case BOPTType::SUBTRACT: {
+			auto sub{ opt == BOPTType::SUBTRACT };
+#ifdef HY_ARRAY_SSE2
+			__m128i vs{ };
+			if constexpr (scalar) vs = _mm_set1_epi64x(*b);
+			for (; i + 2ULL <= n; i += 2ULL) {
+				auto va{ SimdLoad(a + i) };
+				__m128i vb;
+				if constexpr (scalar) vb = vs;
+				else vb = SimdLoad(b + i);
+				SimdStore(dst + i, sub ? _mm_sub_epi64(va, vb) : _mm_add_epi64(va, vb));
+			}
+#endif
+			if (sub) for (; i < n; ++i) dst[i] = static_cast<Int64>(static_cast<Uint64>(a[i]) - static_cast<Uint64>(at(i)));
+			else for (; i < n; ++i) dst[i] = static_cast<Int64>(static_cast<Uint64>(a[i]) + static_cast<Uint64>(at(i)));
+			break;
+		}
+		case BOPTType::MULTIPLE: {
+			for (; i < n; ++i) dst[i] = static_cast<Int64>(static_cast<Uint64>(a[i]) * static_cast<Uint64>(at(i)));
+			break;
+		}
+		case BOPTType::DIVIDE: {
+			if constexpr (scalar) {
+				if (auto v{ *b }; v == 0LL) for (; i < n; ++i) dst[i] = 9223372036854775807LL;
+				else for (; i < n; ++i) dst[i] = a[i] / v;
+			}
+			else for (; i < n; ++i) dst[i] = b[i] == 0LL ? 9223372036854775807LL : a[i] / b[i];
+			break;
+		}
+		case BOPTType::MOD: {
+			if constexpr (scalar) {
+				if (auto v{ *b }; v == 0LL) for (; i < n; ++i) dst[i] = 0LL;
+				else for (; i < n; ++i) dst[i] = a[i] % v;
+			}
+			else for (; i < n; ++i) dst[i] = b[i] == 0LL ? 0LL : a[i] % b[i];
+			break;
+		}
+		}
+	}
+
+	// 逐元素混合的FNV-1a变体, 4路独立以并行乘法, 末尾做一次雪崩混合, 与元素顺序相关
+	Size IntHash(const Int64* p, Size n) noexcept {
+		constexpr auto prime{ 1099511628211ULL };
+		Uint64 h[4]{ 14695981039346656037ULL, 14695981039346656037ULL ^ 1ULL,
+			14695981039346656037ULL ^ 2ULL, 14695981039346656037ULL ^ 3ULL };
+		Index i{ };
+		for (; i + 4ULL <= n; i += 4ULL) {
+			h[0] = (h[0] ^ static_cast<Uint64>(p[i])) * prime;
+			h[1] = (h[1] ^ static_cast<Uint64>(p[i + 1ULL])) * prime;
+			h[2] = (h[2] ^ static_cast<Uint64>(p[i + 2ULL])) * prime;
+			h[3] = (h[3] ^ static_cast<Uint64>(p[i + 3ULL])) * prime;
+		}
+		for (; i < n; ++i) h[0] = (h[0] ^ static_cast<Uint64>(p[i])) * prime;
+		auto hash{ static_cast<Uint64>(n) };
+		for (auto x : h) hash = (hash ^ x) * prime;
+		hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+		return static_cast<Size>(hash ^ (hash >> 31));
+	}
+}
+
 namespace hy::impl {
 	LIB_EXPORT void Array_Push(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
@@ -72,7 +265,7 @@ namespace hy::impl {
 		auto aobj{ obj_cast<ArrayObject>(thisObject) };
 		auto& data{ aobj->data };
 		auto iobj{ obj_cast<IntObject>(args[0]) };
-		auto v{ std::find(data.cbegin(), data.cend(), iobj->value) != data.cend() };
+		auto v{ details::IntFind(data.data(), data.size(), iobj->value) != data.size() };
 		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Bool), arg_cast(static_cast<Int64>(v))));
 	}
 
@@ -82,9 +275,9 @@ namespace hy::impl {
 		auto& data{ aobj->data };
 		auto iobj{ obj_cast<IntObject>(args[0]) };
 		auto ret{ obj_allocate<IntObject>(iobj->type) };
-		auto iter{ std::find(data.cbegin(), data.cend(), iobj->value) };
-		if (iter == data.cend()) ret->value = 0LL;
-		else ret->value = static_cast<Int64>(iter - data.cbegin()) + 1LL;
+		auto pos{ details::IntFind(data.data(), data.size(), iobj->value) };
+		if (pos == data.size()) ret->value = 0LL;
+		else ret->value = static_cast<Int64>(pos) + 1LL;
 		vm->objectStack.push_link(ret);
 	}
 
@@ -93,9 +286,89 @@ namespace hy::impl {
 		auto aobj{ obj_cast<ArrayObject>(thisObject) };
 		auto& data{ aobj->data };
 		auto iobj{ obj_cast<IntObject>(args[0]) };
-		auto cnt{ static_cast<Size>(std::count(data.cbegin(), data.cend(), iobj->value)) };
+		auto cnt{ details::IntCount(data.data(), data.size(), iobj->value) };
 		vm->objectStack.push_link(obj_allocate<IntObject>(iobj->type, arg_cast(cnt)));
 	}
+
+	LIB_EXPORT void Array_Sum(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<ArrayObject>(thisObject)->data };
+		auto sum{ details::IntSum(data.data(), data.size()) };
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(sum)));
+	}
+
+	template<bool isMax>
+	void Array_Extreme(HVM hvm, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto aobj{ obj_cast<ArrayObject>(thisObject) };
+		auto& data{ aobj->data };
+		if (data.empty()) SetError_EmptyContainer(vm, isMax ? u"array::max" : u"array::min", aobj->type);
+		else {
+			auto v{ details::IntExtreme<isMax>(data.data(), data.size()) };
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(v)));
+		}
+	}
+
+	template<bool isMax>
+	void Array_ArgExtreme(HVM hvm, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto aobj{ obj_cast<ArrayObject>(thisObject) };
+		auto& data{ aobj->data };
+		if (data.empty()) SetError_EmptyContainer(vm, isMax ? u"array::argmax" : u"array::argmin", aobj->type);
+		else {
+			auto pos{ static_cast<Int64>(details::IntArgExtreme<isMax>(data.data(), data.size())) + 1LL };
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(pos)));
+		}
+	}
+
+	LIB_EXPORT void Array_Min(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		Array_Extreme<false>(hvm, thisObject);
+	}
+
+	LIB_EXPORT void Array_Max(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		Array_Extreme<true>(hvm, thisObject);
+	}
+
+	LIB_EXPORT void Array_ArgMin(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		Array_ArgExtreme<false>(hvm, thisObject);
+	}
+
+	LIB_EXPORT void Array_ArgMax(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		Array_ArgExtreme<true>(hvm, thisObject);
+	}
+
+	LIB_EXPORT void Array_PrefixSum(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<ArrayObject>(thisObject)->data };
+		auto ret{ obj_allocate<ArrayObject>(thisObject->type, nullptr, arg_cast(data.size())) };
+		details::IntPrefixSum(ret->data.data(), data.data(), data.size());
+		vm->objectStack.push_link(ret);
+	}
+
+	LIB_EXPORT void Array_Filter(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<ArrayObject>(thisObject)->data };
+		auto& mask{ obj_cast<ArrayObject>(args[0])->data };
+		auto size{ data.size() };
+		if (size != mask.size()) SetError_UnmatchedLen(vm, size, mask.size());
+		else {
+			auto ret{ obj_allocate<ArrayObject>(thisObject->type, nullptr, arg_cast(size)) };
+			ret->data.resize(details::IntFilter(ret->data.data(), data.data(), mask.data(), size));
+			vm->objectStack.push_link(ret);
+		}
+	}
+
+	// 拼接, 返回新数组; 数组间的 + 为逐元素相加
+	LIB_EXPORT void Array_Concat(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data1{ obj_cast<ArrayObject>(thisObject)->data };
+		auto& data2{ obj_cast<ArrayObject>(args[0])->data };
+		auto size1{ data1.size() }, size2{ data2.size() };
+		auto ret{ obj_allocate<ArrayObject>(thisObject->type, nullptr, arg_cast(size1 + size2)) };
+		freestanding::copy_n(ret->data.data(), data1.data(), size1);
+		freestanding::copy_n(ret->data.data() + size1, data2.data(), size2);
+		vm->objectStack.push_link(ret);
+	}
 }
 
 namespace hy {
@@ -108,7 +381,8 @@ namespace hy {
 			auto intType{ type->__getType(TypeId::Int) };
 
 			Object* __any[] { intType, intType, nullptr };
-			ObjArgsView empty, it{ __any, 1ULL }, it2{ __any, 2ULL };
+			Object* __arr[] { type };
+			ObjArgsView empty, it{ __any, 1ULL }, it2{ __any, 2ULL }, at{ __arr, 1ULL };
 
 			ft.try_emplace(u"push", MakeNative<true, true>(funcType, u"array::push", &impl::Array_Push, it));
 			ft.try_emplace(u"insert", MakeNative<true, true>(funcType, u"array::insert", &impl::Array_Insert, it2));
@@ -120,6 +394,14 @@ namespace hy {
 			ft.try_emplace(u"contains", MakeNative<true, true>(funcType, u"array::contains", &impl::Array_Contains, it));
 			ft.try_emplace(u"find", MakeNative<true, true>(funcType, u"array::find", &impl::Array_Find, it));
 			ft.try_emplace(u"count", MakeNative<true, true>(funcType, u"array::count", &impl::Array_Count, it));
+			ft.try_emplace(u"sum", MakeNative<true, true>(funcType, u"array::sum", &impl::Array_Sum, empty));
+			ft.try_emplace(u"min", MakeNative<true, true>(funcType, u"array::min", &impl::Array_Min, empty));
+			ft.try_emplace(u"max", MakeNative<true, true>(funcType, u"array::max", &impl::Array_Max, empty));
+			ft.try_emplace(u"argmin", MakeNative<true, true>(funcType, u"array::argmin", &impl::Array_ArgMin, empty));
+			ft.try_emplace(u"argmax", MakeNative<true, true>(funcType, u"array::argmax", &impl::Array_ArgMax, empty));
+			ft.try_emplace(u"prefix_sum", MakeNative<true, true>(funcType, u"array::prefix_sum", &impl::Array_PrefixSum, empty));
+			ft.try_emplace(u"filter", MakeNative<true, true>(funcType, u"array::filter", &impl::Array_Filter, at));
+			ft.try_emplace(u"concat", MakeNative<true, true>(funcType, u"array::concat", &impl::Array_Concat, at));
 		}
 	};
 
@@ -177,11 +459,8 @@ namespace hy {
 	}
 
 	IResult<Size> f_hash_array(HVM, Object* obj) noexcept {
-		std::hash<Int64> hasher;
-		Size hash{ };
-		auto aobj{ obj_cast<ArrayObject>(obj) };
-		for (auto item : aobj->data) hash ^= hasher(item);
-		return IResult<Size>(hash);
+		auto& data{ obj_cast<ArrayObject>(obj)->data };
+		return IResult<Size>(impl::details::IntHash(data.data(), data.size()));
 	}
 
 	IResult<Size> f_len_array(HVM, Object* obj) noexcept {
@@ -254,7 +533,7 @@ namespace hy {
 		}
 		else if (argc == 1ULL) {
 			if (auto arg{ args[0] }; arg->type->v_id == TypeId::Vector) {
-				auto& vec{ obj_cast<VectorObject>(arg)->data };
+				auto& vec{ obj_cast<VectorObject>(arg)->value() };
 				auto size{ vec.size() };
 				auto aobj{ obj_allocate<ArrayObject>(type, nullptr, arg_cast(vec.size())) };
 				auto data{ aobj->data.data() };
@@ -274,14 +553,32 @@ namespace hy {
 	IResult<void> f_calcassign_array(HVM hvm, LVObject* lv, Object* obj2, AssignType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto aobj1{ lv->getAddressObject<ArrayObject>() };
-		if (opt == AssignType::ADD_ASSIGN && obj2->type->v_id == TypeId::Array) {
-			auto aobj2{ obj_cast<ArrayObject>(obj2) };
-			auto size1{ aobj1->data.size() }, size2{ aobj2->data.size() };
-			aobj1->data.resize(size1 + size2);
-			freestanding::copy_n(aobj1->data.data() + size1, aobj2->data.data(), size2);
+		auto& data1{ aobj1->data };
+		auto size1{ data1.size() };
+		BOPTType bopt;
+		switch (opt) {
+		case AssignType::ADD_ASSIGN: bopt = BOPTType::ADD; break;
+		case AssignType::SUBTRACT_ASSIGN: bopt = BOPTType::SUBTRACT; break;
+		case AssignType::MULTIPLE_ASSIGN: bopt = BOPTType::MULTIPLE; break;
+		case AssignType::DIVIDE_ASSIGN: bopt = BOPTType::DIVIDE; break;
+		case AssignType::MOD_ASSIGN: bopt = BOPTType::MOD; break;
+		default: return SetError(&SetError_IncompatibleCalcAssign, vm, aobj1->type, obj2->type, opt);
+		}
+		switch (obj2->type->v_id) {
+		case TypeId::Int: {
+			auto v{ obj_cast<IntObject>(obj2)->value };
+			impl::details::IntCalc<true>(data1.data(), data1.data(), &v, size1, bopt);
+			return IResult<void>(true);
+		}
+		case TypeId::Array: {
+			auto& data2{ obj_cast<ArrayObject>(obj2)->data };
+			auto size2{ data2.size() };
+			if (size1 != size2) return SetError(&SetError_UnmatchedLen, vm, size1, size2);
+			impl::details::IntCalc<false>(data1.data(), data1.data(), data2.data(), size1, bopt);
 			return IResult<void>(true);
 		}
-		else return SetError(&SetError_IncompatibleCalcAssign, vm, aobj1->type, obj2->type, opt);
+		}
+		return SetError(&SetError_IncompatibleCalcAssign, vm, aobj1->type, obj2->type, opt);
 	}
 
 	IResult<void> f_assign_lv_data_array(HVM hvm, LVObject* lv, Object* obj) noexcept {
@@ -310,19 +607,45 @@ namespace hy {
 		return SetError(&SetError_IncompatibleCalcAssign, vm, vm->getType(TypeId::Int), obj->type, opt);
 	}
 
+	IResult<void> f_sopt_calc_array(HVM hvm, Object* obj, SOPTType) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto aobj{ obj_cast<ArrayObject>(obj) };
+		auto ret{ obj_allocate<ArrayObject>(obj->type, arg_cast(aobj->data.data()), arg_cast(aobj->data.size())) };
+		for (auto& elem : ret->data) elem = static_cast<Int64>(0ULL - static_cast<Uint64>(elem));
+		vm->objectStack.push_link(ret);
+		return IResult<void>(true);
+	}
+
 	IResult<void> f_bopt_calc_array(HVM hvm, Object* obj1, Object* obj2, BOPTType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
-		if (opt == BOPTType::ADD && obj2->type->v_id == TypeId::Array) {
-			auto aobj{ obj_allocate<ArrayObject>(obj1->type) };
-			auto& data1{ obj_cast<ArrayObject>(obj1)->data };
+		auto& data1{ obj_cast<ArrayObject>(obj1)->data };
+		auto size1{ data1.size() };
+		switch (opt) {
+		case BOPTType::ADD:
+		case BOPTType::SUBTRACT:
+		case BOPTType::MULTIPLE:
+		case BOPTType::DIVIDE:
+		case BOPTType::MOD: break;
+		default: return SetError(&SetError_UnsupportedBOPT, vm, obj1->type, obj2->type, opt);
+		}
+		switch (obj2->type->v_id) {
+		case TypeId::Int: {
+			auto v{ obj_cast<IntObject>(obj2)->value };
+			auto aobj{ obj_allocate<ArrayObject>(obj1->type, nullptr, arg_cast(size1)) };
+			impl::details::IntCalc<true>(aobj->data.data(), data1.data(), &v, size1, opt);
+			vm->objectStack.push_link(aobj);
+			return IResult<void>(true);
+		}
+		case TypeId::Array: {
 			auto& data2{ obj_cast<ArrayObject>(obj2)->data };
-			auto& data{ aobj->data };
-			aobj->data.resize(data1.size() + data2.size());
-			freestanding::copy_n(data.data(), data1.data(), data1.size());
-			freestanding::copy_n(data.data() + data1.size(), data2.data(), data2.size());
+			auto size2{ data2.size() };
+			if (size1 != size2) return SetError(&SetError_UnmatchedLen, vm, size1, size2);
+			auto aobj{ obj_allocate<ArrayObject>(obj1->type, nullptr, arg_cast(size1)) };
+			impl::details::IntCalc<false>(aobj->data.data(), data1.data(), data2.data(), size1, opt);
 			vm->objectStack.push_link(aobj);
 			return IResult<void>(true);
 		}
+		}
 		return SetError(&SetError_UnsupportedBOPT, vm, obj1->type, obj2->type, opt);
 	}
 
@@ -412,7 +735,7 @@ namespace hy {
 		type->f_calcassign_lv_data = &f_calcassign_lv_data_array;
 		type->f_free_lv_data = nullptr;
 
-		type->f_sopt_calc = nullptr;
+		type->f_sopt_calc = &f_sopt_calc_array;
 		type->f_bopt_calc = &f_bopt_calc_array;
 		type->f_equal = &f_equal_array;
 		type->f_compare = nullptr;
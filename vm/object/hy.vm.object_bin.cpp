@@ -2,19 +2,168 @@
 
 #include <fast_io/fast_io.h>
 
+#include <bit>
+
+namespace hy {
+	void BinObject::release() noexcept {
+		if (mapped && !--mapped->refs) {
+			platform::Platform_UnmapFile(mapped->data);
+			delete mapped;
+		}
+		mapped = nullptr;
+	}
+}
+
+namespace hy::impl::details {
+	// 格式项, count为重复次数, 对s为字节集长度
+	struct BinField {
+		Char code;
+		Size count;
+	};
+
+	// 各格式字符占用的字节数, 非法字符返回0
+	constexpr Size BinFieldWidth(Char code) noexcept {
+		switch (code) {
+		case u'b': case u'B': case u'?': case u'x': case u's': return 1ULL;
+		case u'h': case u'H': return 2ULL;
+		case u'i': case u'I': case u'f': return 4ULL;
+		case u'q': case u'Q': case u'd': return 8ULL;
+		default: return 0ULL;
+		}
+	}
+
+	// 解析字节序前缀, '<'小端, '>'与'!'大端, '='本机字节序
+	constexpr bool BinEndian(Char c, bool& big) noexcept {
+		switch (c) {
+		case u'<': big = false; return true;
+		case u'>': case u'!': big = true; return true;
+		case u'=': big = freestanding::endian::is_big_endian; return true;
+		default: return false;
+		}
+	}
+
+	// 解析格式串, 格式为[字节序前缀]{[重复次数]格式字符}, 默认小端
+	// 格式字符: b/B, h/H, i/I, q/Q 为1, 2, 4, 8字节整数(小写有符号), f/d 为单/双精度浮点
+	// ? 为布尔, x 为填充字节(不产生值), s 为字节集(重复次数即其长度)
+	// bytes返回总字节数(超过2^48视为非法, 以免累加溢出), values返回值的个数
+	bool BinFormat(StringView fmt, bool& big, Vector<BinField>& fields, Size& bytes, Size& values) noexcept {
+		big = false;
+		bytes = values = 0ULL;
+		if (!fmt.empty() && BinEndian(fmt.front(), big)) fmt.remove_prefix(1ULL);
+		for (Index i{ }; i < fmt.size(); ++i) {
+			auto count{ 1ULL };
+			if (fmt[i] >= u'0' && fmt[i] <= u'9') {
+				count = 0ULL;
+				for (; i < fmt.size() && fmt[i] >= u'0' && fmt[i] <= u'9'; ++i) {
+					if (count > 0xFFFFFFFFULL) return false;
+					count = count * 10ULL + static_cast<Size>(fmt[i] - u'0');
+				}
+				if (i == fmt.size()) return false;
+			}
+			auto code{ fmt[i] };
+			auto width{ BinFieldWidth(code) };
+			if (!width) return false;
+			fields.emplace_back(BinField{ code, count });
+			bytes += width * count;
+			if (bytes > 0xFFFFFFFFFFFFULL) return false;
+			if (code == u's') ++values;
+			else if (code != u'x') values += count;
+		}
+		return true;
+	}
+
+	template<typename U>
+	inline U BinLoad(const Byte* p, bool big) noexcept {
+		U u;
+		freestanding::copy(&u, p, sizeof(U));
+		return big ? freestanding::endian::big_endian(u) : freestanding::endian::little_endian(u);
+	}
+
+	template<typename U>
+	inline void BinStore(Byte* p, U u, bool big) noexcept {
+		u = big ? freestanding::endian::big_endian(u) : freestanding::endian::little_endian(u);
+		freestanding::copy(p, &u, sizeof(U));
+	}
+
+	// 读取一个数值格式项并返回新对象
+	Object* BinUnpackOne(VM* vm, Char code, const Byte* p, bool big) noexcept {
+		Int64 i;
+		switch (code) {
+		case u'b': i = static_cast<Int8>(*p); break;
+		case u'B': i = *p; break;
+		case u'h': i = static_cast<Int16>(BinLoad<Uint16>(p, big)); break;
+		case u'H': i = BinLoad<Uint16>(p, big); break;
+		case u'i': i = static_cast<Int32>(BinLoad<Uint32>(p, big)); break;
+		case u'I': i = BinLoad<Uint32>(p, big); break;
+		case u'q': case u'Q': i = static_cast<Int64>(BinLoad<Uint64>(p, big)); break;
+		case u'?': return obj_allocate(vm->getType(TypeId::Bool), arg_cast(*p ? 1LL : 0LL));
+		case u'f': return obj_allocate(vm->getType(TypeId::Float),
+			arg_cast(static_cast<Float64>(std::bit_cast<Float32>(BinLoad<Uint32>(p, big)))));
+		default: return obj_allocate(vm->getType(TypeId::Float), arg_cast(std::bit_cast<Float64>(BinLoad<Uint64>(p, big))));
+		}
+		return obj_allocate(vm->getType(TypeId::Int), arg_cast(i));
+	}
+
+	// 写入一个数值格式项, 整数按宽度截断, 类型不符时返回false
+	bool BinPackOne(Char code, Object* obj, Byte* p, bool big) noexcept {
+		auto id{ obj->type->v_id };
+		if (code == u'f' || code == u'd') {
+			Float64 f;
+			if (id == TypeId::Float) f = obj_cast<FloatObject>(obj)->value;
+			else if (id == TypeId::Int) f = static_cast<Float64>(obj_cast<IntObject>(obj)->value);
+			else return false;
+			if (code == u'f') BinStore(p, std::bit_cast<Uint32>(static_cast<Float32>(f)), big);
+			else BinStore(p, std::bit_cast<Uint64>(f), big);
+			return true;
+		}
+		Uint64 u;
+		if (id == TypeId::Int) u = static_cast<Uint64>(obj_cast<IntObject>(obj)->value);
+		else if (id == TypeId::Bool) u = obj_cast<BoolObject>(obj)->value ? 1ULL : 0ULL;
+		else return false;
+		switch (BinFieldWidth(code)) {
+		case 1ULL: *p = static_cast<Byte>(code == u'?' ? u != 0ULL : u); break;
+		case 2ULL: BinStore(p, static_cast<Uint16>(u), big); break;
+		case 4ULL: BinStore(p, static_cast<Uint32>(u), big); break;
+		default: BinStore(p, u, big); break;
+		}
+		return true;
+	}
+
+	// 批量解码定宽整数, 字节序与符号在循环外确定以便编译器向量化
+	template<typename U, bool Big, bool Signed>
+	void BinDecode(const Byte* src, Size count, Int64* dst) noexcept {
+		for (Index i{ }; i < count; ++i) {
+			U u;
+			freestanding::copy(&u, src + i * sizeof(U), sizeof(U));
+			if constexpr (Big) u = freestanding::endian::big_endian(u);
+			else u = freestanding::endian::little_endian(u);
+			if constexpr (Signed) dst[i] = static_cast<Int64>(static_cast<std::make_signed_t<U>>(u));
+			else dst[i] = static_cast<Int64>(u);
+		}
+	}
+
+	template<typename U>
+	void BinDecode(const Byte* src, Size count, Int64* dst, bool big, bool sign) noexcept {
+		if (big) sign ? BinDecode<U, true, true>(src, count, dst) : BinDecode<U, true, false>(src, count, dst);
+		else sign ? BinDecode<U, false, true>(src, count, dst) : BinDecode<U, false, false>(src, count, dst);
+	}
+}
+
 namespace hy::impl {
 	void Bin_ShowBytes(BinObject* bobj, String* str) noexcept {
 		fast_io::u16ostring_ref strRef{ str };
+		auto bytes{ bobj->view() };
 		str->push_back(u'{');
-		for (auto i : bobj->data)
+		for (auto i : bytes)
 			print(strRef, fast_io::mnp::hexupper(i), fast_io::mnp::chvw(u','));
-		if (bobj->data.empty()) str->push_back(u'}');
+		if (bytes.empty()) str->push_back(u'}');
 		else str->back() = u'}';
 	}
 
 	LIB_EXPORT void Bin_Clear(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto bobj{ obj_cast<BinObject>(thisObject) };
+		bobj->release();
 		bobj->data.clear();
 		vm->objectStack.push_link(bobj);
 	}
@@ -22,9 +171,158 @@ namespace hy::impl {
 	LIB_EXPORT void Bin_Reverse(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto bobj{ obj_cast<BinObject>(thisObject) };
-		std::reverse(bobj->data.begin(), bobj->data.end());
+		auto& data{ bobj->bin() };
+		std::reverse(data.begin(), data.end());
 		vm->objectStack.push_link(bobj);
 	}
+
+	// unpack(format, offset = 1), 自offset处按格式读取并返回值列表, s项返回字节集
+	LIB_EXPORT void Bin_Unpack(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto bobj{ obj_cast<BinObject>(thisObject) };
+		auto argc{ args.size() };
+		bool big;
+		Vector<details::BinField> fields;
+		Size bytes, values;
+		if ((argc == 1ULL || argc == 2ULL) && args[0]->type->v_id == TypeId::String &&
+			(argc == 1ULL || args[1]->type->v_id == TypeId::Int) &&
+			details::BinFormat(obj_cast<StringObject>(args[0])->view(), big, fields, bytes, values)) {
+			auto data{ bobj->view() };
+			auto length{ static_cast<Int64>(data.size()) };
+			auto offset{ argc == 2ULL ? obj_cast<IntObject>(args[1])->value : 1LL };
+			if (offset < 1LL || offset > length + 1LL)
+				return SetError_IndexOutOfRange(vm, offset, length);
+			auto pos{ static_cast<Index>(offset - 1LL) };
+			if (bytes > data.size() - pos)
+				return SetError_IndexOutOfRange(vm, static_cast<Int64>(pos + bytes), length);
+			auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
+			lobj->objects.reserve(values);
+			auto p{ data.data() + pos };
+			for (auto& [code, count] : fields) {
+				if (code == u'x') p += count;
+				else if (code == u's') {
+					auto sub{ obj_allocate<BinObject>(bobj->type) };
+					if (bobj->mapped) sub->share(bobj, static_cast<Index>(p - data.data()), count);
+					else sub->data.assign(p, count);
+					sub->link();
+					lobj->objects.emplace_back(sub);
+					p += count;
+				}
+				else {
+					auto width{ details::BinFieldWidth(code) };
+					for (Index i{ }; i < count; ++i, p += width) {
+						auto obj{ details::BinUnpackOne(vm, code, p, big) };
+						obj->link();
+						lobj->objects.emplace_back(obj);
+					}
+				}
+			}
+			vm->objectStack.push_link(lobj);
+		}
+		else SetError_UnmatchedCall(vm, u"bin::unpack", args);
+	}
+
+	// pack(format, ...), 按格式将参数编码后追加到自身末尾, 返回自身
+	// s项接受字节集, 不足长度时补0, 超出时截断; x与s的重复次数由脚本给出, 单次追加不超过2GB
+	LIB_EXPORT void Bin_Pack(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto bobj{ obj_cast<BinObject>(thisObject) };
+		bool big;
+		Vector<details::BinField> fields;
+		Size bytes, values;
+		if (!args.empty() && args[0]->type->v_id == TypeId::String &&
+			details::BinFormat(obj_cast<StringObject>(args[0])->view(), big, fields, bytes, values) &&
+			args.size() == values + 1ULL) {
+			constexpr auto MAX_PACK_SIZE{ 0x7FFFFFFFULL };
+			if (bytes > MAX_PACK_SIZE) return SetError_IndexOutOfRange(vm, static_cast<Int64>(bytes), MAX_PACK_SIZE);
+			auto& data{ bobj->bin() };
+			auto oldSize{ data.size() };
+			data.resize(oldSize + bytes);
+			auto p{ data.data() + oldSize };
+			auto arg{ args.data() + 1ULL };
+			auto ok{ true };
+			for (auto& [code, count] : fields) {
+				if (code == u'x') {
+					freestanding::initialize(p, 0, count);
+					p += count;
+				}
+				else if (code == u's') {
+					if ((*arg)->type->v_id != TypeId::Bin) {
+						ok = false;
+						break;
+					}
+					// 参数为自身时取追加前的内容, 其位于写入区域之前, 二者不重叠
+					auto sobj{ obj_cast<BinObject>(*arg++) };
+					auto src{ sobj == bobj ? BinObject::View{ data.data(), oldSize } : sobj->view() };
+					auto n{ src.size() < count ? src.size() : count };
+					freestanding::copy(p, src.data(), n);
+					freestanding::initialize(p + n, 0, count - n);
+					p += count;
+				}
+				else {
+					auto width{ details::BinFieldWidth(code) };
+					for (Index i{ }; ok && i < count; ++i, p += width)
+						ok = details::BinPackOne(code, *arg++, p, big);
+					if (!ok) break;
+				}
+			}
+			if (ok) vm->objectStack.push_link(bobj);
+			else {
+				data.resize(oldSize);
+				SetError_UnmatchedCall(vm, u"bin::pack", args);
+			}
+		}
+		else SetError_UnmatchedCall(vm, u"bin::pack", args);
+	}
+
+	// to_array(width, endian = "<", signed = false), 将全部字节按定宽整数批量解码为整数数组
+	// width为1, 2, 4, 8, 字节数须为width的整数倍
+	LIB_EXPORT void Bin_ToArray(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto argc{ args.size() };
+		auto big{ false };
+		if (argc >= 1ULL && argc <= 3ULL && args[0]->type->v_id == TypeId::Int &&
+			(argc < 2ULL || args[1]->type->v_id == TypeId::String) &&
+			(argc < 3ULL || args[2]->type->v_id == TypeId::Bool)) {
+			auto width{ obj_cast<IntObject>(args[0])->value };
+			auto data{ obj_cast<BinObject>(thisObject)->view() };
+			auto sign{ argc == 3ULL && obj_cast<BoolObject>(args[2])->value };
+			if (argc >= 2ULL) {
+				auto endian{ obj_cast<StringObject>(args[1])->view() };
+				if (endian.size() != 1ULL || !details::BinEndian(endian.front(), big))
+					return SetError_UnmatchedCall(vm, u"bin::to_array", args);
+			}
+			if ((width == 1LL || width == 2LL || width == 4LL || width == 8LL) &&
+				data.size() % static_cast<Size>(width) == 0ULL) {
+				auto count{ data.size() / static_cast<Size>(width) };
+				auto aobj{ obj_allocate<ArrayObject>(vm->getType(TypeId::Array), nullptr, arg_cast(count)) };
+				auto src{ data.data() };
+				auto dst{ aobj->data.data() };
+				switch (width) {
+				case 1LL: details::BinDecode<Uint8>(src, count, dst, big, sign); break;
+				case 2LL: details::BinDecode<Uint16>(src, count, dst, big, sign); break;
+				case 4LL: details::BinDecode<Uint32>(src, count, dst, big, sign); break;
+				default: details::BinDecode<Uint64>(src, count, dst, big, sign); break;
+				}
+				vm->objectStack.push_link(aobj);
+				return;
+			}
+		}
+		SetError_UnmatchedCall(vm, u"bin::to_array", args);
+	}
+
+	// 只读映射文件为字节集, 文件内容不复制到内存
+	BinObject* Bin_Map(VM* vm, const StringView path) noexcept {
+		const Byte* data;
+		Size size;
+		if (!platform::Platform_MapFile(path, &data, &size)) return nullptr;
+		auto bobj{ obj_allocate<BinObject>(vm->getType(TypeId::Bin)) };
+		if (data) {
+			bobj->mapped = new MappedBin{ 1ULL, data, size };
+			bobj->length = size;
+		}
+		return bobj;
+	}
 }
 
 namespace hy {
@@ -39,6 +337,9 @@ namespace hy {
 
 			ft.try_emplace(u"clear", MakeNative<true, true>(funcType, u"bin::clear", &impl::Bin_Clear, empty));
 			ft.try_emplace(u"reverse", MakeNative<true, true>(funcType, u"bin::reverse", &impl::Bin_Reverse, empty));
+			ft.try_emplace(u"unpack", MakeNative<false, true>(funcType, u"bin::unpack", &impl::Bin_Unpack, empty));
+			ft.try_emplace(u"pack", MakeNative<false, true>(funcType, u"bin::pack", &impl::Bin_Pack, empty));
+			ft.try_emplace(u"to_array", MakeNative<false, true>(funcType, u"bin::to_array", &impl::Bin_ToArray, empty));
 		}
 	};
 
@@ -69,24 +370,27 @@ namespace hy {
 			obj = pool.back();
 			pool.pop_back();
 		}
+		obj->offset = obj->length = 0ULL;
 		obj->data.assign(arg_recast<Byte*>(arg1), arg_recast<Size>(arg2));
 		return obj;
 	}
 
 	void f_deallocate_bin(Object* obj) noexcept {
 		auto& pool{ static_cast<BinStaticData*>(obj->type->v_static)->pool };
-		pool.emplace_back(obj_cast<BinObject>(obj));
+		auto bobj{ obj_cast<BinObject>(obj) };
+		bobj->release(); // 尽早解除文件映射
+		pool.emplace_back(bobj);
 	}
 
 	bool f_bool_bin(Object* obj) noexcept {
-		return !obj_cast<BinObject>(obj)->data.empty();
+		return obj_cast<BinObject>(obj)->size() != 0ULL;
 	}
 
 	IResult<void> f_string_bin(HVM, Object* obj, String* str) noexcept {
 		constexpr auto MAX_BIN_SIZE{ 1024ULL };
 
 		auto bobj{ obj_cast<BinObject>(obj) };
-		if (auto size{ bobj->data.size() }; size > MAX_BIN_SIZE) {
+		if (auto size{ bobj->size() }; size > MAX_BIN_SIZE) {
 			fast_io::u16ostring_ref strRef{ str };
 			print(strRef, u"bin[ ", size, u" ]");
 		}
@@ -95,12 +399,12 @@ namespace hy {
 	}
 
 	IResult<Size> f_hash_bin(HVM, Object* obj) noexcept {
-		auto& data{ obj_cast<BinObject>(obj)->data };
+		auto data{ obj_cast<BinObject>(obj)->view() };
 		return IResult<Size>(freestanding::cvt::hash_bytes<Size>(data.data(), data.data() + data.size()));
 	}
 
 	IResult<Size> f_len_bin(HVM, Object* obj) noexcept {
-		return IResult<Size>(obj_cast<BinObject>(obj)->data.size());
+		return IResult<Size>(obj_cast<BinObject>(obj)->size());
 	}
 
 	IResult<void> f_member_bin(HVM hvm, bool isLV, Object* obj, const StringView member) noexcept {
@@ -116,14 +420,16 @@ namespace hy {
 			}
 			else if (member == u"utf8") {
 				auto sobj{ obj_allocate<StringObject>(strType) };
-				platform::Platform_UTF8ToString(&bobj->data, &sobj->value);
+				auto bytes{ bobj->view() };
+				platform::Platform_UTF8BytesToString(bytes.data(), bytes.size(), &sobj->value);
 				vm->objectStack.push_link(sobj);
 				return IResult<void>(true);
 
 			}
 			else if (member == u"gb2312") {
 				auto sobj{ obj_allocate<StringObject>(strType) };
-				platform::Platform_GB2312ToString(&bobj->data, &sobj->value);
+				auto bytes{ bobj->view() };
+				platform::Platform_GB2312BytesToString(bytes.data(), bytes.size(), &sobj->value);
 				vm->objectStack.push_link(sobj);
 				return IResult<void>(true);
 			}
@@ -146,7 +452,7 @@ namespace hy {
 		auto bobj{ obj_cast<BinObject>(obj) };
 		if (auto argc{ args.size() }; argc == 1ULL) {
 			if (auto arg{ args[0] }; arg->type->v_id == TypeId::Int) {
-				auto length{ static_cast<Int64>(bobj->data.size()) };
+				auto length{ static_cast<Int64>(bobj->size()) };
 				auto index{ obj_cast<IntObject>(arg)->value };
 				if (index > 0LL && index <= length) {
 					auto actualIndex{ static_cast<Index>(index - 1) };
@@ -160,7 +466,7 @@ namespace hy {
 					}
 					else {
 						vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int),
-							arg_cast(static_cast<Int64>(bobj->data[actualIndex]))));
+							arg_cast(static_cast<Int64>(bobj->view()[actualIndex]))));
 						return IResult<void>(true);
 					}
 				}
@@ -168,6 +474,33 @@ namespace hy {
 			}
 			else SetError_UnmatchedIndex(vm, obj->type->v_name, args);
 		}
+		// 切片, 映射的切片共享同一映射而不复制
+		else if (argc == 2ULL && !isLV) {
+			if (auto arg1{ args[0] }, arg2{ args[1] };
+				arg1->type->v_id == TypeId::Int && arg2->type->v_id == TypeId::Int) {
+				auto left{ obj_cast<IntObject>(arg1)->value };
+				auto right{ obj_cast<IntObject>(arg2)->value };
+				auto length{ static_cast<Int64>(bobj->size()) };
+				if (left < 0LL || left > length)
+					return SetError(&SetError_IndexOutOfRange, vm, left, length);
+				if (right < 0LL || right > length)
+					return SetError(&SetError_IndexOutOfRange, vm, right, length);
+				Index begin{ }, end{ };
+				if (length) {
+					if (!left) left = 1LL;
+					if (!right) right = length;
+					if (left > right) return SetError(&SetError_IndexOutOfRange, vm, left, right);
+					begin = static_cast<Index>(left - 1LL);
+					end = static_cast<Index>(right);
+				}
+				auto ret{ obj_allocate<BinObject>(bobj->type) };
+				if (bobj->mapped) ret->share(bobj, begin, end - begin);
+				else ret->data.assign(bobj->data.data() + begin, end - begin);
+				vm->objectStack.push_link(ret);
+				return IResult<void>(true);
+			}
+			else SetError_UnmatchedIndex(vm, obj->type->v_name, args);
+		}
 		else SetError_UnmatchedIndex(vm, obj->type->v_name, args);
 		return IResult<void>();
 	}
@@ -182,14 +515,16 @@ namespace hy {
 	}
 
 	Object* f_full_copy_bin(Object* obj) noexcept {
-		auto& bin{ obj_cast<BinObject>(obj)->data };
+		auto bin{ obj_cast<BinObject>(obj)->view() };
 		return obj_allocate(obj->type, arg_cast(bin.data()), arg_cast(bin.size()));
 	}
 
 	IResult<void> f_calcassign_bin(HVM hvm, LVObject* lv, Object* obj2, AssignType opt) noexcept {
 		auto bobj1{ lv->getAddressObject<BinObject>() };
 		if (opt == AssignType::ADD_ASSIGN && obj2->type->v_id == TypeId::Bin) {
-			bobj1->data += obj_cast<BinObject>(obj2)->data;
+			auto& bin1{ bobj1->bin() }; // 先取得独占数据, obj2可能就是bobj1
+			auto bin2{ obj_cast<BinObject>(obj2)->view() };
+			bin1.append_bytes(bin2.size(), bin2.data());
 			return IResult<void>(true);
 		}
 		return SetError(&SetError_IncompatibleCalcAssign, vm_cast(hvm), bobj1->type, obj2->type, opt);
@@ -197,7 +532,7 @@ namespace hy {
 
 	IResult<void> f_assign_lv_data_bin(HVM hvm, LVObject* lv, Object* obj) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& bin{ lv->getParent<BinObject>()->data };
+		auto& bin{ lv->getParent<BinObject>()->bin() };
 		if (obj->type->v_id == TypeId::Int) {
 			bin[lv->getData<0ULL, Index>()] = static_cast<Byte>(obj_cast<IntObject>(obj)->value);
 			return IResult<void>(true);
@@ -207,7 +542,7 @@ namespace hy {
 
 	IResult<void> f_calcassign_lv_data_bin(HVM hvm, LVObject* lv, Object* obj, AssignType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& bin{ lv->getParent<BinObject>()->data };
+		auto& bin{ lv->getParent<BinObject>()->bin() };
 		if (obj->type->v_id == TypeId::Int) {
 			bin[lv->getData<0ULL, Index>()] += static_cast<Byte>(obj_cast<IntObject>(obj)->value);
 			return IResult<void>(true);
@@ -219,8 +554,8 @@ namespace hy {
 		auto vm{ vm_cast(hvm) };
 		if (opt == BOPTType::ADD && obj2->type->v_id == TypeId::Bin) {
 			auto ret{ obj_allocate<BinObject>(obj1->type) };
-			auto& bin1{ obj_cast<BinObject>(obj1)->data };
-			auto& bin2{ obj_cast<BinObject>(obj2)->data };
+			auto bin1{ obj_cast<BinObject>(obj1)->view() };
+			auto bin2{ obj_cast<BinObject>(obj2)->view() };
 			ret->data.resize(bin1.size() + bin2.size());
 			freestanding::copy_n(ret->data.data(), bin1.data(), bin1.size());
 			freestanding::copy_n(ret->data.data() + bin1.size(), bin2.data(), bin2.size());
@@ -232,8 +567,8 @@ namespace hy {
 
 	IResult<bool> f_equal_bin(HVM, Object* obj1, Object* obj2) noexcept {
 		if (obj2->type->v_id == TypeId::Bin) {
-			auto& bin1{ obj_cast<BinObject>(obj1)->data };
-			auto& bin2{ obj_cast<BinObject>(obj2)->data };
+			auto bin1{ obj_cast<BinObject>(obj1)->view() };
+			auto bin2{ obj_cast<BinObject>(obj2)->view() };
 			return IResult<bool>(bin1.size() == bin2.size() &&
 				freestanding::compare(bin1.data(), bin2.data(), bin1.size()) == 0);
 		}
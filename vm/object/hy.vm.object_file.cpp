@@ -0,0 +1,244 @@
+﻿#include "../hy.vm.impl.h"
+
+namespace hy::impl {
+	// 取得打开中的文件句柄, 文件已关闭时报错并返回空
+	Memory File_Handle(VM* vm, Object* thisObject) noexcept {
+		auto handle{ obj_cast<FileObject>(thisObject)->handle };
+		if (!handle) SetError_IODeviceError(vm);
+		return handle;
+	}
+
+	// 读取至多n个字节, 无参数时读至文件末尾
+	LIB_EXPORT void File_Read(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto handle{ File_Handle(vm, thisObject) };
+		if (!handle) return;
+		Size count;
+		if (args.empty()) {
+			auto size{ platform::Platform_HandleSize(handle) };
+			auto pos{ platform::Platform_SeekHandle(handle, 0LL, 1U) };
+			if (size < 0LL || pos < 0LL) return SetError_IODeviceError(vm);
+			count = size > pos ? static_cast<Size>(size - pos) : 0ULL;
+		}
+		else if (args.size() == 1ULL && args[0]->type->v_id == TypeId::Int) {
+			auto n{ obj_cast<IntObject>(args[0])->value };
+			if (n < 0LL) return SetError_NegativeNumber(vm, n);
+			count = static_cast<Size>(n);
+		}
+		else return SetError_UnmatchedCall(vm, u"file::read", args);
+		auto bobj{ obj_allocate<BinObject>(vm->getType(TypeId::Bin)) };
+		bobj->data.resize(count);
+		bobj->data.resize(platform::Platform_ReadHandle(handle, bobj->data.data(), count));
+		vm->objectStack.push_link(bobj);
+	}
+
+	// 写出字节集或字符串(UTF-8编码), 返回自身
+	LIB_EXPORT void File_Write(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto handle{ File_Handle(vm, thisObject) };
+		if (!handle) return;
+		auto ok{ false };
+		if (auto arg{ args[0] }; arg->type->v_id == TypeId::Bin) {
+			auto bytes{ obj_cast<BinObject>(arg)->view() };
+			ok = platform::Platform_WriteHandle(handle, bytes.data(), bytes.size());
+		}
+		else if (arg->type->v_id == TypeId::String) {
+			util::ByteArray ba;
+			platform::Platform_StringToUTF8(obj_cast<StringObject>(arg)->view(), &ba);
+			ok = platform::Platform_WriteHandle(handle, ba.data(), ba.size());
+		}
+		else return SetError_UnmatchedCall(vm, u"file::write", args);
+		if (ok) vm->objectStack.push_link(thisObject);
+		else SetError_IODeviceError(vm);
+	}
+
+	// seek(pos, origin = 0), origin为0, 1, 2时分别相对文件开头, 当前位置与文件末尾, 返回新位置
+	LIB_EXPORT void File_Seek(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto handle{ File_Handle(vm, thisObject) };
+		if (!handle) return;
+		auto argc{ args.size() };
+		if ((argc == 1ULL || argc == 2ULL) && args[0]->type->v_id == TypeId::Int &&
+			(argc == 1ULL || args[1]->type->v_id == TypeId::Int)) {
+			auto origin{ argc == 2ULL ? obj_cast<IntObject>(args[1])->value : 0LL };
+			if (origin >= 0LL && origin <= 2LL) {
+				auto pos{ platform::Platform_SeekHandle(handle, obj_cast<IntObject>(args[0])->value, static_cast<Uint32>(origin)) };
+				if (pos < 0LL) return SetError_IODeviceError(vm);
+				vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(pos)));
+				return;
+			}
+		}
+		SetError_UnmatchedCall(vm, u"file::seek", args);
+	}
+
+	LIB_EXPORT void File_Tell(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto handle{ File_Handle(vm, thisObject) };
+		if (!handle) return;
+		auto pos{ platform::Platform_SeekHandle(handle, 0LL, 1U) };
+		if (pos < 0LL) return SetError_IODeviceError(vm);
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(pos)));
+	}
+
+	LIB_EXPORT void File_Size(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto handle{ File_Handle(vm, thisObject) };
+		if (!handle) return;
+		auto size{ platform::Platform_HandleSize(handle) };
+		if (size < 0LL) return SetError_IODeviceError(vm);
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(size)));
+	}
+
+	LIB_EXPORT void File_Close(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto fobj{ obj_cast<FileObject>(thisObject) };
+		if (fobj->handle) {
+			platform::Platform_CloseHandle(fobj->handle);
+			fobj->handle = nullptr;
+		}
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+	}
+}
+
+namespace hy {
+	struct FileStaticData {
+		FunctionTable ft;
+
+		FileStaticData(TypeObject* type) noexcept {
+			auto funcType{ type->__getType(TypeId::Function) };
+
+			Object* __any[] { nullptr };
+			ObjArgsView empty, any1{ __any, 1ULL };
+
+			ft.try_emplace(u"read", MakeNative<false, true>(funcType, u"file::read", &impl::File_Read, empty));
+			ft.try_emplace(u"write", MakeNative<true, true>(funcType, u"file::write", &impl::File_Write, any1));
+			ft.try_emplace(u"seek", MakeNative<false, true>(funcType, u"file::seek", &impl::File_Seek, empty));
+			ft.try_emplace(u"tell", MakeNative<true, true>(funcType, u"file::tell", &impl::File_Tell, empty));
+			ft.try_emplace(u"size", MakeNative<true, true>(funcType, u"file::size", &impl::File_Size, empty));
+			ft.try_emplace(u"close", MakeNative<true, true>(funcType, u"file::close", &impl::File_Close, empty));
+		}
+	};
+
+	void f_class_create_file(TypeObject* type) noexcept {
+		type->v_static = new FileStaticData(type);
+	}
+
+	void f_class_delete_file(TypeObject* type) noexcept {
+		auto staticData{ static_cast<FileStaticData*>(type->v_static) };
+		for (auto& [_, fobj] : staticData->ft) delete fobj;
+		delete staticData;
+	}
+
+	// 回收时关闭未显式关闭的文件
+	void f_deallocate_file(Object* obj) noexcept {
+		auto fobj{ obj_cast<FileObject>(obj) };
+		if (fobj->handle) platform::Platform_CloseHandle(fobj->handle);
+		delete fobj;
+	}
+
+	bool f_bool_file(Object* obj) noexcept {
+		return obj_cast<FileObject>(obj)->handle != nullptr;
+	}
+
+	IResult<void> f_string_file(HVM, Object* obj, String* str) noexcept {
+		str->append(obj_cast<FileObject>(obj)->handle ? u"file" : u"file(closed)");
+		return IResult<void>(true);
+	}
+
+	IResult<void> f_member_file(HVM hvm, bool isLV, Object* obj, const StringView member) noexcept {
+		auto vm{ vm_cast(hvm) };
+		if (!isLV) {
+			auto& ft{ static_cast<FileStaticData*>(obj->type->v_static)->ft };
+			if (auto pFobj{ ft.get(member) }) {
+				auto fobj{ obj_allocate(vm->getType(TypeId::MemberFunction), *pFobj, obj) };
+				vm->objectStack.push_link(fobj);
+				return IResult<void>(true);
+			}
+			else return SetError(&SetError_UnmatchedMember, vm, obj->type, member);
+		}
+		else return SetError(&SetError_NotLeftValue, vm, member);
+	}
+
+	// file(path, mode = "r"), mode: "r"只读, "w"覆盖写, "a"追加写, "r+"读写(不存在时创建)
+	IResult<void> f_construct_file(HVM hvm, TypeObject* type, ObjArgsView args) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto argc{ args.size() };
+		if ((argc == 1ULL || argc == 2ULL) && args[0]->type->v_id == TypeId::String &&
+			(argc == 1ULL || args[1]->type->v_id == TypeId::String)) {
+			auto mode{ FileMode::READ };
+			if (argc == 2ULL) {
+				if (auto m{ obj_cast<StringObject>(args[1])->view() }; m == u"r") mode = FileMode::READ;
+				else if (m == u"w") mode = FileMode::WRITE;
+				else if (m == u"a") mode = FileMode::APPEND;
+				else if (m == u"r+") mode = FileMode::UPDATE;
+				else return SetError(&SetError_UnmatchedCall, vm, type->v_name, args);
+			}
+			auto path{ GetWorkFilePath(vm, obj_cast<StringObject>(args[0])->view()) };
+			if (auto handle{ platform::Platform_OpenFile(path, mode) }) {
+				auto fobj{ obj_allocate<FileObject>(type) };
+				fobj->handle = handle;
+				vm->objectStack.push_link(fobj);
+				return IResult<void>(true);
+			}
+			return SetError(&SetError_FileNotExists, vm, StringView{ path });
+		}
+		return SetError(&SetError_UnmatchedCall, vm, type->v_name, args);
+	}
+}
+
+namespace hy {
+	TypeObject* AddFilePrototype(TypeObject* prototype) noexcept {
+		auto type{ new TypeObject(prototype) };
+		type->v_id = TypeId::File;
+		type->v_name = u"file";
+
+		type->v_static = nullptr;
+		type->v_cls = nullptr;
+		type->v_cps = nullptr;
+
+		type->a_mutable = true;
+		type->a_def = false;
+		type->a_unused1 = type->a_unused2 = false;
+
+		type->f_class_create = &f_class_create_file;
+		type->f_class_delete = &f_class_delete_file;
+		type->f_class_clean = nullptr;
+		type->f_allocate = &f_allocate_default<FileObject>;
+		type->f_deallocate = &f_deallocate_file;
+		type->f_implement = nullptr;
+
+		type->f_float = nullptr;
+		type->f_bool = &f_bool_file;
+		type->f_string = &f_string_file;
+
+		type->f_hash = nullptr;
+		type->f_len = nullptr;
+		type->f_member = &f_member_file;
+		type->f_index = nullptr;
+		type->f_unpack = nullptr;
+
+		type->f_construct = &f_construct_file;
+		type->f_full_copy = nullptr;
+		type->f_copy = nullptr;
+		type->f_write = nullptr;
+		type->f_scan = nullptr;
+		type->f_calcassign = nullptr;
+
+		type->f_assign_lv_data = nullptr;
+		type->f_calcassign_lv_data = nullptr;
+		type->f_free_lv_data = nullptr;
+
+		type->f_sopt_calc = nullptr;
+		type->f_bopt_calc = nullptr;
+		type->f_equal = &f_equal_ref;
+		type->f_compare = nullptr;
+
+		type->f_iter_get = nullptr;
+		type->f_iter_save = nullptr;
+		type->f_iter_add = nullptr;
+		type->f_iter_check = nullptr;
+		type->f_iter_free = nullptr;
+
+		return type;
+	}
+}
@@ -1,11 +1,14 @@
 ﻿#include "../hy.vm.impl.h"
 
+#include <algorithm>
+#include <thread>
+
 namespace hy::impl {
 	LIB_EXPORT void List_Push(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto lobj{ obj_cast<ListObject>(thisObject) };
 		args[0]->link();
-		lobj->objects.emplace_back(args[0]);
+		lobj->vec().emplace_back(args[0]);
 		vm->objectStack.push_link(lobj);
 	}
 
@@ -13,10 +16,11 @@ namespace hy::impl {
 		auto vm{ vm_cast(hvm) };
 		auto lobj{ obj_cast<ListObject>(thisObject) };
 		auto index{ obj_cast<IntObject>(args[0])->value };
-		auto len{ static_cast<Int64>(lobj->objects.size() + 1) };
+		auto len{ static_cast<Int64>(lobj->size() + 1) };
 		if (index > 0 && index <= len) {
 			args[1]->link();
-			lobj->objects.insert(lobj->objects.cbegin() + index - 1, args[1]);
+			auto& objects{ lobj->vec() };
+			objects.insert(objects.cbegin() + index - 1, args[1]);
 			vm->objectStack.push_link(lobj);
 		}
 		else SetError_IndexOutOfRange(vm, index, len);
@@ -25,10 +29,11 @@ namespace hy::impl {
 	LIB_EXPORT void List_Pop(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto lobj{ obj_cast<ListObject>(thisObject) };
-		if (lobj->objects.empty()) SetError_EmptyContainer(vm, u"list::pop", lobj->type);
+		if (!lobj->size()) SetError_EmptyContainer(vm, u"list::pop", lobj->type);
 		else {
-			auto obj{ lobj->objects.back() };
-			lobj->objects.pop_back();
+			auto& objects{ lobj->vec() };
+			auto obj{ objects.back() };
+			objects.pop_back();
 			vm->objectStack.push_normal(obj);
 		}
 	}
@@ -37,10 +42,11 @@ namespace hy::impl {
 		auto vm{ vm_cast(hvm) };
 		auto lobj{ obj_cast<ListObject>(thisObject) };
 		auto index{ obj_cast<IntObject>(args[0])->value };
-		auto len{ static_cast<Int64>(lobj->objects.size()) };
+		auto len{ static_cast<Int64>(lobj->size()) };
 		if (index > 0 && index <= len) {
-			auto obj{ lobj->objects[index - 1] };
-			lobj->objects.erase(lobj->objects.cbegin() + index - 1);
+			auto& objects{ lobj->vec() };
+			auto obj{ objects[index - 1] };
+			objects.erase(objects.cbegin() + index - 1);
 			vm->objectStack.push_normal(obj);
 		}
 		else SetError_IndexOutOfRange(vm, index, len);
@@ -49,19 +55,285 @@ namespace hy::impl {
 	LIB_EXPORT void List_Clear(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto lobj{ obj_cast<ListObject>(thisObject) };
-		for (auto obj : lobj->objects) obj->unlink();
-		lobj->objects.clear();
+		lobj->clear();
 		vm->objectStack.push_link(thisObject);
 	}
 
 	LIB_EXPORT void List_Reverse(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto lobj{ obj_cast<ListObject>(thisObject) };
-		std::reverse(lobj->objects.begin(), lobj->objects.end());
+		auto& objects{ lobj->vec() };
+		std::reverse(objects.begin(), objects.end());
 		vm->objectStack.push_link(thisObject);
 	}
 }
 
+namespace hy::impl {
+	/*
+	列表排序
+	稳定的归并排序, 小段使用插入排序, 比较出错后比较函数恒返回假以尽快结束
+	键全为int, float或string时取出原始值比较, 不经过f_compare, 且元素较多时分段并行排序后逐轮两两归并
+	其他情况以f_compare比较, 仅在给出键函数或比较函数时回调用户函数
+	*/
+	constexpr auto SORT_INSERTION_MAX{ 24ULL };
+	constexpr auto SORT_PARALLEL_MIN{ 1ULL << 16ULL };
+	constexpr auto SORT_CHUNK_MIN{ 1ULL << 14ULL };
+
+	template<typename T, typename Less>
+	void List_MergeSort(T* first, T* last, T* buffer, Less& less) noexcept {
+		auto n{ static_cast<Size>(last - first) };
+		if (n <= SORT_INSERTION_MAX) {
+			for (auto i{ first + 1 }; i < last; ++i) {
+				auto value{ *i };
+				auto j{ i };
+				for (; j != first && less(value, j[-1]); --j) *j = j[-1];
+				*j = value;
+			}
+			return;
+		}
+		auto mid{ first + (n >> 1ULL) };
+		List_MergeSort(first, mid, buffer, less);
+		List_MergeSort(mid, last, buffer, less);
+		if (!less(*mid, mid[-1])) return;
+		std::merge(first, mid, mid, last, buffer, less);
+		std::copy(buffer, buffer + n, first);
+	}
+
+	// 分段并行排序后逐轮并行两两归并, less需可并发调用
+	template<typename T, typename Less>
+	void List_ParallelSort(Vector<T>& data, Less less) noexcept {
+		auto n{ data.size() };
+		Vector<T> buffer(n);
+		Size threads{ std::thread::hardware_concurrency() };
+		threads = std::clamp(std::min(threads, n / SORT_CHUNK_MIN), 1ULL, 64ULL);
+		if (threads == 1ULL) {
+			List_MergeSort(data.data(), data.data() + n, buffer.data(), less);
+			return;
+		}
+		Vector<Index> bounds(threads + 1ULL);
+		for (Index i{ }; i <= threads; ++i) bounds[i] = n * i / threads;
+		Vector<std::thread> workers;
+		workers.reserve(threads);
+		for (Index i{ }; i < threads; ++i) {
+			workers.emplace_back([&, i] {
+				auto lessCopy{ less };
+				List_MergeSort(data.data() + bounds[i], data.data() + bounds[i + 1ULL], buffer.data() + bounds[i], lessCopy);
+			});
+		}
+		for (auto& worker : workers) worker.join();
+		for (Size width{ 1ULL }; width < threads; width <<= 1ULL) {
+			workers.clear();
+			for (Index i{ }; i + width < threads; i += width << 1ULL) {
+				auto first{ bounds[i] }, mid{ bounds[i + width] }, last{ bounds[std::min(i + (width << 1ULL), threads)] };
+				workers.emplace_back([&, first, mid, last] {
+					std::merge(data.data() + first, data.data() + mid, data.data() + mid, data.data() + last,
+						buffer.data() + first, less);
+					std::copy(buffer.data() + first, buffer.data() + last, data.data() + first);
+				});
+			}
+			for (auto& worker : workers) worker.join();
+		}
+	}
+
+	// 比较函数的结果, 整数小于0或布尔值为真表示前者在前, 其他类型报错, 结果对象解除链接
+	inline bool List_CompareResult(VM* vm, Object* obj) noexcept {
+		auto before{ false };
+		if (obj->type->v_id == TypeId::Int) before = obj_cast<IntObject>(obj)->value < 0LL;
+		else if (obj->type->v_id == TypeId::Bool) before = obj_cast<BoolObject>(obj)->value;
+		else SetError_NotBoolean(vm, obj->type);
+		obj->unlink();
+		return before;
+	}
+
+	template<typename K>
+	struct SortItem {
+		K key;
+		Object* item;
+	};
+
+	// 以键的原始值排序items
+	template<typename K, typename Get>
+	void List_SortBy(ObjArgsView keys, Object** items, Get get) noexcept {
+		auto n{ keys.size() };
+		Vector<SortItem<K>> data(n);
+		for (Index i{ }; i < n; ++i) data[i] = { get(keys[i]), items[i] };
+		auto less{ [](const SortItem<K>& a, const SortItem<K>& b) noexcept { return a.key < b.key; } };
+		if (n >= SORT_PARALLEL_MIN) List_ParallelSort(data, less);
+		else {
+			Vector<SortItem<K>> buffer(n);
+			List_MergeSort(data.data(), data.data() + n, buffer.data(), less);
+		}
+		for (Index i{ }; i < n; ++i) items[i] = data[i].item;
+	}
+
+	// 按keys排序items, keys[i]为items[i]的键, 无键函数时keys即items
+	// cmp非空时以cmp(a, b)比较键, 返回值为bool时表示a在b之前, 为int时小于0表示a在b之前
+	IResult<void> List_SortItems(VM* vm, ObjArgsView keys, Object** items, Object* cmp) noexcept {
+		auto n{ keys.size() };
+		if (n < 2ULL) return IResult<void>(true);
+		if (!cmp) {
+			auto id{ keys[0]->type->v_id };
+			auto same{ id == TypeId::Int || id == TypeId::Float || id == TypeId::String };
+			for (Index i{ 1ULL }; same && i < n; ++i) same = keys[i]->type->v_id == id;
+			if (same) {
+				// 浮点数以NaN最大的全序比较, 保证排序结果确定
+				if (id == TypeId::Int) List_SortBy<Int64>(keys, items,
+					[](Object* obj) noexcept { return obj_cast<IntObject>(obj)->value; });
+				else if (id == TypeId::Float) List_SortBy<Float64>(keys, items,
+					[](Object* obj) noexcept {
+						auto value{ obj_cast<FloatObject>(obj)->value };
+						return value == value ? value : std::numeric_limits<Float64>::infinity();
+					});
+				else List_SortBy<StringView>(keys, items,
+					[](Object* obj) noexcept { return obj_cast<StringObject>(obj)->view(); });
+				return IResult<void>(true);
+			}
+		}
+		Vector<SortItem<Object*>> data(n), buffer(n);
+		for (Index i{ }; i < n; ++i) data[i] = { keys[i], items[i] };
+		auto less{ [vm, cmp](const SortItem<Object*>& a, const SortItem<Object*>& b) noexcept {
+			if (vm->error()) return false;
+			if (cmp) {
+				Object* args[]{ a.key, b.key };
+				auto ret{ CallObject(vm, cmp, ObjArgsView{ args, 2ULL }) };
+				if (!ret) return false;
+				return List_CompareResult(vm, ret.data);
+			}
+			if (auto type{ a.key->type }; type->f_compare) {
+				auto ret{ type->f_compare(vm, a.key, b.key, BOPTType::LT) };
+				return ret && ret.data;
+			}
+			SetError_UnsupportedBOPT(vm, a.key->type, b.key->type, BOPTType::LT);
+			return false;
+		} };
+		List_MergeSort(data.data(), data.data() + n, buffer.data(), less);
+		if (vm->error()) return IResult<void>();
+		for (Index i{ }; i < n; ++i) items[i] = data[i].item;
+		return IResult<void>(true);
+	}
+
+	// 排序列表的元素, 参数为空或一个函数, 单参数函数作为键函数, 否则作为比较函数
+	// objects是持有引用的元素副本, 回调的用户函数修改原列表不影响排序过程
+	IResult<void> List_SortObjects(VM* vm, Vector<Object*>& objects, ObjArgsView args, const StringView name) noexcept {
+		Object* func{ };
+		if (auto argc{ args.size() }; argc == 1ULL) {
+			func = args[0];
+			if (func->type->v_id != TypeId::Function && func->type->v_id != TypeId::MemberFunction)
+				return SetError(&SetError_UnmatchedCall, vm, name, args);
+		}
+		else if (argc) return SetError(&SetError_UnmatchedCall, vm, name, args);
+		auto n{ objects.size() };
+		if (!func) return List_SortItems(vm, ObjArgsView{ objects.data(), n }, objects.data(), nullptr);
+		auto fobj{ func->type->v_id == TypeId::Function ? obj_cast<FunctionObject>(func) :
+			obj_cast<MemberFunctionObject>(func)->funcObject };
+		if (fobj->ft == FunctionType::NORMAL && fobj->targs.args.size() == 2ULL)
+			return List_SortItems(vm, ObjArgsView{ objects.data(), n }, objects.data(), func);
+		// 键函数对每个元素只调用一次
+		Vector<Object*> keys;
+		keys.reserve(n);
+		for (auto item : objects) {
+			auto ret{ CallObject(vm, func, ObjArgsView{ &item, 1ULL }) };
+			if (!ret) break;
+			keys.emplace_back(ret.data);
+		}
+		auto ir{ vm->ok() ? List_SortItems(vm, ObjArgsView{ keys.data(), n }, objects.data(), nullptr) : IResult<void>() };
+		for (auto key : keys) key->unlink();
+		return ir;
+	}
+
+	LIB_EXPORT void List_Sort(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto lobj{ obj_cast<ListObject>(thisObject) };
+		auto view{ lobj->view() };
+		Vector<Object*> objects(view.begin(), view.end());
+		for (auto item : objects) item->link();
+		if (List_SortObjects(vm, objects, args, u"list::sort")) {
+			lobj->clear();
+			lobj->objects = freestanding::move(objects);
+			vm->objectStack.push_link(thisObject);
+		}
+		else for (auto item : objects) item->unlink();
+	}
+
+	LIB_EXPORT void List_Sorted(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto view{ obj_cast<ListObject>(thisObject)->view() };
+		auto ret{ obj_allocate<ListObject>(thisObject->type) };
+		ret->objects.assign(view.begin(), view.end());
+		for (auto item : ret->objects) item->link();
+		ret->link();
+		if (List_SortObjects(vm, ret->objects, args, u"list::sorted")) vm->objectStack.push_link(ret);
+		ret->unlink();
+	}
+
+	// 在已按升序排列的列表中查找首个不小于value的位置, cmp语义同List_SortItems
+	IResult<Index> List_LowerBound(VM* vm, ObjArgsView items, Object* value, Object* cmp) noexcept {
+		Index first{ }, count{ items.size() };
+		while (count) {
+			auto step{ count >> 1ULL };
+			auto item{ items[first + step] };
+			auto less{ false };
+			if (cmp) {
+				Object* args[]{ item, value };
+				auto ret{ CallObject(vm, cmp, ObjArgsView{ args, 2ULL }) };
+				if (!ret) return IResult<Index>();
+				less = List_CompareResult(vm, ret.data);
+				if (vm->error()) return IResult<Index>();
+			}
+			else if (item->type->f_compare) {
+				auto ret{ item->type->f_compare(vm, item, value, BOPTType::LT) };
+				if (!ret) return IResult<Index>();
+				less = ret.data;
+			}
+			else return SetError<Index>(&SetError_UnsupportedBOPT, vm, item->type, value->type, BOPTType::LT);
+			if (less) {
+				first += step + 1ULL;
+				count -= step + 1ULL;
+			}
+			else count = step;
+		}
+		return IResult<Index>(first);
+	}
+
+	template<bool exact>
+	void List_Search(HVM hvm, ObjArgsView args, Object* thisObject, const StringView name) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto argc{ args.size() };
+		if (argc != 1ULL && argc != 2ULL) {
+			SetError_UnmatchedCall(vm, name, args);
+			return;
+		}
+		Object* cmp{ argc == 2ULL ? args[1] : nullptr };
+		if (cmp && cmp->type->v_id != TypeId::Function && cmp->type->v_id != TypeId::MemberFunction) {
+			SetError_UnmatchedCall(vm, name, args);
+			return;
+		}
+		auto items{ obj_cast<ListObject>(thisObject)->view() };
+		auto ir{ List_LowerBound(vm, items, args[0], cmp) };
+		if (!ir) return;
+		auto index{ ir.data };
+		Int64 result{ static_cast<Int64>(index) + 1LL };
+		if constexpr (exact) {
+			// 找到的位置上value不小于元素时二者相等
+			if (index == items.size()) result = 0LL;
+			else {
+				auto found{ List_LowerBound(vm, ObjArgsView{ &args[0], 1ULL }, items[index], cmp) };
+				if (!found) return;
+				if (found.data) result = 0LL;
+			}
+		}
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(result)));
+	}
+
+	LIB_EXPORT void List_BSearch(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		List_Search<true>(hvm, args, thisObject, u"list::bsearch");
+	}
+
+	LIB_EXPORT void List_LowerBoundNative(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		List_Search<false>(hvm, args, thisObject, u"list::lower_bound");
+	}
+}
+
 namespace hy {
 	struct ListStaticData {
 		Vector<ListObject*> pool;
@@ -80,6 +352,10 @@ namespace hy {
 			ft.try_emplace(u"delete", MakeNative<true, true>(funcType, u"list::delete", &impl::List_Delete, it));
 			ft.try_emplace(u"clear", MakeNative<true, true>(funcType, u"list::clear", &impl::List_Clear, empty));
 			ft.try_emplace(u"reverse", MakeNative<true, true>(funcType, u"list::reverse", &impl::List_Reverse, empty));
+			ft.try_emplace(u"sort", MakeNative<false, true>(funcType, u"list::sort", &impl::List_Sort, empty));
+			ft.try_emplace(u"sorted", MakeNative<false, true>(funcType, u"list::sorted", &impl::List_Sorted, empty));
+			ft.try_emplace(u"bsearch", MakeNative<false, true>(funcType, u"list::bsearch", &impl::List_BSearch, empty));
+			ft.try_emplace(u"lower_bound", MakeNative<false, true>(funcType, u"list::lower_bound", &impl::List_LowerBoundNative, empty));
 		}
 	};
 
@@ -116,32 +392,32 @@ namespace hy {
 	void f_deallocate_list(Object* obj) noexcept {
 		auto& pool{ static_cast<ListStaticData*>(obj->type->v_static)->pool };
 		auto lobj{ obj_cast<ListObject>(obj) };
-		for (auto item : lobj->objects) item->unlink();
+		lobj->clear();
 		pool.emplace_back(lobj);
 	}
 
 	bool f_bool_list(Object* obj) noexcept {
-		return !obj_cast<ListObject>(obj)->objects.empty();
+		return obj_cast<ListObject>(obj)->size() != 0ULL;
 	}
 
 	IResult<void> f_string_list(HVM hvm, Object* obj, String* str) noexcept {
 		auto vm{ vm_cast(hvm) };
 		String tmp;
 		tmp.push_back(u'{');
-		auto lobj{ obj_cast<ListObject>(obj) };
-		for (auto item : lobj->objects) {
+		auto items{ obj_cast<ListObject>(obj)->view() };
+		for (auto item : items) {
 			if (item == obj) tmp += u"..."; // 防止自引用
 			else if (!item->type->f_string(vm, item, &tmp)) return IResult<void>();
 			tmp.push_back(u',');
 		}
-		if (lobj->objects.empty()) tmp.push_back(u'}');
+		if (items.empty()) tmp.push_back(u'}');
 		else tmp.back() = u'}';
 		str->append(tmp);
 		return IResult<void>(true);
 	}
 
 	IResult<Size> f_len_list(HVM, Object* obj) noexcept {
-		return IResult<Size>(obj_cast<ListObject>(obj)->objects.size());
+		return IResult<Size>(obj_cast<ListObject>(obj)->size());
 	}
 
 	IResult<void> f_member_list(HVM hvm, bool isLV, Object* obj, const StringView member) noexcept {
@@ -165,7 +441,7 @@ namespace hy {
 		auto lobj{ obj_cast<ListObject>(obj) };
 		if (auto argc{ args.size() }; argc == 1ULL) {
 			if (auto arg{ args[0] }; arg->type->v_id == TypeId::Int) {
-				auto length{ static_cast<Int64>(lobj->objects.size()) };
+				auto length{ static_cast<Int64>(lobj->size()) };
 				auto index{ obj_cast<IntObject>(arg)->value };
 				if (index > 0LL && index <= length) {
 					auto actualIndex{ static_cast<Index>(index - 1) };
@@ -174,10 +450,10 @@ namespace hy {
 						lv->parent = obj;
 						lv->parent->link();
 						lv->lvType = LVType::ADDRESS;
-						lv->storage.address = &lobj->objects[actualIndex];
+						lv->storage.address = &lobj->vec()[actualIndex];
 						vm->objectStack.push_link(lv);
 					}
-					else vm->objectStack.push_link(lobj->objects[actualIndex]);
+					else vm->objectStack.push_link(lobj->view()[actualIndex]);
 					return IResult<void>(true);
 				}
 				return SetError(&SetError_IndexOutOfRange, vm, index, length);
@@ -188,7 +464,7 @@ namespace hy {
 				arg1->type->v_id == TypeId::Int && arg2->type->v_id == TypeId::Int) {
 				auto left{ obj_cast<IntObject>(arg1)->value };
 				auto right{ obj_cast<IntObject>(arg2)->value };
-				auto length{ static_cast<Int64>(lobj->objects.size()) };
+				auto length{ static_cast<Int64>(lobj->size()) };
 				if (left < 0LL || left > length)
 					return SetError(&SetError_IndexOutOfRange, vm, left, length);
 				if (right < 0LL || right > length)
@@ -211,9 +487,12 @@ namespace hy {
 				}
 				else {
 					auto newList{ obj_allocate<ListObject>(lobj->type) };
-					newList->objects.reserve(end - begin);
-					newList->objects.assign(lobj->objects.cbegin() + begin, lobj->objects.cbegin() + end);
-					for (auto item : newList->objects) item->link();
+					if (SliceShare::check(end - begin, lobj->size())) newList->share(lobj, begin, end - begin);
+					else {
+						auto items{ lobj->view() };
+						newList->objects.assign(items.begin() + begin, items.begin() + end);
+						for (auto item : newList->objects) item->link();
+					}
 					vm->objectStack.push_link(newList);
 				}
 				return IResult<void>(true);
@@ -225,9 +504,9 @@ namespace hy {
 
 	IResult<void> f_unpack_list(HVM hvm, Object* obj, Size argc) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto lobj{ obj_cast<ListObject>(obj) };
-		if (auto size{ lobj->objects.size() }; argc <= size) {
-			for (Size i{ }; i < argc; ++i) vm->objectStack.push_link(lobj->objects[i]);
+		auto items{ obj_cast<ListObject>(obj)->view() };
+		if (auto size{ items.size() }; argc <= size) {
+			for (Size i{ }; i < argc; ++i) vm->objectStack.push_link(items[i]);
 			return IResult<void>(true);
 		}
 		else return SetError(&SetError_UnmatchedUnpack, vm, size, argc);
@@ -244,7 +523,7 @@ namespace hy {
 			ListObject* lobj{ };
 			if (arg->type->v_id == TypeId::Vector) {
 				lobj = obj_allocate<ListObject>(type);
-				auto& data{ obj_cast<VectorObject>(arg)->data };
+				auto& data{ obj_cast<VectorObject>(arg)->value() };
 				if (!data.empty()) {
 					auto floatType{ vm->getType(TypeId::Float) };
 					lobj->objects.reserve(data.size());
@@ -301,9 +580,9 @@ namespace hy {
 	}
 
 	Object* f_full_copy_list(Object* obj) noexcept {
-		auto lobj{ obj_cast<ListObject>(obj) };
+		auto items{ obj_cast<ListObject>(obj)->view() };
 		auto clone{ obj_allocate<ListObject>(obj->type) };
-		clone->objects = lobj->objects;
+		clone->objects.assign(items.begin(), items.end());
 		for (auto& item : clone->objects) {
 			if (item == obj) item = clone; // 防止自引用
 			else if (item->type->f_full_copy) item = item->type->f_full_copy(item);
@@ -313,9 +592,9 @@ namespace hy {
 	}
 
 	IResult<void> f_write_list(HVM, Object* obj, ObjArgsView args) noexcept {
-		auto lobj{ obj_cast<ListObject>(obj) };
-		lobj->objects.reserve(lobj->objects.size() + args.size());
-		lobj->objects.insert(lobj->objects.end(), args.cbegin(), args.cend());
+		auto& objects{ obj_cast<ListObject>(obj)->vec() };
+		objects.reserve(objects.size() + args.size());
+		objects.insert(objects.end(), args.cbegin(), args.cend());
 		for (auto arg : args) arg->link();
 		return IResult<void>(true);
 	}
@@ -325,9 +604,11 @@ namespace hy {
 		auto lobj1{ lv->getAddressObject<ListObject>() };
 		if (opt == AssignType::ADD_ASSIGN && obj2->type->v_id == TypeId::List) {
 			auto lobj2{ obj_cast<ListObject>(obj2) };
-			for (auto item : lobj2->objects) item->link();
-			lobj1->objects.reserve(lobj1->objects.size() + lobj2->objects.size());
-			lobj1->objects.insert(lobj1->objects.end(), lobj2->objects.cbegin(), lobj2->objects.cend());
+			auto& objects{ lobj1->vec() };
+			objects.reserve(objects.size() + lobj2->size());
+			auto items{ lobj2->view() }; // 扩容后再取视图, 自身相加时视图即为objects
+			for (auto item : items) item->link();
+			objects.insert(objects.end(), items.begin(), items.end());
 			return IResult<void>(true);
 		}
 		else return SetError(&SetError_IncompatibleCalcAssign, vm, lobj1->type, obj2->type, opt);
@@ -338,8 +619,7 @@ namespace hy {
 		if (obj->type->v_id == TypeId::List) {
 			auto lobj1{ lv->getParent<ListObject>() };
 			auto lobj2{ obj_cast<ListObject>(obj) };
-			auto& data1{ lobj1->objects };
-			auto& data2{ lobj2->objects };
+			auto& data1{ lobj1->vec() };
 			auto begin{ lv->getData<0ULL, Index>() };
 			auto end{ lv->getData<1ULL, Index>() };
 			if (lobj1 == lobj2) { // 同列表
@@ -352,10 +632,11 @@ namespace hy {
 				freestanding::copy_n(pb + begin, pb, rawSize);
 			}
 			else {
+				auto data2{ lobj2->view() };
 				for (auto item : data2) item->link();
 				for (auto i{ begin }; i < end; ++i) data1[i]->unlink();
 				data1.erase(data1.cbegin() + begin, data1.cbegin() + end);
-				data1.insert(data1.cbegin() + begin, data2.cbegin(), data2.cend());
+				data1.insert(data1.cbegin() + begin, data2.begin(), data2.end());
 			}
 			return IResult<void>(true);
 		}
@@ -365,15 +646,15 @@ namespace hy {
 	IResult<void> f_bopt_calc_list(HVM hvm, Object* obj1, Object* obj2, BOPTType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
 		if (opt == BOPTType::ADD && obj2->type->v_id == TypeId::List) {
-			auto lobj1{ obj_cast<ListObject>(obj1) };
-			auto lobj2{ obj_cast<ListObject>(obj2) };
+			auto items1{ obj_cast<ListObject>(obj1)->view() };
+			auto items2{ obj_cast<ListObject>(obj2)->view() };
 			auto lobj{ obj_allocate<ListObject>(obj1->type) };
-			auto count1{ lobj1->objects.size() };
-			auto count2{ lobj2->objects.size() };
+			auto count1{ items1.size() };
+			auto count2{ items2.size() };
 			auto count{ count1 + count2 };
 			lobj->objects.resize(count);
-			auto data1{ lobj1->objects.data() };
-			auto data2{ lobj2->objects.data() };
+			auto data1{ items1.data() };
+			auto data2{ items2.data() };
 			auto data{ lobj->objects.data() };
 			freestanding::copy_n(data, data1, count1);
 			freestanding::copy_n(data + count1, data2, count2);
@@ -386,8 +667,8 @@ namespace hy {
 
 	IResult<bool> f_equal_list(HVM hvm, Object* obj1, Object* obj2) noexcept {
 		if (obj2->type->v_id != TypeId::List) return IResult<bool>(false);
-		auto& data1{ obj_cast<ListObject>(obj1)->objects };
-		auto& data2{ obj_cast<ListObject>(obj2)->objects };
+		auto data1{ obj_cast<ListObject>(obj1)->view() };
+		auto data2{ obj_cast<ListObject>(obj2)->view() };
 		if (data1.size() != data2.size()) return IResult<bool>(false);
 		for (Index i{ }, l = data1.size(); i < l; ++i) {
 			if (auto ir{ data1[i]->type->f_equal(hvm, data1[i], data2[i]) }) {
@@ -415,7 +696,7 @@ namespace hy {
 		auto lobj{ iter->getReference<ListObject>() };
 		if (argc == 1ULL || argc == 2ULL) {
 			auto pos{ iter->getData<0ULL, Index>() };
-			vm->objectStack.push_link(lobj->objects[pos]);
+			vm->objectStack.push_link(lobj->view()[pos]);
 			if (argc == 2ULL) vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int),
 				arg_cast(static_cast<Int64>(pos + 1ULL))));
 			return IResult<void>(true);
@@ -429,7 +710,7 @@ namespace hy {
 	}
 
 	IResult<bool> f_iter_check_list(HVM, IteratorObject* iter) noexcept {
-		return IResult<bool>(iter->getData<0ULL, Index>() != iter->getReference<ListObject>()->objects.size());
+		return IResult<bool>(iter->getData<0ULL, Index>() != iter->getReference<ListObject>()->size());
 	}
 }
 
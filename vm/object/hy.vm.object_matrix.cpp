@@ -2,18 +2,578 @@
 
 #include <fast_io/fast_io.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define HY_MATRIX_AVX2
+#include <immintrin.h>
+#endif
+
+namespace hy::impl::details {
+	/*
+	矩阵乘法 C = A * B, 均为行主序
+	按NC列, KC深度, MC行分块, 使B块驻留L3, A块驻留L2
+	A块按MR行, B块按NR列打包为连续条带, 不足处补0, 微内核计算MR×NR的C子块
+	AVX2+FMA下微内核以8个ymm寄存器累加4×8子块, 否则为可自动向量化的标量循环
+	运算量较大时按行分段并行, 各线程独立打包
+	*/
+	constexpr auto GEMM_MR{ 4ULL };
+	constexpr auto GEMM_NR{ 8ULL };
+	constexpr auto GEMM_MC{ 128ULL };
+	constexpr auto GEMM_KC{ 256ULL };
+	constexpr auto GEMM_NC{ 2048ULL };
+	constexpr auto GEMM_PARALLEL_MIN{ 1ULL << 21ULL }; // m * n * k
+
+	// A[mc×kc]打包为ap[mc / MR][kc][MR]
+	void GemmPackA(Float64* ap, const Float64* a, Size lda, Size mc, Size kc) noexcept {
+		for (Index i{ }; i < mc; i += GEMM_MR) {
+			auto rows{ std::min(GEMM_MR, mc - i) };
+			for (Index p{ }; p < kc; ++p) {
+				for (Index r{ }; r < GEMM_MR; ++r) *ap++ = r < rows ? a[(i + r) * lda + p] : 0.0;
+			}
+		}
+	}
+
+	// B[kc×nc]打包为bp[nc / NR][kc][NR]
+	void GemmPackB(Float64* bp, const Float64* b, Size ldb, Size kc, Size nc) noexcept {
+		for (Index j{ }; j < nc; j += GEMM_NR) {
+			auto cols{ std::min(GEMM_NR, nc - j) };
+			for (Index p{ }; p < kc; ++p) {
+				auto src{ b + p * ldb + j };
+				for (Index c{ }; c < GEMM_NR; ++c) *bp++ = c < cols ? src[c] : 0.0;
+			}
+		}
+	}
+
+	// C[mr×nr] += alpha * ap * bp
+	void GemmMicro(Size kc, const Float64* ap, const Float64* bp, Float64* c, Size ldc, Size mr, Size nr, Float64 alpha) noexcept {
+		alignas(32) Float64 tile[GEMM_MR * GEMM_NR];
+#ifdef HY_MATRIX_AVX2
+		auto c00{ _mm256_setzero_pd() }, c01{ _mm256_setzero_pd() }, c10{ _mm256_setzero_pd() }, c11{ _mm256_setzero_pd() };
+		auto c20{ _mm256_setzero_pd() }, c21{ _mm256_setzero_pd() }, c30{ _mm256_setzero_pd() }, c31{ _mm256_setzero_pd() };
+		for (Index p{ }; p < kc; ++p, ap += GEMM_MR, bp += GEMM_NR) {
+			auto b0{ _mm256_loadu_pd(bp) }, b1{ _mm256_loadu_pd(bp + 4ULL) };
+			auto a0{ _mm256_broadcast_sd(ap) }, a1{ _mm256_broadcast_sd(ap + 1ULL) };
+			c00 = _mm256_fmadd_pd(a0, b0, c00);
+			c01 = _mm256_fmadd_pd(a0, b1, c01);
+			c10 = _mm256_fmadd_pd(a1, b0, c10);
+			c11 = _mm256_fmadd_pd(a1, b1, c11);
+			auto a2{ _mm256_broadcast_sd(ap + 2ULL) }, a3{ _mm256_broadcast_sd(ap + 3ULL) };
+			c20 = _mm256_fmadd_pd(a2, b0, c20);
+			c21 = _mm256_fmadd_pd(a2, b1, c21);
+			c30 = _mm256_fmadd_pd(a3, b0, c30);
+			c31 = _mm256_fmadd_pd(a3, b1, c31);
+		}
+		_mm256_store_pd(tile, c00);
+		_mm256_store_pd(tile + 4ULL, c01);
+		_mm256_store_pd(tile + 8ULL, c10);
+		_mm256_store_pd(tile + 12ULL, c11);
+		_mm256_store_pd(tile + 16ULL, c20);
+		_mm256_store_pd(tile + 20ULL, c21);
+		_mm256_store_pd(tile + 24ULL, c30);
+		_mm256_store_pd(tile + 28ULL, c31);
+#else
+		for (auto& x : tile) x = 0.0;
+		for (Index p{ }; p < kc; ++p, ap += GEMM_MR, bp += GEMM_NR) {
+			for (Index i{ }; i < GEMM_MR; ++i) {
+				auto av{ ap[i] };
+				for (Index j{ }; j < GEMM_NR; ++j) tile[i * GEMM_NR + j] += av * bp[j];
+			}
+		}
+#endif
+		for (Index i{ }; i < mr; ++i) {
+			for (Index j{ }; j < nr; ++j) c[i * ldc + j] += alpha * tile[i * GEMM_NR + j];
+		}
+	}
+
+	// 计算C的[rowBegin, rowEnd)行
+	void GemmRows(const Float64* a, Size lda, const Float64* b, Size ldb, Float64* c, Size ldc,
+		Size n, Size k, Float64 alpha, Index rowBegin, Index rowEnd) noexcept {
+		Vector<Float64> ap(GEMM_MC * GEMM_KC);
+		Vector<Float64> bp(GEMM_KC * ((std::min(GEMM_NC, n) + GEMM_NR - 1ULL) / GEMM_NR * GEMM_NR));
+		for (Index jc{ }; jc < n; jc += GEMM_NC) {
+			auto nc{ std::min(GEMM_NC, n - jc) };
+			for (Index pc{ }; pc < k; pc += GEMM_KC) {
+				auto kc{ std::min(GEMM_KC, k - pc) };
+				GemmPackB(bp.data(), b + pc * ldb + jc, ldb, kc, nc);
+				for (Index ic{ rowBegin }; ic < rowEnd; ic += GEMM_MC) {
+					auto mc{ std::min(GEMM_MC, rowEnd - ic) };
+					GemmPackA(ap.data(), a + ic * lda + pc, lda, mc, kc);
+					for (Index jr{ }; jr < nc; jr += GEMM_NR) {
+						for (Index ir{ }; ir < mc; ir += GEMM_MR) {
+							GemmMicro(kc, ap.data() + ir * kc, bp.data() + jr * kc, c + (ic + ir) * ldc + jc + jr, ldc,
+								std::min(GEMM_MR, mc - ir), std::min(GEMM_NR, nc - jr), alpha);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// C[m×n] = alpha * A[m×k] * B[k×n], accumulate为真时累加到C上
+	// lda, ldb, ldc为各自的行跨度, C不可与A或B重叠
+	void Gemm(const Float64* a, Size lda, const Float64* b, Size ldb, Float64* c, Size ldc,
+		Size m, Size n, Size k, Float64 alpha, bool accumulate) noexcept {
+		if (!accumulate) {
+			for (Index i{ }; i < m; ++i) std::fill_n(c + i * ldc, n, 0.0);
+		}
+		if (m == 0ULL || n == 0ULL || k == 0ULL) return;
+		Size threads{ 1ULL };
+		if (m * n * k >= GEMM_PARALLEL_MIN) {
+			threads = std::thread::hardware_concurrency();
+			threads = std::clamp(std::min(threads, m / GEMM_MR), 1ULL, 64ULL);
+		}
+		if (threads == 1ULL) {
+			GemmRows(a, lda, b, ldb, c, ldc, n, k, alpha, 0ULL, m);
+			return;
+		}
+		Vector<std::thread> workers;
+		workers.reserve(threads);
+		for (Index i{ }; i < threads; ++i) {
+			auto rowBegin{ m * i / threads / GEMM_MR * GEMM_MR };
+			auto rowEnd{ i + 1ULL == threads ? m : m * (i + 1ULL) / threads / GEMM_MR * GEMM_MR };
+			workers.emplace_back([=] { GemmRows(a, lda, b, ldb, c, ldc, n, k, alpha, rowBegin, rowEnd); });
+		}
+		for (auto& worker : workers) worker.join();
+	}
+
+	// 点积, 4路累加
+	Float64 RowDot(const Float64* x, const Float64* y, Size n) noexcept {
+		Index i{ };
+#ifdef HY_MATRIX_AVX2
+		auto s0{ _mm256_setzero_pd() }, s1{ _mm256_setzero_pd() };
+		for (; i + 8ULL <= n; i += 8ULL) {
+			s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+			s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4ULL), _mm256_loadu_pd(y + i + 4ULL), s1);
+		}
+		alignas(32) Float64 s[4];
+		_mm256_store_pd(s, _mm256_add_pd(s0, s1));
+#else
+		Float64 s[4]{ };
+#endif
+		for (; i + 4ULL <= n; i += 4ULL) {
+			s[0] += x[i] * y[i];
+			s[1] += x[i + 1ULL] * y[i + 1ULL];
+			s[2] += x[i + 2ULL] * y[i + 2ULL];
+			s[3] += x[i + 3ULL] * y[i + 3ULL];
+		}
+		for (; i < n; ++i) s[0] += x[i] * y[i];
+		return (s[0] + s[1]) + (s[2] + s[3]);
+	}
+
+	// y[m] = A[m×n] * x[n]
+	void Gemv(const Float64* a, const Float64* x, Float64* y, Size m, Size n) noexcept {
+		for (Index i{ }; i < m; ++i) y[i] = RowDot(a + i * n, x, n);
+	}
+
+	// B[n×m] = A[m×n]ᵀ, 按32×32分块以保持两侧的缓存局部性
+	void Transpose(const Float64* a, Float64* b, Size m, Size n) noexcept {
+		constexpr auto BLOCK{ 32ULL };
+		for (Index i0{ }; i0 < m; i0 += BLOCK) {
+			auto i1{ std::min(i0 + BLOCK, m) };
+			for (Index j0{ }; j0 < n; j0 += BLOCK) {
+				auto j1{ std::min(j0 + BLOCK, n) };
+				for (auto i{ i0 }; i < i1; ++i) {
+					for (auto j{ j0 }; j < j1; ++j) b[j * m + i] = a[i * n + j];
+				}
+			}
+		}
+	}
+
+	// 逐元素运算, scalar为真时b指向单个标量, dst可与a相同
+	template<bool scalar>
+	void MatrixCalc(Float64* dst, const Float64* a, const Float64* b, Size n, BOPTType opt) noexcept {
+		auto at{ [b](Index i) noexcept {
+			if constexpr (scalar) return *b;
+			else return b[i];
+		} };
+		switch (opt) {
+		case BOPTType::ADD: for (Index i{ }; i < n; ++i) dst[i] = a[i] + at(i); break;
+		case BOPTType::SUBTRACT: for (Index i{ }; i < n; ++i) dst[i] = a[i] - at(i); break;
+		case BOPTType::MULTIPLE: for (Index i{ }; i < n; ++i) dst[i] = a[i] * at(i); break;
+		case BOPTType::DIVIDE: for (Index i{ }; i < n; ++i) dst[i] = a[i] / at(i); break;
+		}
+	}
+
+	/*
+	矩阵分解
+	LU: 部分选主元的右视分块算法, 面板内逐列消元, 尾部子矩阵以Gemm整块更新
+	Cholesky: 按行计算, 内积均为连续的行向量
+	QR: Householder变换, 反射作用于尾部子矩阵时按行扫描
+	秩: 列选主元的QR, 对角元不超过阈值时视为0
+	*/
+	constexpr auto LU_BLOCK{ 64ULL };
+
+	// n×n的A被单位下三角L(不含对角)与上三角U覆盖, 满足P * A = L * U, perm[i]为U的第i行在A中的行号
+	// 返回置换的符号
+	Float64 LUDecompose(Float64* a, Index* perm, Size n) noexcept {
+		Float64 sign{ 1.0 };
+		for (Index i{ }; i < n; ++i) perm[i] = i;
+		for (Index k0{ }; k0 < n; k0 += LU_BLOCK) {
+			auto k1{ std::min(k0 + LU_BLOCK, n) };
+			for (auto j{ k0 }; j < k1; ++j) {
+				auto p{ j };
+				for (auto i{ j + 1ULL }; i < n; ++i) {
+					if (::fabs(a[i * n + j]) > ::fabs(a[p * n + j])) p = i;
+				}
+				if (p != j) {
+					std::swap_ranges(a + p * n, a + p * n + n, a + j * n);
+					std::swap(perm[p], perm[j]);
+					sign = -sign;
+				}
+				auto pivot{ a[j * n + j] };
+				if (pivot == 0.0) continue;
+				auto rowJ{ a + j * n };
+				for (auto i{ j + 1ULL }; i < n; ++i) {
+					auto rowI{ a + i * n };
+					auto l{ rowI[j] /= pivot };
+					for (auto c{ j + 1ULL }; c < k1; ++c) rowI[c] -= l * rowJ[c];
+				}
+			}
+			if (k1 == n) break;
+			for (auto j{ k0 }; j < k1; ++j) { // U12 = L11⁻¹ * A12
+				auto rowJ{ a + j * n };
+				for (auto i{ j + 1ULL }; i < k1; ++i) {
+					auto rowI{ a + i * n };
+					auto l{ rowI[j] };
+					for (auto c{ k1 }; c < n; ++c) rowI[c] -= l * rowJ[c];
+				}
+			}
+			// A22 -= L21 * U12
+			Gemm(a + k1 * n + k0, n, a + k0 * n + k1, n, a + k1 * n + k1, n, n - k1, n - k1, k1 - k0, -1.0, true);
+		}
+		return sign;
+	}
+
+	// 以LU分解结果求解A * X = B, B为n×r矩阵, 结果写入x
+	void LUSolve(const Float64* lu, const Index* perm, const Float64* b, Float64* x, Size n, Size r) noexcept {
+		for (Index i{ }; i < n; ++i) freestanding::copy_n(x + i * r, b + perm[i] * r, r);
+		for (Index i{ }; i < n; ++i) {
+			auto rowX{ x + i * r };
+			for (Index j{ }; j < i; ++j) {
+				auto l{ lu[i * n + j] };
+				auto rowJ{ x + j * r };
+				for (Index c{ }; c < r; ++c) rowX[c] -= l * rowJ[c];
+			}
+		}
+		for (auto i{ n }; i-- > 0ULL; ) {
+			auto rowX{ x + i * r };
+			for (auto j{ i + 1ULL }; j < n; ++j) {
+				auto u{ lu[i * n + j] };
+				auto rowJ{ x + j * r };
+				for (Index c{ }; c < r; ++c) rowX[c] -= u * rowJ[c];
+			}
+			auto pivot{ lu[i * n + i] };
+			for (Index c{ }; c < r; ++c) rowX[c] /= pivot;
+		}
+	}
+
+	bool LUSingular(const Float64* lu, Size n) noexcept {
+		for (Index i{ }; i < n; ++i) {
+			if (lu[i * n + i] == 0.0) return true;
+		}
+		return false;
+	}
+
+	// A = L * Lᵀ, l为n×n的下三角, A非正定时返回假
+	bool Cholesky(const Float64* a, Float64* l, Size n) noexcept {
+		std::fill_n(l, n * n, 0.0);
+		for (Index i{ }; i < n; ++i) {
+			auto rowI{ l + i * n };
+			for (Index j{ }; j <= i; ++j) {
+				auto rowJ{ l + j * n };
+				auto s{ a[i * n + j] - RowDot(rowI, rowJ, j) };
+				if (i == j) {
+					if (!(s > 0.0)) return false;
+					rowI[i] = ::sqrt(s);
+				}
+				else rowI[j] = s / rowJ[j];
+			}
+		}
+		return true;
+	}
+
+	// 对rows×cols(行跨度ld)的矩阵左乘 I - beta * v * vᵀ
+	void HouseholderApply(const Float64* v, Float64 beta, Float64* a, Size ld, Size rows, Size cols, Float64* w) noexcept {
+		std::fill_n(w, cols, 0.0);
+		for (Index i{ }; i < rows; ++i) {
+			auto vi{ v[i] };
+			auto row{ a + i * ld };
+			for (Index c{ }; c < cols; ++c) w[c] += vi * row[c];
+		}
+		for (Index i{ }; i < rows; ++i) {
+			auto f{ beta * v[i] };
+			auto row{ a + i * ld };
+			for (Index c{ }; c < cols; ++c) row[c] -= f * w[c];
+		}
+	}
+
+	// A = Q * R, A为m×n, k = min(m, n), Q为m×k的列正交矩阵, R为k×n的上三角
+	void QRDecompose(const Float64* a, Float64* q, Float64* r, Size m, Size n) noexcept {
+		auto k{ std::min(m, n) };
+		Vector<Float64> work(a, a + m * n), vs(m * k), betas(k), w(std::max(m, n));
+		for (Index j{ }; j < k; ++j) {
+			auto v{ vs.data() + j * m };
+			auto len{ m - j };
+			Float64 norm{ };
+			for (Index i{ }; i < len; ++i) {
+				v[i] = work[(j + i) * n + j];
+				norm += v[i] * v[i];
+			}
+			norm = ::sqrt(norm);
+			auto alpha{ v[0] >= 0.0 ? -norm : norm };
+			v[0] -= alpha;
+			Float64 vnorm{ };
+			for (Index i{ }; i < len; ++i) vnorm += v[i] * v[i];
+			betas[j] = vnorm == 0.0 ? 0.0 : 2.0 / vnorm;
+			if (betas[j] != 0.0) HouseholderApply(v, betas[j], work.data() + j * n + j, n, len, n - j, w.data());
+		}
+		for (Index i{ }; i < k; ++i) {
+			for (Index c{ }; c < n; ++c) r[i * n + c] = c < i ? 0.0 : work[i * n + c];
+		}
+		std::fill_n(q, m * k, 0.0);
+		for (Index i{ }; i < k; ++i) q[i * k + i] = 1.0;
+		for (auto j{ k }; j-- > 0ULL; ) {
+			if (betas[j] != 0.0) HouseholderApply(vs.data() + j * m, betas[j], q + j * k + j, k, m - j, k - j, w.data());
+		}
+	}
+
+	// 列选主元的Householder QR, |R[j][j]|不超过max(m, n) * eps * |R[0][0]|时视为0
+	Size Rank(const Float64* a, Size m, Size n) noexcept {
+		auto k{ std::min(m, n) };
+		Vector<Float64> work(a, a + m * n), norms(n), v(m), w(n);
+		Float64 tol{ };
+		Size rank{ };
+		for (Index j{ }; j < k; ++j) {
+			std::fill(norms.begin() + j, norms.end(), 0.0);
+			for (auto i{ j }; i < m; ++i) {
+				auto row{ work.data() + i * n };
+				for (auto c{ j }; c < n; ++c) norms[c] += row[c] * row[c];
+			}
+			auto p{ static_cast<Index>(std::max_element(norms.begin() + j, norms.end()) - norms.begin()) };
+			auto norm{ ::sqrt(norms[p]) };
+			if (j == 0ULL) tol = norm * static_cast<Float64>(std::max(m, n)) * std::numeric_limits<Float64>::epsilon();
+			if (norm <= tol) break;
+			if (p != j) {
+				for (Index i{ }; i < m; ++i) std::swap(work[i * n + p], work[i * n + j]);
+			}
+			auto len{ m - j };
+			for (Index i{ }; i < len; ++i) v[i] = work[(j + i) * n + j];
+			v[0] -= v[0] >= 0.0 ? -norm : norm;
+			Float64 vnorm{ };
+			for (Index i{ }; i < len; ++i) vnorm += v[i] * v[i];
+			if (vnorm != 0.0) HouseholderApply(v.data(), 2.0 / vnorm, work.data() + j * n + j, n, len, n - j, w.data());
+			++rank;
+		}
+		return rank;
+	}
+}
+
+namespace hy::impl {
+	LIB_EXPORT void Matrix_Transpose(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		Size sizeData[] { static_cast<Size>(mobj->col), static_cast<Size>(mobj->row) };
+		auto ret{ obj_allocate<MatrixObject>(thisObject->type, nullptr, sizeData) };
+		details::Transpose(mobj->data.data(), ret->data.data(), mobj->row, mobj->col);
+		vm->objectStack.push_link(ret);
+	}
+
+	// 非方阵时设置错误并返回假
+	bool Matrix_CheckSquare(VM* vm, MatrixObject* mobj) noexcept {
+		if (mobj->row == mobj->col) return true;
+		SetError_UnmatchedLen(vm, mobj->row, mobj->col);
+		return false;
+	}
+
+	MatrixObject* Matrix_New(TypeObject* type, Size row, Size col) noexcept {
+		Size sizeData[] { row, col };
+		return obj_allocate<MatrixObject>(type, nullptr, sizeData);
+	}
+
+	void Matrix_PushList(VM* vm, ObjArgsView items) noexcept {
+		auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
+		lobj->objects.reserve(items.size());
+		for (auto item : items) {
+			item->link();
+			lobj->objects.emplace_back(item);
+		}
+		vm->objectStack.push_link(lobj);
+	}
+
+	// 返回[L, U, P], 满足P * A = L * U
+	LIB_EXPORT void Matrix_LU(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		if (!Matrix_CheckSquare(vm, mobj)) return;
+		auto n{ static_cast<Size>(mobj->row) };
+		Vector<Float64> lu(mobj->data.data(), mobj->data.data() + n * n);
+		Vector<Index> perm(n);
+		details::LUDecompose(lu.data(), perm.data(), n);
+		auto l{ Matrix_New(thisObject->type, n, n) }, u{ Matrix_New(thisObject->type, n, n) }, p{ Matrix_New(thisObject->type, n, n) };
+		std::fill_n(p->data.data(), n * n, 0.0);
+		for (Index i{ }; i < n; ++i) {
+			for (Index j{ }; j < n; ++j) {
+				auto v{ lu[i * n + j] };
+				l->data[i * n + j] = j < i ? v : (j == i ? 1.0 : 0.0);
+				u->data[i * n + j] = j < i ? 0.0 : v;
+			}
+			p->data[i * n + perm[i]] = 1.0;
+		}
+		Object* items[] { l, u, p };
+		Matrix_PushList(vm, ObjArgsView{ items, 3ULL });
+	}
+
+	// 返回下三角L, 满足A = L * Lᵀ, A非正定时返回null
+	LIB_EXPORT void Matrix_Cholesky(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		if (!Matrix_CheckSquare(vm, mobj)) return;
+		auto n{ static_cast<Size>(mobj->row) };
+		auto l{ Matrix_New(thisObject->type, n, n) };
+		if (details::Cholesky(mobj->data.data(), l->data.data(), n)) vm->objectStack.push_link(l);
+		else {
+			l->type->f_deallocate(l);
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+		}
+	}
+
+	// 返回[Q, R], 满足A = Q * R
+	LIB_EXPORT void Matrix_QR(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		auto m{ static_cast<Size>(mobj->row) }, n{ static_cast<Size>(mobj->col) }, k{ std::min(m, n) };
+		auto q{ Matrix_New(thisObject->type, m, k) }, r{ Matrix_New(thisObject->type, k, n) };
+		if (k) details::QRDecompose(mobj->data.data(), q->data.data(), r->data.data(), m, n);
+		Object* items[] { q, r };
+		Matrix_PushList(vm, ObjArgsView{ items, 2ULL });
+	}
+
+	// 求解A * x = b, b为向量或矩阵, A奇异时返回null
+	LIB_EXPORT void Matrix_Solve(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		auto arg{ args[0] };
+		const Float64* b;
+		Size rows, cols;
+		if (arg->type->v_id == TypeId::Vector) {
+			auto& vec{ obj_cast<VectorObject>(arg)->value() };
+			b = vec.data();
+			rows = vec.size();
+			cols = 1ULL;
+		}
+		else if (arg->type->v_id == TypeId::Matrix) {
+			auto bobj{ obj_cast<MatrixObject>(arg) };
+			b = bobj->data.data();
+			rows = bobj->row;
+			cols = bobj->col;
+		}
+		else {
+			SetError_UnmatchedCall(vm, u"matrix::solve", args);
+			return;
+		}
+		if (!Matrix_CheckSquare(vm, mobj)) return;
+		auto n{ static_cast<Size>(mobj->row) };
+		if (rows != n) {
+			SetError_UnmatchedLen(vm, n, rows);
+			return;
+		}
+		Vector<Float64> lu(mobj->data.data(), mobj->data.data() + n * n);
+		Vector<Index> perm(n);
+		details::LUDecompose(lu.data(), perm.data(), n);
+		if (details::LUSingular(lu.data(), n)) {
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+			return;
+		}
+		Object* ret;
+		Float64* x;
+		if (arg->type->v_id == TypeId::Vector) {
+			auto vobj{ obj_allocate<VectorObject>(arg->type, nullptr, arg_cast(n)) };
+			ret = vobj;
+			x = vobj->data.data();
+		}
+		else {
+			auto xobj{ Matrix_New(arg->type, n, cols) };
+			ret = xobj;
+			x = xobj->data.data();
+		}
+		if (n) details::LUSolve(lu.data(), perm.data(), b, x, n, cols);
+		vm->objectStack.push_link(ret);
+	}
+
+	// 逆矩阵, 奇异时返回null
+	LIB_EXPORT void Matrix_Inv(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		if (!Matrix_CheckSquare(vm, mobj)) return;
+		auto n{ static_cast<Size>(mobj->row) };
+		Vector<Float64> lu(mobj->data.data(), mobj->data.data() + n * n);
+		Vector<Index> perm(n);
+		details::LUDecompose(lu.data(), perm.data(), n);
+		if (details::LUSingular(lu.data(), n)) {
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+			return;
+		}
+		Vector<Float64> identity(n * n);
+		for (Index i{ }; i < n; ++i) identity[i * n + i] = 1.0;
+		auto ret{ Matrix_New(thisObject->type, n, n) };
+		if (n) details::LUSolve(lu.data(), perm.data(), identity.data(), ret->data.data(), n, n);
+		vm->objectStack.push_link(ret);
+	}
+
+	LIB_EXPORT void Matrix_Det(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		if (!Matrix_CheckSquare(vm, mobj)) return;
+		auto n{ static_cast<Size>(mobj->row) };
+		Vector<Float64> lu(mobj->data.data(), mobj->data.data() + n * n);
+		Vector<Index> perm(n);
+		auto det{ details::LUDecompose(lu.data(), perm.data(), n) };
+		for (Index i{ }; i < n; ++i) det *= lu[i * n + i];
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(det)));
+	}
+
+	LIB_EXPORT void Matrix_Rank(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(thisObject) };
+		auto rank{ details::Rank(mobj->data.data(), mobj->row, mobj->col) };
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(static_cast<Int64>(rank))));
+	}
+}
+
 namespace hy {
 	struct MatrixStaticData {
 		Vector<MatrixObject*> pool;
+		FunctionTable ft;
+
+		MatrixStaticData(TypeObject* type) noexcept {
+			auto funcType{ type->__getType(TypeId::Function) };
+
+			Object* __any[] { nullptr };
+			ObjArgsView empty, any1{ __any, 1ULL };
+
+			ft.try_emplace(u"transpose", MakeNative<true, true>(funcType, u"matrix::transpose", &impl::Matrix_Transpose, empty));
+			ft.try_emplace(u"lu", MakeNative<true, true>(funcType, u"matrix::lu", &impl::Matrix_LU, empty));
+			ft.try_emplace(u"cholesky", MakeNative<true, true>(funcType, u"matrix::cholesky", &impl::Matrix_Cholesky, empty));
+			ft.try_emplace(u"qr", MakeNative<true, true>(funcType, u"matrix::qr", &impl::Matrix_QR, empty));
+			ft.try_emplace(u"solve", MakeNative<true, true>(funcType, u"matrix::solve", &impl::Matrix_Solve, any1));
+			ft.try_emplace(u"inv", MakeNative<true, true>(funcType, u"matrix::inv", &impl::Matrix_Inv, empty));
+			ft.try_emplace(u"det", MakeNative<true, true>(funcType, u"matrix::det", &impl::Matrix_Det, empty));
+			ft.try_emplace(u"rank", MakeNative<true, true>(funcType, u"matrix::rank", &impl::Matrix_Rank, empty));
+		}
 	};
 
 	void f_class_create_matrix(TypeObject* type) noexcept {
-		type->v_static = new MatrixStaticData;
+		type->v_static = new MatrixStaticData(type);
 	}
 
 	void f_class_delete_matrix(TypeObject* type) noexcept {
 		auto staticData{ static_cast<MatrixStaticData*>(type->v_static) };
 		for (auto obj : staticData->pool) delete obj;
+		for (auto& [_, fobj] : staticData->ft) delete fobj;
 		delete staticData;
 	}
 
@@ -100,6 +660,8 @@ namespace hy {
 			auto intType{ vm->getType(TypeId::Int) };
 			if (member == u"row") ost.push_link(obj_allocate(intType, arg_cast(static_cast<Int64>(mobj->row))));
 			else if (member == u"col") ost.push_link(obj_allocate(intType, arg_cast(static_cast<Int64>(mobj->col))));
+			else if (auto pFobj{ static_cast<MatrixStaticData*>(obj->type->v_static)->ft.get(member) })
+				ost.push_link(obj_allocate(vm->getType(TypeId::MemberFunction), *pFobj, obj));
 			else return SetError(&SetError_UnmatchedMember, vm, obj->type, member);
 			return IResult<void>(true);
 		}
@@ -109,18 +671,75 @@ namespace hy {
 	constexpr auto MATRIX_LVID_ROW_ELEM{ 0ULL };
 	constexpr auto MATRIX_LVID_ELEM{ 1ULL };
 
+	// m[i]为第i行的向量, m[i, j]为第i行第j列的元素, 下标均从1开始
 	IResult<void> f_index_matrix(HVM hvm, bool isLV, Object* obj, ObjArgsView args) noexcept {
 		auto vm{ vm_cast(hvm) };
+		auto mobj{ obj_cast<MatrixObject>(obj) };
+		auto argc{ args.size() };
+		if ((argc == 1ULL || argc == 2ULL) && args[0]->type->v_id == TypeId::Int &&
+			(argc == 1ULL || args[1]->type->v_id == TypeId::Int)) {
+			auto row{ obj_cast<IntObject>(args[0])->value };
+			if (row <= 0LL || row > static_cast<Int64>(mobj->row)) {
+				SetError_IndexOutOfRange(vm, row, static_cast<Int64>(mobj->row));
+				return IResult<void>();
+			}
+			auto actualRow{ static_cast<Index>(row - 1) };
+			if (argc == 1ULL) {
+				if (isLV) {
+					auto ret{ obj_allocate<LVObject>(vm->getType(TypeId::LV)) };
+					ret->parent = obj;
+					ret->parent->link();
+					ret->setData<MATRIX_LVID_ROW_ELEM>(actualRow);
+					vm->objectStack.push_link(ret);
+				}
+				else vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Vector),
+					arg_cast(mobj->data.data() + actualRow * mobj->col), arg_cast(static_cast<Size>(mobj->col))));
+				return IResult<void>(true);
+			}
+			auto col{ obj_cast<IntObject>(args[1])->value };
+			if (col <= 0LL || col > static_cast<Int64>(mobj->col)) {
+				SetError_IndexOutOfRange(vm, col, static_cast<Int64>(mobj->col));
+				return IResult<void>();
+			}
+			auto actualIndex{ actualRow * mobj->col + static_cast<Index>(col - 1) };
+			if (isLV) {
+				auto ret{ obj_allocate<LVObject>(vm->getType(TypeId::LV)) };
+				ret->parent = obj;
+				ret->parent->link();
+				ret->setData<MATRIX_LVID_ELEM>(actualIndex);
+				vm->objectStack.push_link(ret);
+			}
+			else vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(mobj->data[actualIndex])));
+			return IResult<void>(true);
+		}
 		SetError_UnmatchedIndex(vm, obj->type->v_name, args);
 		return IResult<void>();
 	}
 
+	// matrix(): 空矩阵
+	// matrix(row, col): 全0矩阵
+	// matrix(row, col, value): 以value填充的矩阵
 	IResult<void> f_construct_matrix(HVM hvm, TypeObject* type, ObjArgsView args) noexcept {
 		auto vm{ vm_cast(hvm) };
-		if (auto argc{ args.size() }; argc == 0ULL) {
+		auto argc{ args.size() };
+		if (argc == 0ULL) {
 			vm->objectStack.push_link(obj_allocate(type));
 			return IResult<void>(true);
 		}
+		else if (argc == 2ULL || argc == 3ULL) {
+			if (args[0]->type->v_id == TypeId::Int && args[1]->type->v_id == TypeId::Int &&
+				(argc == 2ULL || args[2]->type->f_float)) {
+				auto row{ obj_cast<IntObject>(args[0])->value }, col{ obj_cast<IntObject>(args[1])->value };
+				if (row < 0LL) return SetError(&SetError_NegativeNumber, vm, row);
+				if (col < 0LL) return SetError(&SetError_NegativeNumber, vm, col);
+				auto value{ argc == 3ULL ? args[2]->type->f_float(args[2]) : 0.0 };
+				Size sizeData[] { static_cast<Size>(row), static_cast<Size>(col) };
+				auto mobj{ obj_allocate<MatrixObject>(type, nullptr, sizeData) };
+				std::fill_n(mobj->data.data(), mobj->data.size(), value);
+				vm->objectStack.push_link(mobj);
+				return IResult<void>(true);
+			}
+		}
 		return SetError(&SetError_UnmatchedCall, vm, type->v_name, args);
 	}
 
@@ -129,6 +748,164 @@ namespace hy {
 		Size sizeData[] { static_cast<Size>(mobj->row), static_cast<Size>(mobj->col) };
 		return obj_allocate(obj->type, arg_cast(mobj->data.data()), sizeData);
 	}
+
+	// 矩阵 ± 矩阵, 矩阵 * 矩阵, 矩阵 * 向量, 矩阵与标量的四则运算
+	// 返回新分配的结果对象, 引用次数为0
+	IResult<Object*> Matrix_Calc(VM* vm, MatrixObject* mobj1, Object* obj2, BOPTType opt) noexcept {
+		auto size1{ mobj1->data.size() };
+		Size sizeData[] { static_cast<Size>(mobj1->row), static_cast<Size>(mobj1->col) };
+		switch (obj2->type->v_id) {
+		case TypeId::Matrix: {
+			auto mobj2{ obj_cast<MatrixObject>(obj2) };
+			if (opt == BOPTType::MULTIPLE) {
+				if (mobj1->col != mobj2->row) return SetError<Object*>(&SetError_UnmatchedLen, vm, mobj1->col, mobj2->row);
+				sizeData[1] = static_cast<Size>(mobj2->col);
+				auto ret{ obj_allocate<MatrixObject>(mobj1->type, nullptr, sizeData) };
+				impl::details::Gemm(mobj1->data.data(), mobj1->col, mobj2->data.data(), mobj2->col, ret->data.data(), mobj2->col,
+					mobj1->row, mobj2->col, mobj1->col, 1.0, false);
+				return IResult<Object*>(ret);
+			}
+			else if (opt == BOPTType::ADD || opt == BOPTType::SUBTRACT) {
+				if (mobj1->row != mobj2->row) return SetError<Object*>(&SetError_UnmatchedLen, vm, mobj1->row, mobj2->row);
+				if (mobj1->col != mobj2->col) return SetError<Object*>(&SetError_UnmatchedLen, vm, mobj1->col, mobj2->col);
+				auto ret{ obj_allocate<MatrixObject>(mobj1->type, nullptr, sizeData) };
+				impl::details::MatrixCalc<false>(ret->data.data(), mobj1->data.data(), mobj2->data.data(), size1, opt);
+				return IResult<Object*>(ret);
+			}
+			break;
+		}
+		case TypeId::Vector: {
+			auto& vec{ obj_cast<VectorObject>(obj2)->value() };
+			if (opt == BOPTType::MULTIPLE) {
+				if (mobj1->col != vec.size()) return SetError<Object*>(&SetError_UnmatchedLen, vm, mobj1->col, vec.size());
+				auto ret{ obj_allocate<VectorObject>(obj2->type, nullptr, arg_cast(static_cast<Size>(mobj1->row))) };
+				impl::details::Gemv(mobj1->data.data(), vec.data(), ret->data.data(), mobj1->row, mobj1->col);
+				return IResult<Object*>(ret);
+			}
+			break;
+		}
+		default: {
+			if (obj2->type->f_float && opt != BOPTType::MOD && opt != BOPTType::POWER) {
+				auto value{ obj2->type->f_float(obj2) };
+				auto ret{ obj_allocate<MatrixObject>(mobj1->type, nullptr, sizeData) };
+				impl::details::MatrixCalc<true>(ret->data.data(), mobj1->data.data(), &value, size1, opt);
+				return IResult<Object*>(ret);
+			}
+			break;
+		}
+		}
+		return SetError<Object*>(&SetError_UnsupportedBOPT, vm, mobj1->type, obj2->type, opt);
+	}
+
+	IResult<void> f_calcassign_matrix(HVM hvm, LVObject* lv, Object* obj2, AssignType opt) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj1{ lv->getAddressObject<MatrixObject>() };
+		BOPTType bopt;
+		switch (opt) {
+		case AssignType::ADD_ASSIGN: bopt = BOPTType::ADD; break;
+		case AssignType::SUBTRACT_ASSIGN: bopt = BOPTType::SUBTRACT; break;
+		case AssignType::MULTIPLE_ASSIGN: bopt = BOPTType::MULTIPLE; break;
+		case AssignType::DIVIDE_ASSIGN: bopt = BOPTType::DIVIDE; break;
+		default: return SetError(&SetError_IncompatibleCalcAssign, vm, mobj1->type, obj2->type, opt);
+		}
+		auto size{ mobj1->data.size() };
+		if (obj2->type->v_id == TypeId::Matrix && bopt != BOPTType::MULTIPLE) { // 逐元素运算原地进行
+			auto mobj2{ obj_cast<MatrixObject>(obj2) };
+			if (bopt == BOPTType::DIVIDE) return SetError(&SetError_IncompatibleCalcAssign, vm, mobj1->type, obj2->type, opt);
+			if (mobj1->row != mobj2->row) return SetError(&SetError_UnmatchedLen, vm, mobj1->row, mobj2->row);
+			if (mobj1->col != mobj2->col) return SetError(&SetError_UnmatchedLen, vm, mobj1->col, mobj2->col);
+			impl::details::MatrixCalc<false>(mobj1->data.data(), mobj1->data.data(), mobj2->data.data(), size, bopt);
+			return IResult<void>(true);
+		}
+		else if (obj2->type->v_id != TypeId::Matrix && obj2->type->v_id != TypeId::Vector && obj2->type->f_float) {
+			auto value{ obj2->type->f_float(obj2) };
+			impl::details::MatrixCalc<true>(mobj1->data.data(), mobj1->data.data(), &value, size, bopt);
+			return IResult<void>(true);
+		}
+		else if (obj2->type->v_id == TypeId::Matrix) { // 矩阵乘法结果与原矩阵交换存储
+			auto ret{ Matrix_Calc(vm, mobj1, obj2, bopt) };
+			if (!ret.ok) return IResult<void>();
+			auto mret{ obj_cast<MatrixObject>(ret.data) };
+			std::swap(mobj1->data, mret->data);
+			std::swap(mobj1->col, mret->col);
+			std::swap(mobj1->row, mret->row);
+			mret->type->f_deallocate(mret);
+			return IResult<void>(true);
+		}
+		return SetError(&SetError_IncompatibleCalcAssign, vm, mobj1->type, obj2->type, opt);
+	}
+
+	IResult<void> f_assign_lv_data_matrix(HVM hvm, LVObject* lv, Object* obj) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ lv->getParent<MatrixObject>() };
+		if (lv->dataId() == MATRIX_LVID_ELEM) {
+			if (obj->type->f_float) {
+				mobj->data[lv->getData<0ULL, Index>()] = obj->type->f_float(obj);
+				return IResult<void>(true);
+			}
+			return SetError(&SetError_IncompatibleAssign, vm, vm->getType(TypeId::Float), obj->type);
+		}
+		else {
+			if (obj->type->v_id == TypeId::Vector) {
+				auto& vec{ obj_cast<VectorObject>(obj)->value() };
+				if (vec.size() != mobj->col) return SetError(&SetError_UnmatchedLen, vm, mobj->col, vec.size());
+				freestanding::copy_n(mobj->data.data() + lv->getData<0ULL, Index>() * mobj->col, vec.data(), vec.size());
+				return IResult<void>(true);
+			}
+			return SetError(&SetError_IncompatibleAssign, vm, vm->getType(TypeId::Vector), obj->type);
+		}
+	}
+
+	IResult<void> f_calcassign_lv_data_matrix(HVM hvm, LVObject* lv, Object* obj, AssignType opt) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto mobj{ lv->getParent<MatrixObject>() };
+		BOPTType bopt;
+		switch (opt) {
+		case AssignType::ADD_ASSIGN: bopt = BOPTType::ADD; break;
+		case AssignType::SUBTRACT_ASSIGN: bopt = BOPTType::SUBTRACT; break;
+		case AssignType::MULTIPLE_ASSIGN: bopt = BOPTType::MULTIPLE; break;
+		case AssignType::DIVIDE_ASSIGN: bopt = BOPTType::DIVIDE; break;
+		default: return SetError(&SetError_IncompatibleCalcAssign, vm, vm->getType(TypeId::Float), obj->type, opt);
+		}
+		Float64* dst;
+		Size size;
+		if (lv->dataId() == MATRIX_LVID_ELEM) {
+			dst = mobj->data.data() + lv->getData<0ULL, Index>();
+			size = 1ULL;
+		}
+		else {
+			dst = mobj->data.data() + lv->getData<0ULL, Index>() * mobj->col;
+			size = mobj->col;
+			if (obj->type->v_id == TypeId::Vector) { // 行与向量逐元素运算
+				auto& vec{ obj_cast<VectorObject>(obj)->value() };
+				if (vec.size() != size) return SetError(&SetError_UnmatchedLen, vm, size, vec.size());
+				impl::details::MatrixCalc<false>(dst, dst, vec.data(), size, bopt);
+				return IResult<void>(true);
+			}
+		}
+		if (obj->type->f_float) {
+			auto value{ obj->type->f_float(obj) };
+			impl::details::MatrixCalc<true>(dst, dst, &value, size, bopt);
+			return IResult<void>(true);
+		}
+		return SetError(&SetError_IncompatibleCalcAssign, vm, vm->getType(TypeId::Float), obj->type, opt);
+	}
+
+	IResult<void> f_sopt_calc_matrix(HVM hvm, Object* obj, SOPTType) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto ret{ obj_cast<MatrixObject>(f_full_copy_matrix(obj)) };
+		for (auto& elem : ret->data) elem = -elem;
+		vm->objectStack.push_link(ret);
+		return IResult<void>(true);
+	}
+
+	IResult<void> f_bopt_calc_matrix(HVM hvm, Object* obj1, Object* obj2, BOPTType opt) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto ret{ Matrix_Calc(vm, obj_cast<MatrixObject>(obj1), obj2, opt) };
+		if (!ret.ok) return IResult<void>();
+		vm->objectStack.push_link(ret.data);
+		return IResult<void>(true);
+	}
 }
 
 namespace hy {
@@ -167,14 +944,14 @@ namespace hy {
 		type->f_copy = &f_full_copy_matrix;
 		type->f_write = nullptr;
 		type->f_scan = nullptr;
-		type->f_calcassign = nullptr;
+		type->f_calcassign = &f_calcassign_matrix;
 
-		type->f_assign_lv_data = nullptr;
-		type->f_calcassign_lv_data = nullptr;
+		type->f_assign_lv_data = &f_assign_lv_data_matrix;
+		type->f_calcassign_lv_data = &f_calcassign_lv_data_matrix;
 		type->f_free_lv_data = nullptr;
 
-		type->f_sopt_calc = nullptr;
-		type->f_bopt_calc = nullptr;
+		type->f_sopt_calc = &f_sopt_calc_matrix;
+		type->f_bopt_calc = &f_bopt_calc_matrix;
 		type->f_equal = &f_equal_ref;
 		type->f_compare = nullptr;
 
@@ -88,7 +88,7 @@ namespace hy {
 		if (!CallFunction(vm, fobj, ObjArgsView{ }, obj)) return IResult<void>();
 		if (!RunCallStack(vm, cstCount)) return IResult<void>();
 		auto ret{ obj_cast<StringObject>(vm->objectStack.pop_normal()) };
-		str->append(ret->value);
+		str->append(ret->view());
 		ret->unlink();
 		return IResult<void>(true);
 	}
@@ -360,7 +360,7 @@ namespace hy {
 		if (!CallFunction(vm, fobj, ObjArgsView{ args, 1ULL }, obj)) return IResult<void>();
 		if (!RunCallStack(vm, cstCount)) return IResult<void>();
 		auto ret{ obj_cast<ListObject>(vm->objectStack.pop_normal()) };
-		auto count{ ret->objects.size() };
+		auto count{ ret->size() };
 		if (argc == count) ret->type->f_unpack(vm, ret, argc);
 		else SetError_UnmatchedUnpack(vm, count, argc);
 		ret->unlink();
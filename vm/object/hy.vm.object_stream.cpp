@@ -0,0 +1,351 @@
+﻿#include "../hy.vm.impl.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace hy::impl {
+	constexpr auto STDIN_CHUNK_SIZE{ 0x10000ULL };
+
+	inline bool Stdin_IsBlank(Byte c) noexcept {
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+	}
+
+	// 丢弃已读字节后再读入一块, 返回是否读入了新的字节
+	bool Stdin_Fill(StandardDevice& device) noexcept {
+		if (device.inputEnd || !device.byteInputFunc) return false;
+		device.flush(); // 等待输入前写出缓冲中的提示
+		auto& buf{ device.inputBuffer };
+		if (device.inputPos) {
+			buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(device.inputPos));
+			device.inputPos = 0ULL;
+		}
+		auto size{ buf.size() };
+		buf.resize(size + STDIN_CHUNK_SIZE);
+		auto count{ device.byteInputFunc(buf.data() + size, STDIN_CHUNK_SIZE) };
+		buf.resize(size + count);
+		if (!count) device.inputEnd = true;
+		return count != 0ULL;
+	}
+
+	// 取下一行(不含行尾)在缓冲区中的字节范围, 输入结束且无剩余字节时返回false
+	// 返回的范围在下一次读入前有效
+	bool Stdin_Line(StandardDevice& device, const Byte*& line, Size& len) noexcept {
+		auto& buf{ device.inputBuffer };
+		Size scanned{ };
+		for (;;) {
+			auto begin{ buf.data() + device.inputPos };
+			auto avail{ buf.size() - device.inputPos };
+			if (scanned < avail) {
+				if (auto p{ static_cast<const Byte*>(std::memchr(begin + scanned, '\n', avail - scanned)) }) {
+					line = begin;
+					len = static_cast<Size>(p - begin);
+					device.inputPos += len + 1ULL;
+					break;
+				}
+			}
+			scanned = avail;
+			if (!Stdin_Fill(device)) {
+				if (!avail) return false;
+				line = buf.data() + device.inputPos;
+				len = avail;
+				device.inputPos += avail;
+				break;
+			}
+		}
+		if (len && line[len - 1ULL] == '\r') --len;
+		return true;
+	}
+
+	// 跳过空白后取下一个以空白分隔的词, 输入结束时返回false
+	bool Stdin_Token(StandardDevice& device, const char*& first, const char*& last) noexcept {
+		auto& buf{ device.inputBuffer };
+		for (;;) {
+			while (device.inputPos < buf.size() && Stdin_IsBlank(buf[device.inputPos])) ++device.inputPos;
+			if (device.inputPos < buf.size()) break;
+			if (!Stdin_Fill(device)) return false;
+		}
+		Size scanned{ };
+		for (;;) {
+			auto begin{ buf.data() + device.inputPos };
+			auto avail{ buf.size() - device.inputPos };
+			while (scanned < avail && !Stdin_IsBlank(begin[scanned])) ++scanned;
+			// 词未被缓冲区截断, 或已无更多输入
+			if (scanned < avail || !Stdin_Fill(device)) {
+				first = reinterpret_cast<const char*>(buf.data() + device.inputPos);
+				last = first + scanned;
+				device.inputPos += scanned;
+				return true;
+			}
+		}
+	}
+
+	// 解析前的预留数量, count来自脚本不可直接据此分配, 以缓冲区(至少一块)可容纳的数值个数为上限, 超出时由容器自行增长
+	inline Size Stdin_Reserve(const StandardDevice& device, Size count) noexcept {
+		auto avail{ device.inputBuffer.size() - device.inputPos };
+		if (avail < STDIN_CHUNK_SIZE) avail = STDIN_CHUNK_SIZE;
+		auto bound{ (avail >> 1ULL) + 1ULL }; // 每个数值至少1个字符与1个分隔符
+		return count < bound ? count : bound;
+	}
+
+	// 在缓冲区上直接解析至多count个以空白分隔的数值, 词不是合法数值时返回false
+	template<typename T>
+	bool Stdin_Parse(StandardDevice& device, Size count, Vector<T>& out) noexcept {
+		const char* first;
+		const char* last;
+		while (out.size() < count && Stdin_Token(device, first, last)) {
+			if (*first == '+') ++first;
+			T value{ };
+			if (auto [ptr, ec] { std::from_chars(first, last, value) }; ec != std::errc{ } || ptr != last) return false;
+			out.emplace_back(value);
+		}
+		return true;
+	}
+
+	bool Stdin_ReadLine(VM* vm, String* str) noexcept {
+		auto& device{ vm->stdDevice };
+		if (device.byteInputFunc) {
+			const Byte* line;
+			Size len;
+			if (!Stdin_Line(device, line, len)) return false;
+			platform::Platform_UTF8BytesToString(line, len, str);
+			return true;
+		}
+		return device.charInputFunc && device.charInputFunc(str);
+	}
+
+	// 读取下一行, 输入结束时返回空
+	StringObject* Stdin_NextLine(VM* vm) noexcept {
+		auto sobj{ obj_allocate<StringObject>(vm->getType(TypeId::String)) };
+		if (Stdin_ReadLine(vm, &sobj->value)) return sobj;
+		sobj->type->f_deallocate(sobj);
+		return nullptr;
+	}
+
+	// 解析读取数量参数, 无参数时读至输入结束
+	bool Stdin_Count(VM* vm, const StringView name, ObjArgsView args, Size& count) noexcept {
+		if (args.empty()) {
+			count = static_cast<Size>(-1LL);
+			return true;
+		}
+		if (args.size() == 1ULL && args[0]->type->v_id == TypeId::Int) {
+			auto n{ obj_cast<IntObject>(args[0])->value };
+			if (n < 0LL) {
+				SetError_NegativeNumber(vm, n);
+				return false;
+			}
+			count = static_cast<Size>(n);
+			return true;
+		}
+		SetError_UnmatchedCall(vm, name, args);
+		return false;
+	}
+
+	LIB_EXPORT void Stream_ReadLine(HVM hvm, ObjArgsView, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		if (auto line{ Stdin_NextLine(vm) }) vm->objectStack.push_link(line);
+		else vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Null)));
+	}
+
+	LIB_EXPORT void Stream_ReadLines(HVM hvm, ObjArgsView, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
+		while (auto line{ Stdin_NextLine(vm) }) {
+			line->link();
+			lobj->objects.emplace_back(line);
+		}
+		vm->objectStack.push_link(lobj);
+	}
+
+	LIB_EXPORT void Stream_ReadAll(HVM hvm, ObjArgsView, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& device{ vm->stdDevice };
+		if (!device.byteInputFunc) return SetError_IODeviceError(vm);
+		while (Stdin_Fill(device));
+		auto& buf{ device.inputBuffer };
+		auto sobj{ obj_allocate<StringObject>(vm->getType(TypeId::String)) };
+		platform::Platform_UTF8BytesToString(buf.data() + device.inputPos, buf.size() - device.inputPos, &sobj->value);
+		device.inputPos = buf.size();
+		vm->objectStack.push_link(sobj);
+	}
+
+	LIB_EXPORT void Stream_ReadInts(HVM hvm, ObjArgsView args, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& device{ vm->stdDevice };
+		Size count;
+		if (!Stdin_Count(vm, u"stream::read_ints", args, count)) return;
+		if (!device.byteInputFunc) return SetError_IODeviceError(vm);
+		auto aobj{ obj_allocate<ArrayObject>(vm->getType(TypeId::Array)) };
+		aobj->data.reserve(Stdin_Reserve(device, count));
+		if (Stdin_Parse(device, count, aobj->data)) vm->objectStack.push_link(aobj);
+		else {
+			aobj->type->f_deallocate(aobj);
+			SetError_ScanError(vm, vm->getType(TypeId::Int));
+		}
+	}
+
+	LIB_EXPORT void Stream_ReadFloats(HVM hvm, ObjArgsView args, Object*) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& device{ vm->stdDevice };
+		Size count;
+		if (!Stdin_Count(vm, u"stream::read_floats", args, count)) return;
+		if (!device.byteInputFunc) return SetError_IODeviceError(vm);
+		Vector<Float64> values;
+		values.reserve(Stdin_Reserve(device, count));
+		if (Stdin_Parse(device, count, values)) vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Vector),
+			arg_cast(values.data()), arg_cast(values.size())));
+		else SetError_ScanError(vm, vm->getType(TypeId::Float));
+	}
+}
+
+namespace hy {
+	struct StreamStaticData {
+		StreamObject instance; // 标准输入
+		FunctionTable ft;
+
+		StreamStaticData(TypeObject* type) noexcept : instance{ type } {
+			instance.link();
+
+			auto funcType{ type->__getType(TypeId::Function) };
+
+			ObjArgsView empty;
+
+			ft.try_emplace(u"read_line", MakeNative<true, true>(funcType, u"stream::read_line", &impl::Stream_ReadLine, empty));
+			ft.try_emplace(u"read_lines", MakeNative<true, true>(funcType, u"stream::read_lines", &impl::Stream_ReadLines, empty));
+			ft.try_emplace(u"read_all", MakeNative<true, true>(funcType, u"stream::read_all", &impl::Stream_ReadAll, empty));
+			ft.try_emplace(u"read_ints", MakeNative<false, true>(funcType, u"stream::read_ints", &impl::Stream_ReadInts, empty));
+			ft.try_emplace(u"read_floats", MakeNative<false, true>(funcType, u"stream::read_floats", &impl::Stream_ReadFloats, empty));
+		}
+	};
+
+	void f_class_create_stream(TypeObject* type) noexcept {
+		type->v_static = new StreamStaticData(type);
+	}
+
+	void f_class_delete_stream(TypeObject* type) noexcept {
+		auto staticData{ static_cast<StreamStaticData*>(type->v_static) };
+		for (auto& [_, fobj] : staticData->ft) delete fobj;
+		delete staticData;
+	}
+
+	Object* f_allocate_stream(TypeObject* type, Memory, Memory) noexcept {
+		return &static_cast<StreamStaticData*>(type->v_static)->instance;
+	}
+
+	IResult<void> f_string_stream(HVM, Object*, String* str) noexcept {
+		str->append(u"stdin");
+		return IResult<void>(true);
+	}
+
+	IResult<void> f_member_stream(HVM hvm, bool isLV, Object* obj, const StringView member) noexcept {
+		auto vm{ vm_cast(hvm) };
+		if (!isLV) {
+			auto& ft{ static_cast<StreamStaticData*>(obj->type->v_static)->ft };
+			if (auto pFobj{ ft.get(member) }) {
+				auto fobj{ obj_allocate(vm->getType(TypeId::MemberFunction), *pFobj, obj) };
+				vm->objectStack.push_link(fobj);
+				return IResult<void>(true);
+			}
+			else return SetError(&SetError_UnmatchedMember, vm, obj->type, member);
+		}
+		else return SetError(&SetError_NotLeftValue, vm, member);
+	}
+
+	// 迭代器暂存检查时读入的行, 保存时取出, 前进时释放
+	constexpr auto STREAM_ITER_LINE{ 0ULL };
+
+	IResult<void> f_iter_get_stream(HVM hvm, Object* obj) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto iter{ obj_allocate<IteratorObject>(vm->getType(TypeId::Iterator)) };
+		iter->ref = obj;
+		iter->ref->link();
+		iter->setData<STREAM_ITER_LINE>(static_cast<Object*>(nullptr));
+		vm->objectStack.push_link(iter);
+		return IResult<void>(true);
+	}
+
+	IResult<void> f_iter_save_stream(HVM hvm, IteratorObject* iter, Size argc) noexcept {
+		auto vm{ vm_cast(hvm) };
+		if (argc == 1ULL) {
+			vm->objectStack.push_link(iter->getData<0ULL, Object*>());
+			return IResult<void>(true);
+		}
+		return SetError(&SetError_UnmatchedUnpack, vm, 1ULL, argc);
+	}
+
+	IResult<void> f_iter_add_stream(HVM, IteratorObject* iter) noexcept {
+		if (auto line{ iter->getData<0ULL, Object*>() }) line->unlink();
+		iter->resetData<0ULL>(static_cast<Object*>(nullptr));
+		return IResult<void>(true);
+	}
+
+	IResult<bool> f_iter_check_stream(HVM hvm, IteratorObject* iter) noexcept {
+		auto vm{ vm_cast(hvm) };
+		f_iter_add_stream(hvm, iter);
+		auto line{ impl::Stdin_NextLine(vm) };
+		if (!line) return IResult<bool>(false);
+		line->link();
+		iter->resetData<0ULL>(static_cast<Object*>(line));
+		return IResult<bool>(true);
+	}
+
+	void f_iter_free_stream(IteratorObject* iter) noexcept {
+		if (auto line{ iter->getData<0ULL, Object*>() }) line->unlink();
+	}
+}
+
+namespace hy {
+	TypeObject* AddStreamPrototype(TypeObject* prototype) noexcept {
+		auto type{ new TypeObject(prototype) };
+		type->v_id = TypeId::Stream;
+		type->v_name = u"stream";
+
+		type->v_static = nullptr;
+		type->v_cls = nullptr;
+		type->v_cps = nullptr;
+
+		type->a_mutable = true;
+		type->a_def = false;
+		type->a_unused1 = type->a_unused2 = false;
+
+		type->f_class_create = &f_class_create_stream;
+		type->f_class_delete = &f_class_delete_stream;
+		type->f_class_clean = nullptr;
+		type->f_allocate = &f_allocate_stream;
+		type->f_deallocate = &f_deallocate_empty;
+		type->f_implement = nullptr;
+
+		type->f_float = nullptr;
+		type->f_bool = nullptr;
+		type->f_string = &f_string_stream;
+
+		type->f_hash = &f_hash_fixed<0ULL>;
+		type->f_len = nullptr;
+		type->f_member = &f_member_stream;
+		type->f_index = nullptr;
+		type->f_unpack = nullptr;
+
+		type->f_construct = nullptr;
+		type->f_full_copy = nullptr;
+		type->f_copy = nullptr;
+		type->f_write = nullptr;
+		type->f_scan = nullptr;
+		type->f_calcassign = nullptr;
+
+		type->f_assign_lv_data = nullptr;
+		type->f_calcassign_lv_data = nullptr;
+		type->f_free_lv_data = nullptr;
+
+		type->f_sopt_calc = nullptr;
+		type->f_bopt_calc = nullptr;
+		type->f_equal = &f_equal_ref;
+		type->f_compare = nullptr;
+
+		type->f_iter_get = &f_iter_get_stream;
+		type->f_iter_save = &f_iter_save_stream;
+		type->f_iter_add = &f_iter_add_stream;
+		type->f_iter_check = &f_iter_check_stream;
+		type->f_iter_free = &f_iter_free_stream;
+
+		return type;
+	}
+}
@@ -2,6 +2,157 @@
 
 #include <fast_io/fast_io.h>
 
+#include <bit>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define HY_STRING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace hy::impl::details {
+	/*
+	子串查找, 语义同String::find
+	单字符: SSE2下每次比较8个字符
+	短子串: SSE2下每次比较8个位置的首尾字符, 仅对首尾均匹配的位置逐字比较
+	长子串: Horspool算法, 跳跃表以字符低字节为下标, 冲突时取较小的跳跃距离
+	*/
+	constexpr auto HORSPOOL_MIN_LENGTH{ 32ULL };
+
+	inline bool StringEqual(const Char* s1, const Char* s2, Size n) noexcept {
+		return !freestanding::compare(s1, s2, n * sizeof(Char));
+	}
+
+#ifdef HY_STRING_SSE2
+	// 8个字符的比较结果, 每个匹配字符占掩码中的2位
+	inline Uint32 SimdMatch(const Char* p, __m128i ch) noexcept {
+		return static_cast<Uint32>(_mm_movemask_epi8(_mm_cmpeq_epi16(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), ch)));
+	}
+
+	inline __m128i SimdChar(Char ch) noexcept {
+		return _mm_set1_epi16(static_cast<short>(ch));
+	}
+#endif
+
+	Index FindChar(const Char* s, Size n, Index pos, Char c) noexcept {
+#ifdef HY_STRING_SSE2
+		auto vc{ SimdChar(c) };
+		for (; pos + 8ULL <= n; pos += 8ULL) {
+			if (auto mask{ SimdMatch(s + pos, vc) }) return pos + (std::countr_zero(mask) >> 1);
+		}
+#endif
+		for (; pos < n; ++pos) {
+			if (s[pos] == c) return pos;
+		}
+		return String::npos;
+	}
+
+	Index FindShort(const Char* s, Size n, Index pos, const Char* t, Size m) noexcept {
+		auto first{ t[0] }, last{ t[m - 1ULL] };
+#ifdef HY_STRING_SSE2
+		auto vf{ SimdChar(first) }, vl{ SimdChar(last) };
+		for (; pos + m + 7ULL <= n; pos += 8ULL) {
+			auto mask{ SimdMatch(s + pos, vf) & SimdMatch(s + pos + m - 1ULL, vl) & 0x5555U };
+			for (; mask; mask &= mask - 1U) {
+				auto i{ pos + (std::countr_zero(mask) >> 1) };
+				if (StringEqual(s + i + 1ULL, t + 1ULL, m - 2ULL)) return i;
+			}
+		}
+#endif
+		for (; pos + m <= n; ++pos) {
+			if (s[pos] == first && s[pos + m - 1ULL] == last &&
+				StringEqual(s + pos + 1ULL, t + 1ULL, m - 2ULL)) return pos;
+		}
+		return String::npos;
+	}
+
+	Index FindLong(const Char* s, Size n, Index pos, const Char* t, Size m) noexcept {
+		Size shift[256];
+		for (auto& k : shift) k = m;
+		for (Index i{ }; i + 1ULL < m; ++i) shift[t[i] & 0xFFU] = m - 1ULL - i;
+		auto last{ t[m - 1ULL] };
+		while (pos + m <= n) {
+			auto c{ s[pos + m - 1ULL] };
+			if (c == last && StringEqual(s + pos, t, m - 1ULL)) return pos;
+			pos += shift[c & 0xFFU];
+		}
+		return String::npos;
+	}
+
+	Index Find(StringView s, StringView t, Index pos) noexcept {
+		auto n{ s.size() }, m{ t.size() };
+		if (pos > n || m > n - pos) return String::npos;
+		if (!m) return pos;
+		if (m == 1ULL) return FindChar(s.data(), n, pos, t[0]);
+		if (m < HORSPOOL_MIN_LENGTH) return FindShort(s.data(), n, pos, t.data(), m);
+		return FindLong(s.data(), n, pos, t.data(), m);
+	}
+
+	// 子串不重叠出现的次数
+	Size Count(StringView s, StringView t) noexcept {
+		Size count{ };
+		if (t.size() == 1ULL) {
+			auto p{ s.data() };
+			auto n{ s.size() };
+			auto c{ t[0] };
+			Index pos{ };
+#ifdef HY_STRING_SSE2
+			auto vc{ SimdChar(c) };
+			for (; pos + 8ULL <= n; pos += 8ULL) count += std::popcount(SimdMatch(p + pos, vc)) >> 1;
+#endif
+			for (; pos < n; ++pos) count += p[pos] == c;
+		}
+		else if (!t.empty()) {
+			for (auto pos{ Find(s, t, 0ULL) }; pos != String::npos; pos = Find(s, t, pos + t.size())) ++count;
+		}
+		return count;
+	}
+
+	// 分隔字符集合, 低256个字符使用位图, 字符不多于SIMD_MAX时SSE2下每次比较8个字符
+	struct CharSet {
+		constexpr static auto SIMD_MAX{ 4ULL };
+
+		StringView chars;
+		Uint64 bits[4]{ };
+		bool high{ };
+
+		explicit CharSet(StringView sv) noexcept : chars{ sv } {
+			for (auto c : sv) {
+				if (c < 256U) bits[c >> 6U] |= 1ULL << (c & 63U);
+				else high = true;
+			}
+		}
+
+		bool contains(Char c) const noexcept {
+			if (c < 256U) return (bits[c >> 6U] >> (c & 63U)) & 1ULL;
+			return high && chars.find(c) != StringView::npos;
+		}
+	};
+
+	// 查找[pos, n)中首个属于(inSet为真)或不属于集合的字符
+	template<bool inSet>
+	Index FindOf(StringView s, Index pos, const CharSet& set) noexcept {
+		auto p{ s.data() };
+		auto n{ s.size() };
+#ifdef HY_STRING_SSE2
+		if (auto k{ set.chars.size() }; k && k <= CharSet::SIMD_MAX) {
+			__m128i vc[CharSet::SIMD_MAX];
+			for (Index i{ }; i < CharSet::SIMD_MAX; ++i) vc[i] = SimdChar(set.chars[i < k ? i : 0ULL]);
+			for (; pos + 8ULL <= n; pos += 8ULL) {
+				auto mask{ SimdMatch(p + pos, vc[0]) | SimdMatch(p + pos, vc[1]) |
+					SimdMatch(p + pos, vc[2]) | SimdMatch(p + pos, vc[3]) };
+				if constexpr (!inSet) mask ^= 0xFFFFU;
+				if (mask) return pos + (std::countr_zero(mask) >> 1);
+			}
+		}
+#endif
+		for (; pos < n; ++pos) {
+			if (set.contains(p[pos]) == inSet) return pos;
+		}
+		return String::npos;
+	}
+}
+
 namespace hy::impl {
 	IResult<void> String_Concat(VM* vm, String* str, ObjArgsView args, bool newLine) noexcept {
 		for (auto arg : args) {
@@ -11,17 +162,40 @@ namespace hy::impl {
 		return IResult<void>(true);
 	}
 
+	// 取sobj中[pos, pos + count)的子串, 足够长时共享原数据而不复制
+	StringObject* String_Slice(StringObject* sobj, Index pos, Size count) noexcept {
+		auto total{ sobj->size() };
+		if (pos > total) pos = total;
+		if (count > total - pos) count = total - pos;
+		auto ret{ obj_allocate<StringObject>(sobj->type) };
+		if (SliceShare::check(count, total)) ret->share(sobj, pos, count);
+		else {
+			ret->value.assign(sobj->view().substr(pos, count));
+			if (sobj->kind == StringKind::ASCII) ret->kind = StringKind::ASCII;
+		}
+		return ret;
+	}
+
+	// 编码为字节, 已知全为ASCII时直接截断
+	template<void(*encode)(const StringView, util::ByteArray*) noexcept>
+	void String_Encode(StringObject* sobj, util::ByteArray* ba) noexcept {
+		auto str{ sobj->view() };
+		if (sobj->ascii()) {
+			ba->resize(str.size());
+			util::NarrowASCII(str.data(), str.size(), ba->data());
+		}
+		else encode(str, ba);
+	}
+
 	LIB_EXPORT void String_Substr(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto sobj{ obj_cast<StringObject>(thisObject) };
-		auto len{ static_cast<Int64>(sobj->value.size()) };
+		auto len{ static_cast<Int64>(sobj->size()) };
 		if (auto argc{ args.size() }; argc == 1ULL) {
 			if (args[0]->type->v_id == TypeId::Int) {
 				auto start{ obj_cast<IntObject>(args[0])->value };
 				if (start <= 0LL || start > len) start = 1LL;
-				auto ret{ obj_allocate<StringObject>(thisObject->type) };
-				ret->value = sobj->value.substr(start - 1LL);
-				vm->objectStack.push_link(ret);
+				vm->objectStack.push_link(String_Slice(sobj, static_cast<Index>(start - 1LL), String::npos));
 				return;
 			}
 		}
@@ -33,9 +207,7 @@ namespace hy::impl {
 					start = 1LL;
 					count = 0LL;
 				}
-				auto ret{ obj_allocate<StringObject>(thisObject->type) };
-				ret->value = sobj->value.substr(start - 1LL, count);
-				vm->objectStack.push_link(ret);
+				vm->objectStack.push_link(String_Slice(sobj, static_cast<Index>(start - 1LL), static_cast<Size>(count)));
 				return;
 			}
 		}
@@ -44,114 +216,139 @@ namespace hy::impl {
 
 	LIB_EXPORT void String_Left(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
-		auto ret{ obj_allocate<StringObject>(thisObject->type) };
-		ret->value = str1.substr(0, str1.find(str2));
-		vm->objectStack.push_link(ret);
+		auto sobj{ obj_cast<StringObject>(thisObject) };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
+		vm->objectStack.push_link(String_Slice(sobj, 0ULL, sobj->view().find(str2)));
 	}
 
 	LIB_EXPORT void String_Right(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
-		auto ret{ obj_allocate<StringObject>(thisObject->type) };
-		ret->value = str1.substr(str1.find(str2) + str2.size());
-		vm->objectStack.push_link(ret);
+		auto sobj{ obj_cast<StringObject>(thisObject) };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
+		vm->objectStack.push_link(String_Slice(sobj, sobj->view().find(str2) + str2.size(), String::npos));
 	}
 
 	LIB_EXPORT void String_Middle(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
-		auto& str3{ obj_cast<StringObject>(args[1])->value };
-		auto ret{ obj_allocate<StringObject>(thisObject->type) };
+		auto sobj{ obj_cast<StringObject>(thisObject) };
+		auto str1{ sobj->view() };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
+		auto str3{ obj_cast<StringObject>(args[1])->view() };
 		auto l{ str1.find(str2) }, k{ str2.size() };
 		if (l != String::npos) {
-			auto r{ str1.find(str3, l + k) };
-			if (r != String::npos) ret->value = str1.substr(l + k, r - l - k);
+			if (auto r{ str1.find(str3, l + k) }; r != String::npos) {
+				vm->objectStack.push_link(String_Slice(sobj, l + k, r - l - k));
+				return;
+			}
 		}
-		vm->objectStack.push_link(ret);
+		vm->objectStack.push_link(obj_allocate(thisObject->type));
 	}
 
 	LIB_EXPORT void String_Replace(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
-		auto& str3{ obj_cast<StringObject>(args[1])->value };
-		auto ret{ obj_allocate<StringObject>(thisObject->type, arg_cast(str1.data()), arg_cast(str1.size())) };
-		for (Index pos{ }; pos != String::npos; pos += str3.size()) {
-			if ((pos = ret->value.find(str2, pos)) != String::npos) ret->value.replace(pos, str2.size(), str3);
-			else break;
+		auto sobj{ obj_cast<StringObject>(thisObject) };
+		auto str1{ sobj->view() };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
+		auto str3{ obj_cast<StringObject>(args[1])->view() };
+		// 先记录所有匹配位置, 再按最终长度一次写出结果, 空子串匹配每个字符之前及末尾
+		Vector<Index> matches;
+		if (str2.empty()) {
+			if (!str3.empty()) for (Index i{ }; i <= str1.size(); ++i) matches.emplace_back(i);
+		}
+		else {
+			for (auto pos{ details::Find(str1, str2, 0ULL) }; pos != String::npos;
+				pos = details::Find(str1, str2, pos + str2.size())) matches.emplace_back(pos);
+		}
+		if (matches.empty()) {
+			vm->objectStack.push_link(String_Slice(sobj, 0ULL, String::npos));
+			return;
+		}
+		auto ret{ obj_allocate<StringObject>(thisObject->type) };
+		auto& out{ ret->value };
+		out.reserve(str1.size() - matches.size() * str2.size() + matches.size() * str3.size());
+		Index last{ };
+		for (auto pos : matches) {
+			out.append(str1.substr(last, pos - last)).append(str3);
+			last = pos + str2.size();
 		}
+		out.append(str1.substr(last));
 		vm->objectStack.push_link(ret);
 	}
 
 	LIB_EXPORT void String_Split(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
-		auto lastPos{ str1.find_first_not_of(str2, 0ULL) };
-		auto pos{ str1.find_first_of(str2, lastPos) };
+		auto str1{ obj_cast<StringObject>(thisObject)->view() };
+		details::CharSet set{ obj_cast<StringObject>(args[0])->view() };
+		// 先记录各段的起止位置, 再按段数预留列表容量
+		Vector<Index> bounds;
+		for (auto start{ details::FindOf<false>(str1, 0ULL, set) }; start != String::npos;) {
+			auto end{ details::FindOf<true>(str1, start, set) };
+			if (end == String::npos) end = str1.size();
+			bounds.emplace_back(start);
+			bounds.emplace_back(end);
+			start = details::FindOf<false>(str1, end, set);
+		}
 		auto lobj{ obj_allocate<ListObject>(vm->getType(TypeId::List)) };
-		for (; pos != String::npos || lastPos != String::npos;) {
-			auto sobj{ obj_allocate<StringObject>(thisObject->type) };
-			sobj->value = str1.substr(lastPos, pos - lastPos);
+		lobj->objects.reserve(bounds.size() >> 1ULL);
+		for (Index i{ }; i < bounds.size(); i += 2ULL) {
+			auto sobj{ obj_allocate<StringObject>(thisObject->type,
+				arg_cast(str1.data() + bounds[i]), arg_cast(bounds[i + 1ULL] - bounds[i])) };
 			sobj->link();
 			lobj->objects.emplace_back(sobj);
-			lastPos = str1.find_first_not_of(str2, pos);
-			pos = str1.find_first_of(str2, lastPos);
 		}
 		vm->objectStack.push_link(lobj);
 	}
 
 	LIB_EXPORT void String_Reverse(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto sobj{ obj_cast<StringObject>(thisObject) };
+		auto str{ obj_cast<StringObject>(thisObject)->view() };
 		auto ret{ obj_allocate<StringObject>(thisObject->type) };
-		ret->value.assign(sobj->value.rbegin(), sobj->value.rend());
+		ret->value.assign(str.rbegin(), str.rend());
 		vm->objectStack.push_link(ret);
 	}
 
 	LIB_EXPORT void String_Strip(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto ret{ obj_allocate<StringObject>(thisObject->type) };
+		auto sobj{ obj_cast<StringObject>(thisObject) };
+		auto str1{ sobj->view() };
 		if (auto len{ str1.size() }) {
 			Index left{ }, right{ len - 1ULL };
 			while (left < len && freestanding::cvt::isblank(str1[left])) ++left;
 			while (right >= left && freestanding::cvt::isblank(str1[right])) --right;
-			if (left != len) ret->value = str1.substr(left, right - left + 1ULL);
+			if (left != len) {
+				vm->objectStack.push_link(String_Slice(sobj, left, right - left + 1ULL));
+				return;
+			}
 		}
-		vm->objectStack.push_link(ret);
+		vm->objectStack.push_link(obj_allocate(thisObject->type));
 	}
 
 	LIB_EXPORT void String_StartsWith(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto str2{ obj_cast<StringObject>(args[0])->value };
+		auto str1{ obj_cast<StringObject>(thisObject)->view() };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
 		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Bool),
 			arg_cast(static_cast<Int64>(str1.starts_with(str2)))));
 	}
 
 	LIB_EXPORT void String_EndsWith(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
+		auto str1{ obj_cast<StringObject>(thisObject)->view() };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
 		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Bool),
 			arg_cast(static_cast<Int64>(str1.ends_with(str2)))));
 	}
 
 	LIB_EXPORT void String_Find(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
+		auto str1{ obj_cast<StringObject>(thisObject)->view() };
 		auto argc{ args.size() };
 		auto ok{ false };
 		auto start{ 0LL };
 		StringView sv;
 		if (argc >= 1ULL) {
 			if (args[0]->type->v_id == TypeId::String) {
-				sv = obj_cast<StringObject>(args[0])->value;
+				sv = obj_cast<StringObject>(args[0])->view();
 				if (argc == 1ULL) ok = true;
 				else if (argc == 2ULL) {
 					if (args[1]->type->v_id == TypeId::Int) {
@@ -163,7 +360,7 @@ namespace hy::impl {
 			}
 		}
 		if (ok) {
-			auto index{ str1.find(sv, static_cast<Index>(start)) };
+			auto index{ details::Find(str1, sv, static_cast<Index>(start)) };
 			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int),
 				arg_cast(index == String::npos ? 0ULL : index + 1ULL)));
 		}
@@ -172,14 +369,14 @@ namespace hy::impl {
 
 	LIB_EXPORT void String_RFind(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
+		auto str1{ obj_cast<StringObject>(thisObject)->view() };
 		auto argc{ args.size() }, len{ str1.size() };
 		auto ok{ false };
 		auto start{ static_cast<Int64>(len) - 1LL };
 		StringView sv;
 		if (argc >= 1ULL) {
 			if (args[0]->type->v_id == TypeId::String) {
-				sv = obj_cast<StringObject>(args[0])->value;
+				sv = obj_cast<StringObject>(args[0])->view();
 				if (argc == 1ULL) ok = true;
 				else if (argc == 2ULL) {
 					if (args[1]->type->v_id == TypeId::Int) {
@@ -200,15 +397,15 @@ namespace hy::impl {
 
 	LIB_EXPORT void String_Contains(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
+		auto str1{ obj_cast<StringObject>(thisObject)->view() };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
 		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Bool),
-			arg_cast(static_cast<Int64>(str1.find(str2) != String::npos))));
+			arg_cast(static_cast<Int64>(details::Find(str1, str2, 0ULL) != String::npos))));
 	}
 	
 	LIB_EXPORT void String_Lower(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str{ obj_cast<StringObject>(thisObject)->value };
+		auto str{ obj_cast<StringObject>(thisObject)->view() };
 		auto sobj{ obj_allocate<StringObject>(thisObject->type,
 			arg_cast(str.data()), arg_cast(str.size())) };
 		for (auto& c : sobj->value) {
@@ -219,7 +416,7 @@ namespace hy::impl {
 
 	LIB_EXPORT void String_Upper(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str{ obj_cast<StringObject>(thisObject)->value };
+		auto str{ obj_cast<StringObject>(thisObject)->view() };
 		auto sobj{ obj_allocate<StringObject>(thisObject->type,
 			arg_cast(str.data()), arg_cast(str.size())) };
 		for (auto& c : sobj->value) {
@@ -230,14 +427,9 @@ namespace hy::impl {
 
 	LIB_EXPORT void String_Count(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str1{ obj_cast<StringObject>(thisObject)->value };
-		auto& str2{ obj_cast<StringObject>(args[0])->value };
-		auto pos{ 0ULL }, count{ 0ULL };
-		while ((pos = str1.find(str2, pos)) != String::npos) {
-			++count;
-			pos += str2.size();
-		}
-		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(count)));
+		auto str1{ obj_cast<StringObject>(thisObject)->view() };
+		auto str2{ obj_cast<StringObject>(args[0])->view() };
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int), arg_cast(details::Count(str1, str2))));
 	}
 }
 
@@ -298,7 +490,9 @@ namespace hy {
 			obj = pool.back();
 			pool.pop_back();
 		}
+		obj->release();
 		obj->value.clear();
+		obj->kind = StringKind::UNKNOWN;
 		if (arg2) {
 			if (arg1) obj->value.assign(arg_recast<Str>(arg1), arg_recast<Size>(arg2));
 			else obj->value.resize(arg_recast<Size>(arg2));
@@ -308,24 +502,26 @@ namespace hy {
 
 	void f_deallocate_string(Object* obj) noexcept {
 		auto& pool{ static_cast<StringStaticData*>(obj->type->v_static)->pool };
-		pool.emplace_back(obj_cast<StringObject>(obj));
+		auto sobj{ obj_cast<StringObject>(obj) };
+		sobj->release();
+		pool.emplace_back(sobj);
 	}
 
 	bool f_bool_string(Object* obj) noexcept {
-		return !obj_cast<StringObject>(obj)->value.empty();
+		return obj_cast<StringObject>(obj)->size() != 0ULL;
 	}
 
 	IResult<void> f_string_string(HVM, Object* obj, String* str) noexcept {
-		str->append(obj_cast<StringObject>(obj)->value);
+		str->append(obj_cast<StringObject>(obj)->view());
 		return IResult<void>(true);
 	}
 
 	IResult<Size> f_hash_string(HVM, Object* obj) noexcept {
-		return IResult<Size>(std::hash<String>{}(obj_cast<StringObject>(obj)->value));
+		return IResult<Size>(std::hash<StringView>{}(obj_cast<StringObject>(obj)->view()));
 	}
 
 	IResult<Size> f_len_string(HVM, Object* obj) noexcept {
-		return IResult<Size>(obj_cast<StringObject>(obj)->value.length());
+		return IResult<Size>(obj_cast<StringObject>(obj)->size());
 	}
 
 	IResult<void> f_member_string(HVM hvm, bool isLV, Object* obj, const StringView member) noexcept {
@@ -335,13 +531,13 @@ namespace hy {
 			auto binType{ vm->getType(TypeId::Bin) };
 			if (member == u"utf8") {
 				auto bobj{ obj_allocate<BinObject>(binType) };
-				platform::Platform_StringToUTF8(&sobj->value, &bobj->data);
+				impl::String_Encode<&platform::Platform_StringToUTF8>(sobj, &bobj->data);
 				vm->objectStack.push_link(bobj);
 				return IResult<void>(true);
 			}
 			else if (member == u"gb2312") {
 				auto bobj{ obj_allocate<BinObject>(binType) };
-				platform::Platform_StringToGB2312(&sobj->value, &bobj->data);
+				impl::String_Encode<&platform::Platform_StringToGB2312>(sobj, &bobj->data);
 				vm->objectStack.push_link(bobj);
 				return IResult<void>(true);
 			}
@@ -364,7 +560,7 @@ namespace hy {
 		auto sobj{ obj_cast<StringObject>(obj) };
 		if (auto argc{ args.size() }; argc == 1ULL) {
 			if (auto arg{ args[0] }; arg->type->v_id == TypeId::Int) {
-				auto length{ static_cast<Int64>(sobj->value.length()) };
+				auto length{ static_cast<Int64>(sobj->size()) };
 				auto index{ obj_cast<IntObject>(arg)->value };
 				if (index > 0LL && index <= length) {
 					auto actualIndex{ static_cast<Index>(index - 1) };
@@ -378,7 +574,7 @@ namespace hy {
 					}
 					else {
 						vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int),
-							arg_cast(static_cast<Int64>(sobj->value[actualIndex]))));
+							arg_cast(static_cast<Int64>(sobj->view()[actualIndex]))));
 						return IResult<void>(true);
 					}
 				}
@@ -398,8 +594,8 @@ namespace hy {
 		}
 		else if (argc == 1ULL) {
 			if (auto arg{ args[0] }; arg->type->v_id == TypeId::String) {
-				auto sobj{ obj_cast<StringObject>(arg) };
-				vm->objectStack.push_link(obj_allocate(type, arg_cast(sobj->value.data()), arg_cast(sobj->value.size())));
+				auto str{ obj_cast<StringObject>(arg)->view() };
+				vm->objectStack.push_link(obj_allocate(type, arg_cast(str.data()), arg_cast(str.size())));
 				return IResult<void>(true);
 			}
 		}
@@ -407,12 +603,11 @@ namespace hy {
 	}
 
 	Object* f_full_copy_string(Object* obj) noexcept {
-		auto& str{ obj_cast<StringObject>(obj)->value };
-		return obj_allocate(obj->type, arg_cast(str.data()), arg_cast(str.size()));
+		return impl::String_Slice(obj_cast<StringObject>(obj), 0ULL, String::npos);
 	}
 
 	IResult<void> f_write_string(HVM hvm, Object* obj, ObjArgsView args) noexcept {
-		return impl::String_Concat(vm_cast(hvm), &obj_cast<StringObject>(obj)->value, args, false);
+		return impl::String_Concat(vm_cast(hvm), &obj_cast<StringObject>(obj)->str(), args, false);
 	}
 
 	IResult<Size> f_scan_string(HVM hvm, TypeObject* type, const StringView str) noexcept {
@@ -424,7 +619,7 @@ namespace hy {
 	IResult<void> f_calcassign_string(HVM hvm, LVObject* lv, Object* obj2, AssignType opt) noexcept {
 		auto sobj1{ lv->getAddressObject<StringObject>() };
 		if (opt == AssignType::ADD_ASSIGN && obj2->type->v_id == TypeId::String) {
-			sobj1->value += obj_cast<StringObject>(obj2)->value;
+			sobj1->append(obj_cast<StringObject>(obj2)->view());
 			return IResult<void>(true);
 		}
 		return SetError(&SetError_IncompatibleCalcAssign, vm_cast(hvm), sobj1->type, obj2->type, opt);
@@ -432,7 +627,7 @@ namespace hy {
 
 	IResult<void> f_assign_lv_data_string(HVM hvm, LVObject* lv, Object* obj) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str{ lv->getParent<StringObject>()->value };
+		auto& str{ lv->getParent<StringObject>()->str() };
 		if (obj->type->v_id == TypeId::Int) {
 			str[lv->getData<0ULL, Index>()] = static_cast<Char>(obj_cast<IntObject>(obj)->value);
 			return IResult<void>(true);
@@ -442,7 +637,7 @@ namespace hy {
 
 	IResult<void> f_calcassign_lv_data_string(HVM hvm, LVObject* lv, Object* obj, AssignType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto& str{ lv->getParent<StringObject>()->value };
+		auto& str{ lv->getParent<StringObject>()->str() };
 		if (obj->type->v_id == TypeId::Int) {
 			str[lv->getData<0ULL, Index>()] += static_cast<Char>(obj_cast<IntObject>(obj)->value);
 			return IResult<void>(true);
@@ -453,9 +648,15 @@ namespace hy {
 	IResult<void> f_bopt_calc_string(HVM hvm, Object* obj1, Object* obj2, BOPTType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
 		if (opt == BOPTType::ADD && obj2->type->v_id == TypeId::String) {
+			auto sobj1{ obj_cast<StringObject>(obj1) };
+			auto sobj2{ obj_cast<StringObject>(obj2) };
 			auto ret{ obj_allocate<StringObject>(obj1->type) };
-			print(fast_io::u16ostring_ref{ &ret->value }, obj_cast<StringObject>(obj1)->value,
-				obj_cast<StringObject>(obj2)->value);
+			// 左操作数较长时结果共享其数据并在末尾追加, 使 s = s + t 的反复连接为线性时间
+			if (sobj1->size() >= SliceShare::SHARE_MIN_LENGTH) {
+				ret->share(sobj1, 0ULL, sobj1->size());
+				ret->append(sobj2->view());
+			}
+			else print(fast_io::u16ostring_ref{ &ret->value }, sobj1->view(), sobj2->view());
 			vm->objectStack.push_link(ret);
 			return IResult<void>(true);
 		}
@@ -463,21 +664,27 @@ namespace hy {
 	}
 
 	IResult<bool> f_equal_string(HVM, Object* obj1, Object* obj2) noexcept {
-		if (obj2->type->v_id == TypeId::String)
-			return IResult<bool>(obj_cast<StringObject>(obj1)->value == obj_cast<StringObject>(obj2)->value);
+		if (obj2->type->v_id == TypeId::String) {
+			auto sobj1{ obj_cast<StringObject>(obj1) };
+			auto sobj2{ obj_cast<StringObject>(obj2) };
+			// 字符范围均已知且不同时必不相等
+			if (sobj1->kind != sobj2->kind && sobj1->kind != StringKind::UNKNOWN && sobj2->kind != StringKind::UNKNOWN)
+				return IResult<bool>(false);
+			return IResult<bool>(sobj1->view() == sobj2->view());
+		}
 		return IResult<bool>(false);
 	}
 
 	IResult<bool> f_compare_string(HVM hvm, Object* obj1, Object* obj2, BOPTType opt) noexcept {
 		if (obj2->type->v_id == TypeId::String) {
-			auto sobj1{ obj_cast<StringObject>(obj1) };
-			auto sobj2{ obj_cast<StringObject>(obj2) };
+			auto str1{ obj_cast<StringObject>(obj1)->view() };
+			auto str2{ obj_cast<StringObject>(obj2)->view() };
 			auto ret{ false };
 			switch (opt) {
-			case BOPTType::GT: ret = sobj1->value > sobj2->value; break;
-			case BOPTType::GE: ret = sobj1->value >= sobj2->value; break;
-			case BOPTType::LT: ret = sobj1->value < sobj2->value; break;
-			case BOPTType::LE: ret = sobj1->value <= sobj2->value; break;
+			case BOPTType::GT: ret = str1 > str2; break;
+			case BOPTType::GE: ret = str1 >= str2; break;
+			case BOPTType::LT: ret = str1 < str2; break;
+			case BOPTType::LE: ret = str1 <= str2; break;
 			}
 			return IResult<bool>(ret);
 		}
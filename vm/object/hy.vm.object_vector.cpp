@@ -2,18 +2,340 @@
 
 #include <fast_io/fast_io.h>
 
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define HY_VECTOR_AVX2
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__)
+#define HY_VECTOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace hy::impl::details {
+	/*
+	浮点向量的批量运算
+	AVX2下每次处理4个元素, SSE2下2个, 其余情况为标量循环
+	归约运算使用两路SIMD累加, 求和结果与逐个累加的顺序不同, 可能有舍入误差上的差别
+	*/
+#if defined(HY_VECTOR_AVX2)
+	using SimdF64 = __m256d;
+	constexpr auto SIMD_F64_WIDTH{ 4ULL };
+	inline SimdF64 SimdLoad(const Float64* p) noexcept { return _mm256_loadu_pd(p); }
+	inline void SimdStore(Float64* p, SimdF64 v) noexcept { _mm256_storeu_pd(p, v); }
+	inline SimdF64 SimdSet(Float64 v) noexcept { return _mm256_set1_pd(v); }
+	inline SimdF64 SimdAdd(SimdF64 a, SimdF64 b) noexcept { return _mm256_add_pd(a, b); }
+	inline SimdF64 SimdSub(SimdF64 a, SimdF64 b) noexcept { return _mm256_sub_pd(a, b); }
+	inline SimdF64 SimdMul(SimdF64 a, SimdF64 b) noexcept { return _mm256_mul_pd(a, b); }
+	inline SimdF64 SimdDiv(SimdF64 a, SimdF64 b) noexcept { return _mm256_div_pd(a, b); }
+	inline SimdF64 SimdMin(SimdF64 a, SimdF64 b) noexcept { return _mm256_min_pd(a, b); }
+	inline SimdF64 SimdMax(SimdF64 a, SimdF64 b) noexcept { return _mm256_max_pd(a, b); }
+#elif defined(HY_VECTOR_SSE2)
+	using SimdF64 = __m128d;
+	constexpr auto SIMD_F64_WIDTH{ 2ULL };
+	inline SimdF64 SimdLoad(const Float64* p) noexcept { return _mm_loadu_pd(p); }
+	inline void SimdStore(Float64* p, SimdF64 v) noexcept { _mm_storeu_pd(p, v); }
+	inline SimdF64 SimdSet(Float64 v) noexcept { return _mm_set1_pd(v); }
+	inline SimdF64 SimdAdd(SimdF64 a, SimdF64 b) noexcept { return _mm_add_pd(a, b); }
+	inline SimdF64 SimdSub(SimdF64 a, SimdF64 b) noexcept { return _mm_sub_pd(a, b); }
+	inline SimdF64 SimdMul(SimdF64 a, SimdF64 b) noexcept { return _mm_mul_pd(a, b); }
+	inline SimdF64 SimdDiv(SimdF64 a, SimdF64 b) noexcept { return _mm_div_pd(a, b); }
+	inline SimdF64 SimdMin(SimdF64 a, SimdF64 b) noexcept { return _mm_min_pd(a, b); }
+	inline SimdF64 SimdMax(SimdF64 a, SimdF64 b) noexcept { return _mm_max_pd(a, b); }
+#endif
+
+#if defined(HY_VECTOR_AVX2) || defined(HY_VECTOR_SSE2)
+#define HY_VECTOR_SIMD
+	// 各通道依次归约
+	template<typename Op>
+	inline Float64 SimdReduce(SimdF64 v, Op op) noexcept {
+		alignas(32) Float64 lanes[SIMD_F64_WIDTH];
+		SimdStore(lanes, v);
+		auto r{ lanes[0] };
+		for (Index i{ 1ULL }; i < SIMD_F64_WIDTH; ++i) r = op(r, lanes[i]);
+		return r;
+	}
+#endif
+
+	// 逐元素运算, scalar为真时b指向单个标量, dst可与a或b相同
+	template<bool scalar>
+	void VectorCalc(Float64* dst, const Float64* a, const Float64* b, Size n, BOPTType opt) noexcept {
+		auto at{ [b](Index i) noexcept {
+			if constexpr (scalar) return *b;
+			else return b[i];
+		} };
+		Index i{ };
+		if (opt == BOPTType::POWER) {
+			for (; i < n; ++i) dst[i] = ::pow(a[i], at(i));
+			return;
+		}
+#ifdef HY_VECTOR_SIMD
+		SimdF64 vs{ };
+		if constexpr (scalar) vs = SimdSet(*b);
+		auto load{ [&](Index k) noexcept {
+			if constexpr (scalar) return vs;
+			else return SimdLoad(b + k);
+		} };
+		for (; i + SIMD_F64_WIDTH <= n; i += SIMD_F64_WIDTH) {
+			auto va{ SimdLoad(a + i) }, vb{ load(i) };
+			switch (opt) {
+			case BOPTType::ADD: va = SimdAdd(va, vb); break;
+			case BOPTType::SUBTRACT: va = SimdSub(va, vb); break;
+			case BOPTType::MULTIPLE: va = SimdMul(va, vb); break;
+			case BOPTType::DIVIDE: va = SimdDiv(va, vb); break;
+			}
+			SimdStore(dst + i, va);
+		}
+#endif
+		switch (opt) {
+		case BOPTType::ADD: for (; i < n; ++i) dst[i] = a[i] + at(i); break;
+		case BOPTType::SUBTRACT: for (; i < n; ++i) dst[i] = a[i] - at(i); break;
+		case BOPTType::MULTIPLE: for (; i < n; ++i) dst[i] = a[i] * at(i); break;
+		case BOPTType::DIVIDE: for (; i < n; ++i) dst[i] = a[i] / at(i); break;
+		}
+	}
+
+	Float64 VectorDot(const Float64* x, const Float64* y, Size n) noexcept {
+		Index i{ };
+		Float64 s{ };
+#ifdef HY_VECTOR_SIMD
+		auto s0{ SimdSet(0.0) }, s1{ SimdSet(0.0) };
+		for (; i + 2ULL * SIMD_F64_WIDTH <= n; i += 2ULL * SIMD_F64_WIDTH) {
+			s0 = SimdAdd(s0, SimdMul(SimdLoad(x + i), SimdLoad(y + i)));
+			s1 = SimdAdd(s1, SimdMul(SimdLoad(x + i + SIMD_F64_WIDTH), SimdLoad(y + i + SIMD_F64_WIDTH)));
+		}
+		s = SimdReduce(SimdAdd(s0, s1), [](Float64 u, Float64 v) noexcept { return u + v; });
+#endif
+		for (; i < n; ++i) s += x[i] * y[i];
+		return s;
+	}
+
+	Float64 VectorSum(const Float64* x, Size n) noexcept {
+		Index i{ };
+		Float64 s{ };
+#ifdef HY_VECTOR_SIMD
+		auto s0{ SimdSet(0.0) }, s1{ SimdSet(0.0) };
+		for (; i + 2ULL * SIMD_F64_WIDTH <= n; i += 2ULL * SIMD_F64_WIDTH) {
+			s0 = SimdAdd(s0, SimdLoad(x + i));
+			s1 = SimdAdd(s1, SimdLoad(x + i + SIMD_F64_WIDTH));
+		}
+		s = SimdReduce(SimdAdd(s0, s1), [](Float64 u, Float64 v) noexcept { return u + v; });
+#endif
+		for (; i < n; ++i) s += x[i];
+		return s;
+	}
+
+	// 最值, 要求n大于0
+	template<bool isMax>
+	Float64 VectorExtreme(const Float64* x, Size n) noexcept {
+		auto better{ [](Float64 a, Float64 b) noexcept { return isMax ? (a < b ? b : a) : (b < a ? b : a); } };
+		Index i{ };
+		auto r{ x[0] };
+#ifdef HY_VECTOR_SIMD
+		if (n >= SIMD_F64_WIDTH) {
+			auto acc{ SimdLoad(x) };
+			for (i = SIMD_F64_WIDTH; i + SIMD_F64_WIDTH <= n; i += SIMD_F64_WIDTH) {
+				if constexpr (isMax) acc = SimdMax(acc, SimdLoad(x + i));
+				else acc = SimdMin(acc, SimdLoad(x + i));
+			}
+			r = SimdReduce(acc, better);
+		}
+#endif
+		for (; i < n; ++i) r = better(r, x[i]);
+		return r;
+	}
+
+	void VectorCumsum(Float64* dst, const Float64* src, Size n) noexcept {
+		Float64 s{ };
+		for (Index i{ }; i < n; ++i) dst[i] = s += src[i];
+	}
+
+	// y += alpha * x
+	void VectorAxpy(Float64* y, Float64 alpha, const Float64* x, Size n) noexcept {
+		Index i{ };
+#ifdef HY_VECTOR_SIMD
+		auto va{ SimdSet(alpha) };
+		for (; i + SIMD_F64_WIDTH <= n; i += SIMD_F64_WIDTH)
+			SimdStore(y + i, SimdAdd(SimdLoad(y + i), SimdMul(va, SimdLoad(x + i))));
+#endif
+		for (; i < n; ++i) y[i] += alpha * x[i];
+	}
+}
+
+namespace hy::impl {
+	LIB_EXPORT void Vector_Dot(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data1{ obj_cast<VectorObject>(thisObject)->value() };
+		auto& data2{ obj_cast<VectorObject>(args[0])->value() };
+		if (data1.size() != data2.size()) SetError_UnmatchedLen(vm, data1.size(), data2.size());
+		else vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float),
+			arg_cast(details::VectorDot(data1.data(), data2.data(), data1.size()))));
+	}
+
+	LIB_EXPORT void Vector_Norm(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<VectorObject>(thisObject)->value() };
+		auto norm{ ::sqrt(details::VectorDot(data.data(), data.data(), data.size())) };
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(norm)));
+	}
+
+	LIB_EXPORT void Vector_Sum(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<VectorObject>(thisObject)->value() };
+		auto sum{ details::VectorSum(data.data(), data.size()) };
+		vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(sum)));
+	}
+
+	template<bool isMax>
+	void Vector_Extreme(HVM hvm, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<VectorObject>(thisObject)->value() };
+		if (data.empty()) SetError_EmptyContainer(vm, isMax ? u"vector::max" : u"vector::min", thisObject->type);
+		else {
+			auto v{ details::VectorExtreme<isMax>(data.data(), data.size()) };
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(v)));
+		}
+	}
+
+	LIB_EXPORT void Vector_Min(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		Vector_Extreme<false>(hvm, thisObject);
+	}
+
+	LIB_EXPORT void Vector_Max(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		Vector_Extreme<true>(hvm, thisObject);
+	}
+
+	LIB_EXPORT void Vector_Cumsum(HVM hvm, ObjArgsView, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<VectorObject>(thisObject)->value() };
+		auto ret{ obj_allocate<VectorObject>(thisObject->type, nullptr, arg_cast(data.size())) };
+		details::VectorCumsum(ret->data.data(), data.data(), data.size());
+		vm->objectStack.push_link(ret);
+	}
+
+	// 原地缩放, 返回自身
+	LIB_EXPORT void Vector_Scale(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<VectorObject>(thisObject)->mutate() };
+		if (auto arg{ args[0] }; arg->type->f_float) {
+			auto value{ arg->type->f_float(arg) };
+			details::VectorCalc<true>(data.data(), data.data(), &value, data.size(), BOPTType::MULTIPLE);
+			vm->objectStack.push_link(thisObject);
+		}
+		else SetError_UnmatchedCall(vm, u"vector::scale", args);
+	}
+
+	// 原地计算 this += alpha * x, 返回自身
+	LIB_EXPORT void Vector_Axpy(HVM hvm, ObjArgsView args, Object* thisObject) noexcept {
+		auto vm{ vm_cast(hvm) };
+		auto& data{ obj_cast<VectorObject>(thisObject)->mutate() };
+		auto arg0{ args[0] }, arg1{ args[1] };
+		if (arg0->type->f_float && arg1->type->v_id == TypeId::Vector) {
+			auto& x{ obj_cast<VectorObject>(arg1)->value() };
+			if (data.size() != x.size()) SetError_UnmatchedLen(vm, data.size(), x.size());
+			else {
+				details::VectorAxpy(data.data(), arg0->type->f_float(arg0), x.data(), data.size());
+				vm->objectStack.push_link(thisObject);
+			}
+		}
+		else SetError_UnmatchedCall(vm, u"vector::axpy", args);
+	}
+}
+
 namespace hy {
+	constexpr auto VECTOR_EXPR_MAX_STEPS{ 16ULL };
+	constexpr auto VECTOR_EXPR_BLOCK{ 512ULL }; // 每块4KB, 所有步骤在L1中完成
+
+	void VectorObject::evaluate() noexcept {
+		auto e{ expr };
+		expr = nullptr;
+		auto n{ data.size() };
+		auto dst{ data.data() };
+		for (Index offset{ }; offset < n; offset += VECTOR_EXPR_BLOCK) {
+			auto len{ std::min(VECTOR_EXPR_BLOCK, n - offset) };
+			auto block{ dst + offset };
+			if (e->source) freestanding::copy_n(block, e->source->data.data() + offset, len);
+			for (auto& step : e->steps) {
+				if (step.operand) impl::details::VectorCalc<false>(block, block, step.operand->data.data() + offset, len, step.opt);
+				else impl::details::VectorCalc<true>(block, block, &step.scalar, len, step.opt);
+			}
+		}
+		expr = e;
+		discard();
+	}
+
+	void VectorObject::discard() noexcept {
+		auto e{ expr };
+		expr = nullptr;
+		auto drop{ [this](VectorObject* v) noexcept {
+			auto& deps{ v->dependents };
+			deps.erase(std::find(deps.begin(), deps.end(), this));
+			v->unlink();
+		} };
+		if (e->source) drop(e->source);
+		for (auto& step : e->steps) {
+			if (step.operand) drop(step.operand);
+		}
+		delete e;
+	}
+
+	// 登记v为self的操作数, v需先求值
+	VectorObject* Vector_Depend(VectorObject* self, VectorObject* v) noexcept {
+		v->value();
+		v->link();
+		v->dependents.emplace_back(self);
+		return v;
+	}
+
+	// 为vobj1 opt operand(或scalar)构造延迟结果
+	// 仅被操作数栈引用的vobj1是上一步运算的临时结果, 直接在其上追加步骤, 整条运算链只分配一次
+	VectorObject* Vector_Lazy(VectorObject* vobj1, BOPTType opt, VectorObject* operand, Float64 scalar) noexcept {
+		VectorObject* ret;
+		if (vobj1->lc == 1ULL) {
+			if (vobj1->expr && vobj1->expr->steps.size() >= VECTOR_EXPR_MAX_STEPS) vobj1->evaluate();
+			if (!vobj1->expr) vobj1->expr = new VectorExpr{ nullptr };
+			ret = vobj1;
+		}
+		else {
+			ret = obj_allocate<VectorObject>(vobj1->type, nullptr, arg_cast(vobj1->data.size()));
+			ret->expr = new VectorExpr{ nullptr };
+			ret->expr->source = Vector_Depend(ret, vobj1);
+		}
+		if (operand) operand = Vector_Depend(ret, operand);
+		ret->expr->steps.emplace_back(VectorExpr::Step{ opt, scalar, operand });
+		return ret;
+	}
+
 	struct VectorStaticData {
 		Vector<VectorObject*> pool;
+		FunctionTable ft;
+
+		VectorStaticData(TypeObject* type) noexcept {
+			auto funcType{ type->__getType(TypeId::Function) };
+
+			Object* __any[] { nullptr, type };
+			ObjArgsView empty, vt{ __any + 1, 1ULL }, any1{ __any, 1ULL }, any_vt{ __any, 2ULL };
+
+			ft.try_emplace(u"dot", MakeNative<true, true>(funcType, u"vector::dot", &impl::Vector_Dot, vt));
+			ft.try_emplace(u"norm", MakeNative<true, true>(funcType, u"vector::norm", &impl::Vector_Norm, empty));
+			ft.try_emplace(u"sum", MakeNative<true, true>(funcType, u"vector::sum", &impl::Vector_Sum, empty));
+			ft.try_emplace(u"min", MakeNative<true, true>(funcType, u"vector::min", &impl::Vector_Min, empty));
+			ft.try_emplace(u"max", MakeNative<true, true>(funcType, u"vector::max", &impl::Vector_Max, empty));
+			ft.try_emplace(u"cumsum", MakeNative<true, true>(funcType, u"vector::cumsum", &impl::Vector_Cumsum, empty));
+			ft.try_emplace(u"scale", MakeNative<true, true>(funcType, u"vector::scale", &impl::Vector_Scale, any1));
+			ft.try_emplace(u"axpy", MakeNative<true, true>(funcType, u"vector::axpy", &impl::Vector_Axpy, any_vt));
+		}
 	};
 
 	void f_class_create_vector(TypeObject* type) noexcept {
-		type->v_static = new VectorStaticData;
+		type->v_static = new VectorStaticData(type);
 	}
 
 	void f_class_delete_vector(TypeObject* type) noexcept {
 		auto staticData{ static_cast<VectorStaticData*>(type->v_static) };
 		for (auto obj : staticData->pool) delete obj;
+		for (auto& [_, fobj] : staticData->ft) delete fobj;
 		delete staticData;
 	}
 
@@ -52,7 +374,9 @@ namespace hy {
 
 	void f_deallocate_vector(Object* obj) noexcept {
 		auto& pool{ static_cast<VectorStaticData*>(obj->type->v_static)->pool };
-		pool.emplace_back(obj_cast<VectorObject>(obj));
+		auto vobj{ obj_cast<VectorObject>(obj) };
+		if (vobj->expr) vobj->discard();
+		pool.emplace_back(vobj);
 	}
 
 	bool f_bool_vector(Object* obj) noexcept {
@@ -63,7 +387,7 @@ namespace hy {
 		fast_io::u16ostring_ref strRef{ str };
 		str->push_back(u'[');
 		auto vobj{ obj_cast<VectorObject>(obj) };
-		for (auto item : vobj->data) print(strRef, item, u",");
+		for (auto item : vobj->value()) print(strRef, item, u",");
 		if (vobj->data.empty()) str->push_back(u']');
 		else str->back() = u']';
 		return IResult<void>(true);
@@ -73,7 +397,7 @@ namespace hy {
 		std::hash<Float64> hasher;
 		auto hash{ 0ULL };
 		auto vobj{ obj_cast<VectorObject>(obj) };
-		for (auto item : vobj->data) hash ^= hasher(item);
+		for (auto item : vobj->value()) hash ^= hasher(item);
 		return IResult<Size>(hash);
 	}
 
@@ -81,6 +405,20 @@ namespace hy {
 		return IResult<Size>(obj_cast<VectorObject>(obj)->data.size());
 	}
 
+	IResult<void> f_member_vector(HVM hvm, bool isLV, Object* obj, const StringView member) noexcept {
+		auto vm{ vm_cast(hvm) };
+		if (!isLV) {
+			auto& ft{ static_cast<VectorStaticData*>(obj->type->v_static)->ft };
+			if (auto pFobj{ ft.get(member) }) {
+				auto fobj{ obj_allocate(vm->getType(TypeId::MemberFunction), *pFobj, obj) };
+				vm->objectStack.push_link(fobj);
+				return IResult<void>(true);
+			}
+			else return SetError(&SetError_UnmatchedMember, vm, obj->type, member);
+		}
+		else return SetError(&SetError_NotLeftValue, vm, member);
+	}
+
 	constexpr auto VECTOR_LVID_ELEM{ 0ULL };
 
 	IResult<void> f_index_vector(HVM hvm, bool isLV, Object* obj, ObjArgsView args) noexcept {
@@ -99,7 +437,7 @@ namespace hy {
 						ret->setData<VECTOR_LVID_ELEM>(actualIndex);
 						vm->objectStack.push_link(ret);
 					}
-					else vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(vobj->data[actualIndex])));
+					else vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(vobj->value()[actualIndex])));
 					return IResult<void>(true);
 				}
 				else SetError_IndexOutOfRange(vm, index, length);
@@ -116,7 +454,7 @@ namespace hy {
 		if (auto size{ vobj->data.size() }; argc <= size) {
 			auto type{ vm->getType(TypeId::Float) };
 			for (Index i{ }; i < argc; ++i)
-				vm->objectStack.push_link(obj_allocate(type, arg_cast(vobj->data[i])));
+				vm->objectStack.push_link(obj_allocate(type, arg_cast(vobj->value()[i])));
 			return IResult<void>(true);
 		}
 		else return SetError(&SetError_UnmatchedUnpack, vm, size, argc);
@@ -133,45 +471,40 @@ namespace hy {
 
 	Object* f_full_copy_vector(Object* obj) noexcept {
 		auto vobj{ obj_cast<VectorObject>(obj) };
-		return obj_allocate(obj->type, arg_cast(vobj->data.data()), arg_cast(vobj->data.size()));
+		return obj_allocate(obj->type, arg_cast(vobj->value().data()), arg_cast(vobj->data.size()));
 	}
 
 	IResult<void> f_calcassign_vector(HVM hvm, LVObject* lv, Object* obj2, AssignType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
 		auto vobj1{ lv->getAddressObject<VectorObject>() };
-		if (opt == AssignType::MOD_ASSIGN || obj2->type->v_id != TypeId::Vector)
-			return SetError(&SetError_IncompatibleCalcAssign, vm, vobj1->type, obj2->type, opt);
-		auto vobj2{ obj_cast<VectorObject>(obj2) };
-		auto size1{ vobj1->data.size() };
-		auto size2{ vobj2->data.size() };
-		if (size1 != size2) return SetError(&SetError_UnmatchedLen, vm, size1, size2);
-		else {
-			switch (opt) {
-			case AssignType::ADD_ASSIGN: {
-				for (Size i{ }; i < size1; ++i) vobj1->data[i] += vobj2->data[i];
-				break;
-			}
-			case AssignType::SUBTRACT_ASSIGN: {
-				for (Size i{ }; i < size1; ++i) vobj1->data[i] -= vobj2->data[i];
-				break;
-			}
-			case AssignType::MULTIPLE_ASSIGN: {
-				for (Size i{ }; i < size1; ++i) vobj1->data[i] *= vobj2->data[i];
-				break;
-			}
-			case AssignType::DIVIDE_ASSIGN: {
-				for (Size i{ }; i < size1; ++i) vobj1->data[i] /= vobj2->data[i];
-				break;
-			}
-			}
+		BOPTType bopt;
+		switch (opt) {
+		case AssignType::ADD_ASSIGN: bopt = BOPTType::ADD; break;
+		case AssignType::SUBTRACT_ASSIGN: bopt = BOPTType::SUBTRACT; break;
+		case AssignType::MULTIPLE_ASSIGN: bopt = BOPTType::MULTIPLE; break;
+		case AssignType::DIVIDE_ASSIGN: bopt = BOPTType::DIVIDE; break;
+		default: return SetError(&SetError_IncompatibleCalcAssign, vm, vobj1->type, obj2->type, opt);
+		}
+		auto& data1{ vobj1->mutate() };
+		auto size1{ data1.size() };
+		if (obj2->type->v_id == TypeId::Vector) {
+			auto& data2{ obj_cast<VectorObject>(obj2)->value() };
+			if (size1 != data2.size()) return SetError(&SetError_UnmatchedLen, vm, size1, data2.size());
+			impl::details::VectorCalc<false>(data1.data(), data1.data(), data2.data(), size1, bopt);
 			return IResult<void>(true);
 		}
+		else if (obj2->type->f_float) {
+			auto value{ obj2->type->f_float(obj2) };
+			impl::details::VectorCalc<true>(data1.data(), data1.data(), &value, size1, bopt);
+			return IResult<void>(true);
+		}
+		return SetError(&SetError_IncompatibleCalcAssign, vm, vobj1->type, obj2->type, opt);
 	}
 
 	IResult<void> f_assign_lv_data_vector(HVM hvm, LVObject* lv, Object* obj) noexcept {
 		auto vm{ vm_cast(hvm) };
 		if (obj->type->f_float) {
-			lv->getParent<VectorObject>()->data[lv->getData<0ULL, Index>()] = obj->type->f_float(obj);
+			lv->getParent<VectorObject>()->mutate()[lv->getData<0ULL, Index>()] = obj->type->f_float(obj);
 			return IResult<void>(true);
 		}
 		return SetError(&SetError_IncompatibleAssign, vm, vm->getType(TypeId::Float), obj->type);
@@ -181,7 +514,7 @@ namespace hy {
 		auto vm{ vm_cast(hvm) };
 		if (obj->type->f_float) {
 			auto value{ obj->type->f_float(obj) };
-			auto& ref{ lv->getParent<VectorObject>()->data[lv->getData<0ULL, Index>()] };
+			auto& ref{ lv->getParent<VectorObject>()->mutate()[lv->getData<0ULL, Index>()] };
 			switch (opt) {
 			case AssignType::ADD_ASSIGN: ref += value; break;
 			case AssignType::SUBTRACT_ASSIGN: ref -= value; break;
@@ -195,53 +528,47 @@ namespace hy {
 
 	IResult<void> f_sopt_calc_vector(HVM hvm, Object* obj, SOPTType) noexcept {
 		auto vm{ vm_cast(hvm) };
-		auto vobj{ obj_cast<VectorObject>(obj) };
-		auto ret{ obj_allocate<VectorObject>(obj->type, arg_cast(vobj->data.data()), arg_cast(vobj->data.size())) };
-		for (auto& elem : ret->data) elem = -elem;
-		vm->objectStack.push_link(ret);
+		vm->objectStack.push_link(Vector_Lazy(obj_cast<VectorObject>(obj), BOPTType::MULTIPLE, nullptr, -1.0));
 		return IResult<void>(true);
 	}
 
+	// 加减乘除延迟求值, 乘方立即求值
 	IResult<void> f_bopt_calc_vector(HVM hvm, Object* obj1, Object* obj2, BOPTType opt) noexcept {
 		auto vm{ vm_cast(hvm) };
-		if (opt == BOPTType::MOD || obj2->type->v_id != TypeId::Vector)
-			return SetError(&SetError_UnsupportedBOPT, vm, obj1->type, obj2->type, opt);
 		auto vobj1{ obj_cast<VectorObject>(obj1) };
-		auto vobj2{ obj_cast<VectorObject>(obj2) };
 		auto size1{ vobj1->data.size() };
-		auto size2{ vobj2->data.size() };
-		if (size1 != size2) return SetError(&SetError_UnmatchedLen, vm, size1, size2);
-		auto ret{ obj_allocate<VectorObject>(obj1->type, arg_cast(vobj1->data.data()), arg_cast(size1)) };
-		switch (opt) {
-		case BOPTType::ADD: {
-			for (Size i{ }; i < size1; ++i) ret->data[i] += vobj2->data[i];
-			break;
-		}
-		case BOPTType::SUBTRACT: {
-			for (Size i{ }; i < size1; ++i) ret->data[i] -= vobj2->data[i];
-			break;
-		}
-		case BOPTType::MULTIPLE: {
-			for (Size i{ }; i < size1; ++i) ret->data[i] *= vobj2->data[i];
-			break;
+		VectorObject* vobj2{ };
+		Float64 scalar{ };
+		if (obj2->type->v_id == TypeId::Vector) {
+			vobj2 = obj_cast<VectorObject>(obj2);
+			if (auto size2{ vobj2->data.size() }; size1 != size2) return SetError(&SetError_UnmatchedLen, vm, size1, size2);
 		}
+		else if (obj2->type->f_float) scalar = obj2->type->f_float(obj2);
+		else return SetError(&SetError_UnsupportedBOPT, vm, obj1->type, obj2->type, opt);
+		switch (opt) {
+		case BOPTType::ADD:
+		case BOPTType::SUBTRACT:
+		case BOPTType::MULTIPLE:
 		case BOPTType::DIVIDE: {
-			for (Size i{ }; i < size1; ++i) ret->data[i] /= vobj2->data[i];
-			break;
+			vm->objectStack.push_link(Vector_Lazy(vobj1, opt, vobj2, scalar));
+			return IResult<void>(true);
 		}
 		case BOPTType::POWER: {
-			for (Size i{ }; i < size1; ++i) ret->data[i] = ::pow(ret->data[i], vobj2->data[i]);
-			break;
+			auto& data1{ vobj1->value() };
+			auto ret{ obj_allocate<VectorObject>(obj1->type, nullptr, arg_cast(size1)) };
+			if (vobj2) impl::details::VectorCalc<false>(ret->data.data(), data1.data(), vobj2->value().data(), size1, opt);
+			else impl::details::VectorCalc<true>(ret->data.data(), data1.data(), &scalar, size1, opt);
+			vm->objectStack.push_link(ret);
+			return IResult<void>(true);
 		}
 		}
-		vm->objectStack.push_link(ret);
-		return IResult<void>(true);
+		return SetError(&SetError_UnsupportedBOPT, vm, obj1->type, obj2->type, opt);
 	}
 
 	IResult<bool> f_equal_vector(HVM, Object* obj1, Object* obj2) noexcept {
 		if (obj2->type->v_id != TypeId::Vector) return IResult<bool>(false);
-		auto& data1{ obj_cast<VectorObject>(obj1)->data };
-		auto& data2{ obj_cast<VectorObject>(obj2)->data };
+		auto& data1{ obj_cast<VectorObject>(obj1)->value() };
+		auto& data2{ obj_cast<VectorObject>(obj2)->value() };
 		return IResult<bool>(data1.size() == data2.size() &&
 			freestanding::compare(data1.data(), data2.data(), data1.size() * sizeof(Float64)) == 0);
 	}
@@ -263,7 +590,7 @@ namespace hy {
 		auto vobj{ iter->getReference<VectorObject>() };
 		if (argc == 1ULL || argc == 2ULL) {
 			auto pos{ iter->getData<0ULL, Index>() };
-			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(vobj->data[pos])));
+			vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Float), arg_cast(vobj->value()[pos])));
 			if (argc == 2ULL) vm->objectStack.push_link(obj_allocate(vm->getType(TypeId::Int),
 				arg_cast(static_cast<Int64>(pos + 1ULL))));
 			return IResult<void>(true);
@@ -308,7 +635,7 @@ namespace hy {
 
 		type->f_hash = &f_hash_vector;
 		type->f_len = &f_len_vector;
-		type->f_member = nullptr;
+		type->f_member = &f_member_vector;
 		type->f_index = &f_index_vector;
 		type->f_unpack = &f_unpack_vector;
 